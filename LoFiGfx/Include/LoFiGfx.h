@@ -14,10 +14,12 @@
 #include "LoFiGfxDefines.h"
 #include <vector>
 #include <string_view>
+#include <algorithm>
+#include <bit>
 
 
 extern "C" {
-      void GfxInit();
+      void GfxInit(const GfxParamInit& param = {});
 
       void GfxClose();
 
@@ -31,10 +33,14 @@ extern "C" {
 
       LOFI_API GfxHandle GfxCreateTexture2DFromFile(const char* file_path, const GfxParamCreateTexture2D& param = {});
 
+      LOFI_API GfxHandle GfxCreateTexture2DFromFileAsync(const char* file_path, const GfxParamCreateTexture2D& param = {});
+
       LOFI_API GfxHandle GfxCreateBuffer(const GfxParamCreateBuffer& param = {});
 
       LOFI_API GfxHandle GfxCreateBuffer3F(const GfxParamCreateBuffer3F& param = {});
 
+      LOFI_API GfxInfoConstantBuffer GfxCreateConstantBuffer(const GfxParamCreateConstantBuffer& param);
+
       LOFI_API GfxHandle GfxCreateProgram(const GfxParamCreateProgram& param);
 
       LOFI_API GfxHandle GfxCreateProgramFromFile(const GfxParamCreateProgramFromFile& param);
@@ -54,48 +60,112 @@ extern "C" {
 
       LOFI_API bool GfxFillKernelConstant(GfxHandle kernel, const void* data, size_t size);
 
+      LOFI_API GfxKernelConstantSlot GfxGetKernelConstantSlot(GfxHandle kernel, const char* name);
+
+      LOFI_API bool GfxSetKernelConstantBySlot(GfxHandle kernel, GfxKernelConstantSlot slot, const void* data);
+
+      LOFI_API bool GfxSetKernelConstants(GfxHandle kernel, const GfxInfoKernelConstant* constants, size_t count);
+
+      LOFI_API bool GfxSetKernelSpecConstants(GfxHandle kernel, const GfxInfoKernelSpecConstant* constants, size_t count);
+
       LOFI_API bool GfxUploadBuffer(GfxHandle buffer, const void* data, uint64_t size);
 
       LOFI_API bool GfxResizeBuffer(GfxHandle buffer, uint64_t size);
 
       LOFI_API bool GfxUploadTexture2D(GfxHandle texture, const void* data, uint64_t size);
 
+      LOFI_API bool GfxUploadTexture2DRegion(GfxHandle texture, uint32_t x, uint32_t y, uint32_t w, uint32_t h, const void* data, uint64_t size); //first level only
+
       LOFI_API bool GfxResizeTexture2D(GfxHandle texture, uint32_t w, uint32_t h);
 
       //Info Get
 
       LOFI_API GfxRDGNodeCore GfxGetRDGNodeCore(GfxHandle node);
 
+      LOFI_API GfxInfoRenderNodeFilterStats GfxGetRDGNodeFilterStats(GfxRDGNodeCore nodec);
+
+      LOFI_API GfxInfoRenderNodeQueryStats GfxGetRDGNodeQueryStats(GfxRDGNodeCore nodec);
+
       LOFI_API GfxInfoKernelLayout GfxGetKernelLayout(GfxHandle kernel);
 
+      LOFI_API GfxInfoDeviceFeatures GfxGetDeviceFeatures();
+
       LOFI_API uint32_t GfxGetTextureBindlessIndex(GfxHandle texture);
 
+      LOFI_API bool GfxIsTextureResident(GfxHandle texture);
+
+      // FAILED means the texture from GfxCreateTexture2DFromFileAsync never becomes resident
+      LOFI_API GfxEnumTextureLoadState GfxGetTextureLoadState(GfxHandle texture);
+
       LOFI_API uint64_t GfxGetBufferBindlessAddress(GfxHandle buffer);
 
       LOFI_API void* GfxGetBufferMappedAddress(GfxHandle buffer);
 
+      //Readback
+
+      LOFI_API GfxReadbackTicket GfxReadbackTexture(GfxHandle texture, const GfxParamReadback& param = {});
+
+      LOFI_API GfxReadbackTicket GfxReadbackBuffer(GfxHandle buffer, uint64_t offset = 0, uint64_t size = 0, const GfxParamReadback& param = {});
+
+      LOFI_API GfxEnumReadbackState GfxQueryReadback(GfxReadbackTicket ticket);
+
+      LOFI_API const void* GfxGetReadbackData(GfxReadbackTicket ticket, uint64_t* size);
+
+      LOFI_API void GfxReleaseReadback(GfxReadbackTicket ticket);
+
       //Commands
 
       LOFI_API void GfxGenFrame();
 
+      LOFI_API uint64_t GfxGetCurrentFrameValue();
+
+      LOFI_API uint64_t GfxGetCompletedFrameValue();
+
+      LOFI_API bool GfxWaitFrame(uint64_t frame_value, uint64_t timeout_ns = UINT64_MAX);
+
       LOFI_API void GfxCmdBeginComputePass(GfxRDGNodeCore nodec);
 
       LOFI_API void GfxCmdEndComputePass(GfxRDGNodeCore nodec);
 
       LOFI_API void GfxCmdComputeDispatch(GfxRDGNodeCore nodec, uint32_t x, uint32_t y, uint32_t z);
 
+      LOFI_API void GfxCmdComputeDispatchIndirect(GfxRDGNodeCore nodec, GfxHandle indirect_buffer, size_t offset = 0);
+
+      LOFI_API void GfxCmdComputeBarrier(GfxRDGNodeCore nodec);
+
+      //GPU primitives, uint32 elements addressed by GfxGetBufferBindlessAddress, recorded inside a compute pass
+
+      LOFI_API bool GfxCmdPrimitiveScan(GfxRDGNodeCore nodec, uint64_t src_address, uint64_t dst_address, uint32_t count, bool inclusive = false);
+
+      LOFI_API bool GfxCmdPrimitiveRadixSort(GfxRDGNodeCore nodec, uint64_t keys_address, uint64_t values_address, uint32_t count, uint32_t key_bits = 32);
+
+      LOFI_API bool GfxCmdPrimitiveSegmentedReduce(GfxRDGNodeCore nodec, uint64_t values_address, uint64_t segment_offsets_address, uint64_t dst_address, uint32_t segment_count,
+            GfxEnumPrimitiveReduceOp op = GfxEnumPrimitiveReduceOp::ADD_U32);
+
+      LOFI_API bool GfxCmdPrimitiveCompact(GfxRDGNodeCore nodec, uint64_t src_address, uint64_t flags_address, uint64_t dst_address, uint64_t count_address, uint32_t count);
+
+      LOFI_API bool GfxCmdPrimitiveHistogram(GfxRDGNodeCore nodec, uint64_t src_address, uint64_t bins_address, uint32_t count, uint32_t bin_count, uint32_t value_shift = 0);
+
       LOFI_API void GfxCmdBeginRenderPass(GfxRDGNodeCore nodec, const GfxParamBeginRenderPass& textures);
 
       LOFI_API void GfxCmdEndRenderPass(GfxRDGNodeCore nodec);
 
       LOFI_API void GfxCmdBindKernel(GfxRDGNodeCore nodec, GfxHandle kernel);
 
+      LOFI_API void GfxCmdSetBlendOverride(GfxRDGNodeCore nodec, GfxEnumBlendOverride blend);
+
+      LOFI_API void GfxCmdSetCullOverride(GfxRDGNodeCore nodec, GfxEnumCullOverride cull);
+
       LOFI_API void GfxCmdBindVertexBuffer(GfxRDGNodeCore nodec, GfxHandle vertex_buffer, uint32_t first_binding = 0, uint32_t binding_count = 1, size_t offset = 0);
 
       LOFI_API void GfxCmdBindIndexBuffer(GfxRDGNodeCore nodec, GfxHandle index_buffer, size_t offset = 0);
 
       LOFI_API void GfxCmdDrawIndexedIndirect(GfxRDGNodeCore nodec, GfxHandle indirect_bufer, size_t offset, uint32_t draw_count, uint32_t stride);
 
+      LOFI_API void GfxCmdDrawIndexedIndirectCount(GfxRDGNodeCore nodec, GfxHandle indirect_buffer, size_t offset, GfxHandle count_buffer, size_t count_offset, uint32_t max_draw_count, uint32_t stride);
+
+      LOFI_API void GfxCmdDrawIndirectCount(GfxRDGNodeCore nodec, GfxHandle indirect_buffer, size_t offset, GfxHandle count_buffer, size_t count_offset, uint32_t max_draw_count, uint32_t stride);
+
       LOFI_API void GfxCmdDrawIndex(GfxRDGNodeCore nodec, uint32_t index_count, uint32_t instance_count = 1, uint32_t first_index = 0, int32_t vertex_offset = 0, uint32_t first_instance = 0);
 
       LOFI_API void GfxCmdDraw(GfxRDGNodeCore nodec, uint32_t vertex_count, uint32_t instance_count, uint32_t first_vertex = 0, uint32_t first_instance = 0);
@@ -124,9 +194,19 @@ extern "C" {
 
       LOFI_API Gfx2DCanvas Gfx2DCreateCanvas();
 
-      LOFI_API void Gfx2DDestroy(Gfx2DCanvas canvas);
+      LOFI_API void Gfx2DDestroy(Gfx2DCanvas canvas); //canvas or sub canvas
 
-      LOFI_API bool Gfx2DLoadFont(Gfx2DCanvas canvas, const char* font_path);
+      // a sub canvas records Gfx2DCmd* on its own thread, the canvas merges all of them in Gfx2DDispatchGenerateCommands
+      // by (order, creation): negative orders below the canvas' own draws, the rest above. canvas wide calls on a sub canvas go to its canvas
+      LOFI_API Gfx2DCanvas Gfx2DCreateSubCanvas(Gfx2DCanvas canvas, int32_t order = 0);
+
+      // glyphs are generated the first time they are drawn and kept in cache_directory for later runs,
+      // nullptr caches under the system temp directory, "" disables the cache
+      LOFI_API bool Gfx2DLoadFont(Gfx2DCanvas canvas, const char* font_path, Gfx2DEnumFontAtlasFormat format = Gfx2DEnumFontAtlasFormat::RGBA8, const char* cache_directory = nullptr);
+
+      LOFI_API void Gfx2DPreloadGlyphs(Gfx2DCanvas canvas, const wchar_t* chars); // generated in the background, nothing waits on them
+
+      LOFI_API GfxVec2 Gfx2DMeasureText(Gfx2DCanvas canvas, const wchar_t* text, Gfx2DParamText param); // the size Gfx2DCmdDrawText would cover
 
       LOFI_API void Gfx2DCmdPushCanvasSize(Gfx2DCanvas canvas, uint16_t w, uint16_t h);
 
@@ -154,11 +234,53 @@ extern "C" {
 
       LOFI_API void Gfx2DCmdDrawText(Gfx2DCanvas canvas, GfxVec2 start, const wchar_t* text, Gfx2DParamText param, GfxColor color);
 
+      LOFI_API Gfx2DDrawList Gfx2DCreateDrawList(Gfx2DCanvas canvas);
+
+      LOFI_API void Gfx2DDestroyDrawList(Gfx2DCanvas canvas, Gfx2DDrawList list);
+
+      LOFI_API void Gfx2DBeginDrawList(Gfx2DCanvas canvas, Gfx2DDrawList list); //Gfx2DCmdDraw* record into the list until Gfx2DEndDrawList
+
+      LOFI_API void Gfx2DEndDrawList(Gfx2DCanvas canvas);
+
+      LOFI_API bool Gfx2DIsDrawListDirty(Gfx2DDrawList list);
+
+      LOFI_API void Gfx2DMarkDrawListDirty(Gfx2DDrawList list);
+
+      LOFI_API void Gfx2DCmdDrawList(Gfx2DCanvas canvas, Gfx2DDrawList list, const Gfx2DParamReplayDrawList& param = {});
+
       LOFI_API void Gfx2DReset(Gfx2DCanvas canvas);
 
+      LOFI_API GfxInfo2DCullStats Gfx2DGetCullStats(Gfx2DCanvas canvas);
+
       LOFI_API void Gfx2DEmitDrawCommand(Gfx2DCanvas canvas, GfxRDGNodeCore nodec);
 
       LOFI_API void Gfx2DDispatchGenerateCommands(Gfx2DCanvas canvas);
+
+      //Asset Pack
+
+      LOFI_API GfxAssetPack GfxOpenAssetPack(const char* file_path);
+
+      LOFI_API void GfxCloseAssetPack(GfxAssetPack pack);
+
+      LOFI_API GfxHandle GfxCreateTexture2DFromPack(GfxAssetPack pack, const char* entry_name, const GfxParamCreateTexture2D& param = {});
+
+      LOFI_API GfxHandle GfxCreateProgramFromPack(GfxAssetPack pack, const char* entry_name, const char* resource_name = nullptr);
+
+      LOFI_API const void* GfxGetAssetPackData(GfxAssetPack pack, const char* entry_name, size_t* size);
+
+      LOFI_API GfxAssetPackWriter GfxCreateAssetPackWriter();
+
+      LOFI_API void GfxDestroyAssetPackWriter(GfxAssetPackWriter writer);
+
+      LOFI_API bool GfxAssetPackWriterAddRaw(GfxAssetPackWriter writer, const char* entry_name, const void* data, size_t size);
+
+      LOFI_API bool GfxAssetPackWriterAddTexture2D(GfxAssetPackWriter writer, const char* entry_name, GfxEnumFormat format, uint32_t w, uint32_t h, uint32_t mip_levels, const void* data, size_t size);
+
+      LOFI_API bool GfxAssetPackWriterAddTexture2DFromFile(GfxAssetPackWriter writer, const char* entry_name, const char* file_path);
+
+      LOFI_API bool GfxAssetPackWriterAddProgramFromFile(GfxAssetPackWriter writer, const char* entry_name, const GfxParamCreateProgramFromFile& param);
+
+      LOFI_API bool GfxAssetPackWriterSave(GfxAssetPackWriter writer, const char* file_path);
 }
 
 //C++ Method
@@ -203,6 +325,27 @@ inline GfxHandle GfxCreateProgramFromFile(const std::vector<const char*>& files_
 template <class T> requires (std::is_trivially_copyable_v<T> && (!std::is_pointer_v<T>))
 bool GfxSetKernelConstant(GfxHandle kernel, const char* name, T data) { return GfxSetKernelConstant(kernel, name, (const void*)&data); }
 
+template <class T> requires (std::is_trivially_copyable_v<T> && (!std::is_pointer_v<T>))
+bool GfxSetKernelConstant(GfxHandle kernel, GfxKernelConstantSlot slot, T data) {
+      slot.Size = std::min<uint32_t>(slot.Size, sizeof(T));
+      return GfxSetKernelConstantBySlot(kernel, slot, (const void*)&data);
+}
+
+inline bool GfxSetKernelConstants(GfxHandle kernel, const std::vector<GfxInfoKernelConstant>& constants) {
+      return GfxSetKernelConstants(kernel, constants.data(), constants.size());
+}
+
+template <class T> requires (std::is_same_v<T, bool> || (std::is_arithmetic_v<T> && (sizeof(T) == 4 || sizeof(T) == 8)))
+GfxInfoKernelSpecConstant GfxMakeKernelSpecConstant(const char* name, T value) {
+      if constexpr (std::is_same_v<T, bool>) return {name, value ? 1ull : 0ull};
+      else if constexpr (sizeof(T) == 8) return {name, std::bit_cast<uint64_t>(value)};
+      else return {name, std::bit_cast<uint32_t>(value)};
+}
+
+inline bool GfxSetKernelSpecConstants(GfxHandle kernel, const std::vector<GfxInfoKernelSpecConstant>& constants) {
+      return GfxSetKernelSpecConstants(kernel, constants.data(), constants.size());
+}
+
 inline void GfxCmdBeginRenderPass(GfxRDGNodeCore nodec, const std::vector<GfxInfoRenderPassaAttachment>& textures) {
       return GfxCmdBeginRenderPass(nodec, GfxParamBeginRenderPass{
             .pAttachments = textures.data(),
@@ -299,6 +299,57 @@ enum class GfxEnumKernelType : uint32_t {
       COMPUTE,
 };
 
+enum class GfxEnumReadbackState : uint32_t {
+      INVALID,
+      PENDING,
+      READY,
+      FAILED,
+};
+
+enum class GfxEnumTextureLoadState : uint32_t {
+      INVALID,
+      LOADING,
+      READY,
+      FAILED,
+};
+
+enum class GfxEnumReadbackEncode : uint32_t {
+      NONE,
+      PNG, // R8/R8G8B8A8/B8G8R8A8 textures
+      HDR, // R32/R32G32B32A32 float textures
+};
+
+// spirv-opt pass set run on compiled programs, also selectable with "#set optimize = none|size|performance"
+enum class GfxEnumShaderOptimization : uint32_t {
+      NONE,
+      SIZE,
+      PERFORMANCE,
+};
+
+// Per render pass overrides, the kernel's program config is used for PROGRAM
+enum class GfxEnumBlendOverride : uint32_t {
+      PROGRAM,
+      DISABLED,
+      ADD,
+      ALPHA,
+};
+
+enum class GfxEnumCullOverride : uint32_t {
+      PROGRAM,
+      NONE,
+      FRONT,
+      BACK,
+};
+
+enum class GfxEnumPrimitiveReduceOp : uint32_t {
+      ADD_U32,
+      MIN_U32,
+      MAX_U32,
+      ADD_F32,
+      MIN_F32,
+      MAX_F32,
+};
+
 struct GfxHandle {
       const GfxEnumResourceType Type;
       const uint32_t RHandle;
@@ -306,6 +357,23 @@ struct GfxHandle {
 
 using Gfx2DCanvas = uint64_t;
 
+using Gfx2DDrawList = uint64_t;
+
+using GfxAssetPack = uint64_t;
+
+using GfxAssetPackWriter = uint64_t;
+
+using GfxReadbackTicket = uint64_t;
+
+// Optional shader features, each one is only enabled when the physical device reports it
+struct GfxParamInit {
+      bool bShader16Bit = true; // shaderInt16, shaderFloat16, 16-bit storage buffer access
+      bool bShader8Bit = true; // shaderInt8, 8-bit storage buffer access
+      bool bShader64Bit = true; // shaderInt64, shaderFloat64, 64-bit buffer atomics
+      bool bSubgroupExtendedTypes = true; // subgroup operations on 8/16/64-bit types
+      bool bDrawIndirectCount = true; // GfxCmdDraw(Indexed)IndirectCount
+};
+
 struct GfxParamCreateSwapchain {
       const char* pResourceName = nullptr;
       uint64_t AnyHandleForResizeCallback = 0;
@@ -334,9 +402,17 @@ struct GfxParamCreateBuffer3F {
       bool bCpuAccess = true;
 };
 
+// Transient per-frame constant data, valid until the current frame retires
 struct GfxParamCreateConstantBuffer {
       const char* pResourceName = nullptr;
       const void* pData = nullptr;
+      size_t DataSize = 0;
+};
+
+struct GfxInfoConstantBuffer {
+      void* pMappedAddress = nullptr;
+      uint64_t BindlessAddress = 0;
+      uint64_t Size = 0;
 };
 
 struct GfxParamCreateProgram {
@@ -344,6 +420,7 @@ struct GfxParamCreateProgram {
       const char* pConfig = nullptr;
       const char* const* pSourceCodes = nullptr;
       size_t countSourceCode = 0;
+      GfxEnumShaderOptimization Optimization = GfxEnumShaderOptimization::NONE;
 };
 
 struct GfxParamCreateProgramFromFile {
@@ -351,10 +428,28 @@ struct GfxParamCreateProgramFromFile {
       const char* pConfig = nullptr;
       const char* const* pSourceCodeFileNames = nullptr;
       size_t countSourceCodeFileName = 0;
+      GfxEnumShaderOptimization Optimization = GfxEnumShaderOptimization::NONE;
+};
+
+struct GfxParamReadback {
+      GfxEnumReadbackEncode Encode = GfxEnumReadbackEncode::NONE;
+      const char* pEncodeFilePath = nullptr;
+      uint64_t AnyHandleForCallback = 0;
+      // called on the frame thread (or the encode worker), the ticket is released after it returns, data is nullptr on failure
+      void (*PtrOnReadbackDone)(uint64_t, GfxReadbackTicket, const void*, uint64_t) = nullptr;
+};
+
+// Specialization constant by name, Value is the raw bit pattern (bool as 0/1, float bits for float),
+// constants narrower than 64 bit take the low bytes
+struct GfxInfoKernelSpecConstant {
+      const char* pName = nullptr;
+      uint64_t Value = 0;
 };
 
 struct GfxParamCreateKernel {
       const char* pResourceName = nullptr;
+      const GfxInfoKernelSpecConstant* pSpecConstants = nullptr; // overrides program defaults and "#set spec" values
+      size_t countSpecConstants = 0;
 };
 
 struct GfxInfoRenderPassaAttachment {
@@ -372,6 +467,17 @@ struct GfxParamBeginRenderPass {
       const size_t countAttachments;
 };
 
+// Resolved push constant member, Size == 0 means not found
+struct GfxKernelConstantSlot {
+      uint32_t Offset = 0;
+      uint32_t Size = 0;
+};
+
+struct GfxInfoKernelConstant {
+      GfxKernelConstantSlot Slot;
+      const void* pData = nullptr;
+};
+
 struct GfxInfoKernelLayout {
       uint64_t Layout;
       uint32_t Offset;
@@ -380,6 +486,8 @@ struct GfxInfoKernelLayout {
 
 struct GfxParamCreateRenderNode {
       const char* pRenderNodeName = nullptr;
+      bool bPipelineStatistics = false; // one pipeline statistics query around every pass of the node
+      bool bOcclusionQuery = false; // samples passed by every render pass of the node
 };
 
 struct GfxInfoRenderNodeWait {
@@ -387,6 +495,70 @@ struct GfxInfoRenderNodeWait {
       size_t countNamesRenderNodeWaitFor = 0;
 };
 
+// Commands dropped by a render node's state filter during its last recorded frame
+struct GfxInfoRenderNodeFilterStats {
+      uint64_t FilteredVertexBufferBinds = 0;
+      uint64_t FilteredIndexBufferBinds = 0;
+      uint64_t FilteredDescriptorSetBinds = 0;
+      uint64_t FilteredViewports = 0;
+      uint64_t FilteredScissors = 0;
+      uint64_t FilteredPushConstants = 0;
+};
+
+// Shader features enabled on the device and its subgroup (wave) properties
+struct GfxInfoDeviceFeatures {
+      const char* pDeviceName = nullptr;
+      uint32_t SubgroupSize = 0;
+      uint32_t MinSubgroupSize = 0;
+      uint32_t MaxSubgroupSize = 0;
+      bool bSubgroupInVertex = false;
+      bool bSubgroupInFragment = false;
+      bool bSubgroupInCompute = false;
+      bool bSubgroupBasic = false;
+      bool bSubgroupVote = false;
+      bool bSubgroupArithmetic = false;
+      bool bSubgroupBallot = false;
+      bool bSubgroupShuffle = false;
+      bool bSubgroupShuffleRelative = false;
+      bool bSubgroupClustered = false;
+      bool bSubgroupQuad = false;
+      bool bSubgroupExtendedTypes = false;
+      bool bShaderFloat16 = false;
+      bool bShaderInt8 = false;
+      bool bShaderInt16 = false;
+      bool bShaderInt64 = false;
+      bool bShaderFloat64 = false;
+      bool bShaderBufferInt64Atomics = false;
+      bool bShaderSharedInt64Atomics = false;
+      bool bStorageBuffer16BitAccess = false;
+      bool bUniformAndStorageBuffer16BitAccess = false;
+      bool bStoragePushConstant16 = false;
+      bool bStorageBuffer8BitAccess = false;
+      bool bUniformAndStorageBuffer8BitAccess = false;
+      bool bStoragePushConstant8 = false;
+      bool bPipelineStatisticsQuery = false;
+      bool bOcclusionQueryPrecise = false;
+      bool bDrawIndirectCount = false;
+};
+
+// Query results of a render node, summed over its passes. They lag recording by
+// the frames in flight: a frame slot is read back once it retired and is reused.
+struct GfxInfoRenderNodeQueryStats {
+      bool bValid = false;
+      uint32_t PassCount = 0;
+      uint32_t RenderPassCount = 0;
+      uint32_t DroppedPassCount = 0; // passes past the query pool capacity, the pool grows for the next use
+      uint64_t InputAssemblyVertices = 0;
+      uint64_t InputAssemblyPrimitives = 0;
+      uint64_t VertexShaderInvocations = 0;
+      uint64_t ClippingInvocations = 0;
+      uint64_t ClippingPrimitives = 0;
+      uint64_t FragmentShaderInvocations = 0;
+      uint64_t ComputeShaderInvocations = 0;
+      uint64_t SamplesPassed = 0;
+      uint64_t RenderAreaPixels = 0; // summed render area, SamplesPassed / RenderAreaPixels approximates overdraw
+};
+
 struct GfxRDGNodeCore {
       uint64_t Core;
 };
@@ -416,6 +588,12 @@ struct GfxColor {
       uint8_t a;
 };
 
+// texel format of a canvas' font atlas, the MTSDF is clamped to [0, 1] at generation time
+enum class Gfx2DEnumFontAtlasFormat : uint32_t {
+      RGBA8,
+      RGBA16F,
+};
+
 enum class Gfx2DStrockFillType : uint16_t {
       Soild = 0,
       Texture = 1,
@@ -515,6 +693,25 @@ struct Gfx2DParamCircle {
       float Radius;
 };
 
+// primitives dropped at record time because they lie fully outside the scissor or canvas, reset by Gfx2DReset
+struct GfxInfo2DCullStats {
+      uint32_t EmittedPrimitives = 0;
+      uint32_t CulledPrimitives = 0;
+      uint32_t EmittedTextRuns = 0;
+      uint32_t CulledTextRuns = 0;
+};
+
+struct Gfx2DParamReplayDrawList {
+      GfxVec2 Offset = {0, 0};
+      GfxVec2 Scale = {1, 1};
+      GfxColor Tint = {255, 255, 255, 255};
+      // canvas space, applied on top of the scissors recorded in the list
+      uint16_t ClipX = 0;
+      uint16_t ClipY = 0;
+      uint16_t ClipW = UINT16_MAX;
+      uint16_t ClipH = UINT16_MAX;
+};
+
 }
 
 #endif
@@ -0,0 +1,356 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#include "AssetPack.h"
+#include "Message.h"
+#include "TextureLoader.h"
+
+#include "GfxComponents/Program.h"
+
+#include <fstream>
+#include <sstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace LoFi;
+using namespace LoFi::Internal;
+
+uint64_t LoFi::Internal::AssetPackHashName(std::string_view name, AssetPackEntryType type) {
+      return XXH64(name.data(), name.size(), (uint64_t)type);
+}
+
+AssetPack::~AssetPack() {
+      Close();
+}
+
+bool AssetPack::Open(const char* path) {
+      Close();
+      _path = path;
+
+#ifdef _WIN32
+      HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+      if (file == INVALID_HANDLE_VALUE) {
+            const auto err = std::format("[AssetPack::Open] Failed to open file \"{}\".", path);
+            MessageManager::Log(MessageType::Error, err);
+            return false;
+      }
+      _fileHandle = file;
+
+      LARGE_INTEGER file_size{};
+      GetFileSizeEx(file, &file_size);
+      _mappedSize = (size_t)file_size.QuadPart;
+
+      if (_mappedSize >= sizeof(AssetPackHeader)) {
+            _mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (_mappingHandle) {
+                  _mappedData = (const uint8_t*)MapViewOfFile(_mappingHandle, FILE_MAP_READ, 0, 0, 0);
+            }
+      }
+#else
+      int file = open(path, O_RDONLY);
+      if (file < 0) {
+            const auto err = std::format("[AssetPack::Open] Failed to open file \"{}\".", path);
+            MessageManager::Log(MessageType::Error, err);
+            return false;
+      }
+
+      struct stat file_stat{};
+      fstat(file, &file_stat);
+      _mappedSize = (size_t)file_stat.st_size;
+
+      if (_mappedSize >= sizeof(AssetPackHeader)) {
+            if (void* mapped = mmap(nullptr, _mappedSize, PROT_READ, MAP_PRIVATE, file, 0); mapped != MAP_FAILED) {
+                  _mappedData = (const uint8_t*)mapped;
+            }
+      }
+      close(file);
+#endif
+
+      if (!_mappedData) {
+            const auto err = std::format("[AssetPack::Open] Failed to map file \"{}\".", path);
+            MessageManager::Log(MessageType::Error, err);
+            Close();
+            return false;
+      }
+
+      const auto* header = (const AssetPackHeader*)_mappedData;
+      if (header->Magic != AssetPackMagic || header->Version != AssetPackVersion) {
+            const auto err = std::format("[AssetPack::Open] \"{}\" is not a LoFi asset pack of version {}.", path, AssetPackVersion);
+            MessageManager::Log(MessageType::Error, err);
+            Close();
+            return false;
+      }
+
+      if (header->FileSize != _mappedSize || header->IndexOffset > _mappedSize
+          || (uint64_t)header->EntryCount * sizeof(AssetPackEntry) > _mappedSize - header->IndexOffset) {
+            const auto err = std::format("[AssetPack::Open] Asset pack \"{}\" is truncated.", path);
+            MessageManager::Log(MessageType::Error, err);
+            Close();
+            return false;
+      }
+
+      if (header->IndexOffset % alignof(AssetPackEntry) != 0) {
+            const auto err = std::format("[AssetPack::Open] Index of \"{}\" is not aligned.", path);
+            MessageManager::Log(MessageType::Error, err);
+            Close();
+            return false;
+      }
+
+      const auto* entries = (const AssetPackEntry*)(_mappedData + header->IndexOffset);
+      for (uint32_t i = 0; i < header->EntryCount; i++) {
+            const auto& entry = entries[i];
+            if (entry.Size > header->IndexOffset || entry.Offset > header->IndexOffset - entry.Size) {
+                  const auto err = std::format("[AssetPack::Open] Entry \"{}\" is out of range in \"{}\".", std::string_view(entry.Name, strnlen(entry.Name, sizeof(entry.Name))), path);
+                  MessageManager::Log(MessageType::Error, err);
+                  Close();
+                  return false;
+            }
+            _entries[entry.NameHash] = &entry;
+      }
+
+      return true;
+}
+
+void AssetPack::Close() {
+#ifdef _WIN32
+      if (_mappedData) UnmapViewOfFile(_mappedData);
+      if (_mappingHandle) CloseHandle(_mappingHandle);
+      if (_fileHandle) CloseHandle(_fileHandle);
+#else
+      if (_mappedData) munmap((void*)_mappedData, _mappedSize);
+#endif
+      _mappedData = nullptr;
+      _mappedSize = 0;
+      _mappingHandle = nullptr;
+      _fileHandle = nullptr;
+      _entries.clear();
+}
+
+const AssetPackEntry* AssetPack::Find(std::string_view name, AssetPackEntryType type) const {
+      const auto it = _entries.find(AssetPackHashName(name, type));
+      if (it == _entries.end()) return nullptr;
+      return it->second;
+}
+
+const AssetPackProgramHeader* AssetPack::GetProgramHeader(const AssetPackEntry* entry, const char* caller) const {
+      if (entry->Size < sizeof(AssetPackProgramHeader) || entry->Offset % alignof(AssetPackProgramHeader) != 0) {
+            const auto err = std::format("[{}] Program \"{}\" has no valid header, pack \"{}\".", caller, std::string_view(entry->Name, strnlen(entry->Name, sizeof(entry->Name))), _path);
+            MessageManager::Log(MessageType::Error, err);
+            return nullptr;
+      }
+      return (const AssetPackProgramHeader*)GetData(entry);
+}
+
+std::string_view AssetPack::GetProgramConfig(const AssetPackEntry* entry) const {
+      const auto* header = GetProgramHeader(entry, "AssetPack::GetProgramConfig");
+      if (!header) return {};
+
+      if ((uint64_t)header->ConfigOffset + header->ConfigSize > entry->Size) {
+            const auto err = std::format("[AssetPack::GetProgramConfig] Config of \"{}\" is out of its entry, pack \"{}\".", std::string_view(entry->Name, strnlen(entry->Name, sizeof(entry->Name))), _path);
+            MessageManager::Log(MessageType::Error, err);
+            return {};
+      }
+      return {(const char*)GetData(entry) + header->ConfigOffset, header->ConfigSize};
+}
+
+std::vector<std::pair<glslang_stage_t, std::span<const uint32_t>>> AssetPack::GetProgramSpirv(const AssetPackEntry* entry) const {
+      const auto* header = GetProgramHeader(entry, "AssetPack::GetProgramSpirv");
+      if (!header) return {};
+      const auto* data = GetData(entry);
+
+      std::vector<std::pair<glslang_stage_t, std::span<const uint32_t>>> spvs{};
+      for (uint32_t i = 0; i < std::min<uint32_t>(header->StageCount, (uint32_t)std::size(header->Stages)); i++) {
+            const auto& stage = header->Stages[i];
+            if ((uint64_t)stage.Offset + stage.Size > entry->Size || stage.Offset % sizeof(uint32_t) != 0) {
+                  const auto err = std::format("[AssetPack::GetProgramSpirv] Stage {} of \"{}\" is out of its entry, pack \"{}\".", i, std::string_view(entry->Name, strnlen(entry->Name, sizeof(entry->Name))), _path);
+                  MessageManager::Log(MessageType::Error, err);
+                  return {};
+            }
+            spvs.emplace_back((glslang_stage_t)stage.Stage, std::span((const uint32_t*)(data + stage.Offset), stage.Size / sizeof(uint32_t)));
+      }
+      return spvs;
+}
+
+bool AssetPackWriter::AddEntry(std::string_view name, AssetPackEntryType type, std::vector<uint8_t>&& blob, AssetPackEntry entry) {
+      if (name.empty() || name.size() >= sizeof(entry.Name)) {
+            const auto err = std::format("[AssetPackWriter::AddEntry] Entry name \"{}\" must be 1 to {} characters.", name, sizeof(entry.Name) - 1);
+            MessageManager::Log(MessageType::Error, err);
+            return false;
+      }
+
+      entry.NameHash = AssetPackHashName(name, type);
+      entry.Type = type;
+      entry.Size = blob.size();
+      memcpy(entry.Name, name.data(), name.size());
+
+      for (const auto& exist : _entries) {
+            if (exist.NameHash == entry.NameHash) {
+                  const auto err = std::format("[AssetPackWriter::AddEntry] Entry \"{}\" is repeat.", name);
+                  MessageManager::Log(MessageType::Error, err);
+                  return false;
+            }
+      }
+
+      _entries.push_back(entry);
+      _blobs.push_back(std::move(blob));
+      return true;
+}
+
+bool AssetPackWriter::AddRaw(std::string_view name, const void* data, size_t size) {
+      std::vector<uint8_t> blob(size);
+      memcpy(blob.data(), data, size);
+      return AddEntry(name, AssetPackEntryType::RAW, std::move(blob));
+}
+
+bool AssetPackWriter::AddTexture(std::string_view name, VkFormat format, uint32_t w, uint32_t h, uint32_t mip_levels, const void* data, size_t size) {
+      std::vector<uint8_t> blob(size);
+      memcpy(blob.data(), data, size);
+      return AddEntry(name, AssetPackEntryType::TEXTURE, std::move(blob), {
+            .Format = (uint32_t)format,
+            .Width = w,
+            .Height = h,
+            .MipLevels = mip_levels
+      });
+}
+
+bool AssetPackWriter::AddTextureFromFile(std::string_view name, const char* file_path) {
+      if (TextureLoader::IsContainerFile(file_path)) {
+            TextureFileData file{};
+            if (!TextureLoader::Load(file_path, file)) return false;
+            return AddEntry(name, AssetPackEntryType::TEXTURE, std::move(file.Data), {
+                  .Format = (uint32_t)file.Format,
+                  .Width = file.Width,
+                  .Height = file.Height,
+                  .MipLevels = file.MipLevels
+            });
+      }
+
+      int w, h, channels;
+      unsigned char* data = stbi_load(file_path, &w, &h, &channels, 4);
+      if (!data) {
+            const auto err = std::format("[AssetPackWriter::AddTextureFromFile] Failed to load \"{}\".", file_path);
+            MessageManager::Log(MessageType::Error, err);
+            return false;
+      }
+
+      const bool res = AddTexture(name, VK_FORMAT_R8G8B8A8_UNORM, w, h, 1, data, (size_t)w * h * 4);
+      stbi_image_free(data);
+      return res;
+}
+
+bool AssetPackWriter::AddProgram(std::string_view name, std::string_view config, const std::vector<std::string_view>& sources) {
+      std::vector<std::pair<glslang_stage_t, std::vector<uint32_t>>> spvs{};
+      const auto optimization = Component::Gfx::Program::PeekConfigOptimization(config, GfxEnumShaderOptimization::NONE);
+      if (std::string compile_err{}; !Component::Gfx::Program::CompileToSpirv(sources, spvs, compile_err, optimization)) {
+            const auto err = std::format("[AssetPackWriter::AddProgram] Failed to compile \"{}\":\n{}", name, compile_err);
+            MessageManager::Log(MessageType::Error, err);
+            return false;
+      }
+
+      AssetPackProgramHeader header{};
+      if (spvs.size() > std::size(header.Stages)) {
+            const auto err = std::format("[AssetPackWriter::AddProgram] \"{}\" has {} stages, a pack program holds at most {}.", name, spvs.size(), std::size(header.Stages));
+            MessageManager::Log(MessageType::Error, err);
+            return false;
+      }
+
+      header.StageCount = (uint32_t)spvs.size();
+      header.ConfigOffset = sizeof(AssetPackProgramHeader);
+      header.ConfigSize = (uint32_t)config.size();
+
+      uint32_t offset = (header.ConfigOffset + header.ConfigSize + 3) & ~3u;
+      for (uint32_t i = 0; i < header.StageCount; i++) {
+            header.Stages[i] = {
+                  .Stage = (uint32_t)spvs[i].first,
+                  .Offset = offset,
+                  .Size = (uint32_t)(spvs[i].second.size() * sizeof(uint32_t))
+            };
+            offset += header.Stages[i].Size;
+      }
+
+      std::vector<uint8_t> blob(offset);
+      memcpy(blob.data(), &header, sizeof(header));
+      memcpy(blob.data() + header.ConfigOffset, config.data(), config.size());
+      for (uint32_t i = 0; i < header.StageCount; i++) {
+            memcpy(blob.data() + header.Stages[i].Offset, spvs[i].second.data(), header.Stages[i].Size);
+      }
+
+      return AddEntry(name, AssetPackEntryType::PROGRAM, std::move(blob));
+}
+
+bool AssetPackWriter::AddProgramFromFile(std::string_view name, std::string_view config, const std::vector<std::string_view>& source_files) {
+      std::vector<std::string> codes{};
+      for (const auto& file : source_files) {
+            std::ifstream source_file(std::string(file));
+            if (!source_file.is_open()) {
+                  const auto err = std::format("[AssetPackWriter::AddProgramFromFile] Failed to open file {}.", file);
+                  MessageManager::Log(MessageType::Error, err);
+                  return false;
+            }
+            std::ostringstream oss;
+            oss << source_file.rdbuf();
+            codes.emplace_back(oss.str());
+      }
+
+      std::vector<std::string_view> codes_view{};
+      for (const auto& code : codes) {
+            codes_view.emplace_back(code);
+      }
+      return AddProgram(name, config, codes_view);
+}
+
+bool AssetPackWriter::Save(const char* path) const {
+      std::ofstream file(path, std::ios::binary | std::ios::trunc);
+      if (!file.is_open()) {
+            const auto err = std::format("[AssetPackWriter::Save] Failed to open file \"{}\".", path);
+            MessageManager::Log(MessageType::Error, err);
+            return false;
+      }
+
+      auto align_up = [](uint64_t v) { return (v + AssetPackBlobAlignment - 1) & ~(AssetPackBlobAlignment - 1); };
+
+      std::vector<AssetPackEntry> entries = _entries;
+      uint64_t offset = align_up(sizeof(AssetPackHeader));
+      for (auto& entry : entries) {
+            entry.Offset = offset;
+            offset = align_up(offset + entry.Size);
+      }
+
+      const AssetPackHeader header{
+            .Magic = AssetPackMagic,
+            .Version = AssetPackVersion,
+            .EntryCount = (uint32_t)entries.size(),
+            .BlobAlignment = (uint32_t)AssetPackBlobAlignment,
+            .IndexOffset = offset,
+            .FileSize = offset + entries.size() * sizeof(AssetPackEntry)
+      };
+
+      std::vector<uint8_t> padding(AssetPackBlobAlignment, 0);
+      file.write((const char*)&header, sizeof(header));
+      file.write((const char*)padding.data(), (std::streamsize)(align_up(sizeof(AssetPackHeader)) - sizeof(AssetPackHeader)));
+      for (size_t i = 0; i < entries.size(); i++) {
+            file.write((const char*)_blobs[i].data(), (std::streamsize)_blobs[i].size());
+            file.write((const char*)padding.data(), (std::streamsize)(align_up(_blobs[i].size()) - _blobs[i].size()));
+      }
+      file.write((const char*)entries.data(), (std::streamsize)(entries.size() * sizeof(AssetPackEntry)));
+
+      if (!file.good()) {
+            const auto err = std::format("[AssetPackWriter::Save] Failed to write file \"{}\".", path);
+            MessageManager::Log(MessageType::Error, err);
+            return false;
+      }
+
+      const auto msg = std::format("[AssetPackWriter::Save] Wrote {} entries ({} bytes) to \"{}\".", entries.size(), header.FileSize, path);
+      MessageManager::Log(MessageType::Normal, msg);
+      return true;
+}
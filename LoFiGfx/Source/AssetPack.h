@@ -0,0 +1,132 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#pragma once
+#include "Helper.h"
+
+#include "glslang/Include/glslang_c_interface.h"
+
+namespace LoFi::Internal {
+
+      // *.lfpk layout: AssetPackHeader | aligned blobs ... | AssetPackEntry[EntryCount] at IndexOffset
+      constexpr uint32_t AssetPackMagic = 0x4B50464C; // "LFPK"
+      constexpr uint32_t AssetPackVersion = 1;
+      constexpr uint64_t AssetPackBlobAlignment = 256;
+
+      enum class AssetPackEntryType : uint32_t {
+            RAW,
+            TEXTURE,
+            PROGRAM,
+      };
+
+      struct AssetPackHeader {
+            uint32_t Magic;
+            uint32_t Version;
+            uint32_t EntryCount;
+            uint32_t BlobAlignment;
+            uint64_t IndexOffset;
+            uint64_t FileSize;
+      };
+
+      struct AssetPackEntry {
+            uint64_t NameHash;
+            AssetPackEntryType Type;
+            uint32_t Format;    // VkFormat for TEXTURE
+            uint32_t Width;
+            uint32_t Height;
+            uint32_t MipLevels;
+            uint32_t Reserved;
+            uint64_t Offset;
+            uint64_t Size;
+            char Name[64];
+      };
+
+      // PROGRAM blob: AssetPackProgramHeader | config text | stage SPIR-V words (4 byte aligned)
+      struct AssetPackProgramStage {
+            uint32_t Stage; // glslang_stage_t
+            uint32_t Offset;
+            uint32_t Size;
+      };
+
+      struct AssetPackProgramHeader {
+            uint32_t StageCount;
+            uint32_t ConfigOffset;
+            uint32_t ConfigSize;
+            AssetPackProgramStage Stages[4];
+      };
+
+      class AssetPack {
+      public:
+            NO_COPY_MOVE_CONS(AssetPack);
+
+            AssetPack() = default;
+
+            ~AssetPack();
+
+            bool Open(const char* path);
+
+            void Close();
+
+            [[nodiscard]] bool IsOpen() const { return _mappedData != nullptr; }
+
+            [[nodiscard]] const AssetPackEntry* Find(std::string_view name, AssetPackEntryType type) const;
+
+            [[nodiscard]] const uint8_t* GetData(const AssetPackEntry* entry) const { return _mappedData + entry->Offset; }
+
+            [[nodiscard]] std::string_view GetProgramConfig(const AssetPackEntry* entry) const;
+
+            // the words point into the mapping, valid while the pack is open
+            [[nodiscard]] std::vector<std::pair<glslang_stage_t, std::span<const uint32_t>>> GetProgramSpirv(const AssetPackEntry* entry) const;
+
+            [[nodiscard]] const std::string& GetPath() const { return _path; }
+
+      private:
+            // nullptr, logged as the caller, when the entry is too small or misaligned for the header
+            [[nodiscard]] const AssetPackProgramHeader* GetProgramHeader(const AssetPackEntry* entry, const char* caller) const;
+
+      private:
+            std::string _path{};
+
+            const uint8_t* _mappedData = nullptr;
+
+            size_t _mappedSize = 0;
+
+            void* _fileHandle = nullptr;
+
+            void* _mappingHandle = nullptr;
+
+            entt::dense_map<uint64_t, const AssetPackEntry*> _entries{};
+      };
+
+      class AssetPackWriter {
+      public:
+            NO_COPY_MOVE_CONS(AssetPackWriter);
+
+            AssetPackWriter() = default;
+
+            ~AssetPackWriter() = default;
+
+            bool AddRaw(std::string_view name, const void* data, size_t size);
+
+            bool AddTexture(std::string_view name, VkFormat format, uint32_t w, uint32_t h, uint32_t mip_levels, const void* data, size_t size);
+
+            bool AddTextureFromFile(std::string_view name, const char* file_path);
+
+            bool AddProgram(std::string_view name, std::string_view config, const std::vector<std::string_view>& sources);
+
+            bool AddProgramFromFile(std::string_view name, std::string_view config, const std::vector<std::string_view>& source_files);
+
+            bool Save(const char* path) const;
+
+      private:
+            bool AddEntry(std::string_view name, AssetPackEntryType type, std::vector<uint8_t>&& blob, AssetPackEntry entry = {});
+
+      private:
+            std::vector<AssetPackEntry> _entries{};
+
+            std::vector<std::vector<uint8_t>> _blobs{};
+      };
+
+      uint64_t AssetPackHashName(std::string_view name, AssetPackEntryType type);
+}
@@ -0,0 +1,132 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#include "FrameLinearAllocator.h"
+#include "Message.h"
+
+#include "GfxComponents/Buffer.h"
+
+using namespace LoFi;
+using namespace LoFi::Internal;
+
+FrameLinearAllocator::~FrameLinearAllocator() {
+      Release();
+}
+
+void FrameLinearAllocator::Init(const char* name, VkBufferUsageFlags usage) {
+      _name = name ? name : "Frame Linear Allocator";
+      _usage = usage | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+}
+
+bool FrameLinearAllocator::CreatePage(uint64_t capacity) {
+      auto& pages = _pages[_frameIndex];
+      auto buffer = std::make_unique<Component::Gfx::Buffer>();
+      const std::string page_name = std::format("{} Frame[{}] Page[{}]", _name, _frameIndex, pages.size());
+
+      // prefer device local host visible memory (ReBAR), falls back to system memory
+      if (!buffer->Init(page_name.c_str(), VkBufferCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .size = capacity,
+            .usage = _usage,
+            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+      }, VmaAllocationCreateInfo{
+            .flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
+            .usage = VMA_MEMORY_USAGE_AUTO,
+            .requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+      })) {
+            return false;
+      }
+
+      auto mapped = (uint8_t*)buffer->Map();
+      if (!mapped) return false;
+
+      auto page = std::make_unique<Page>();
+      page->Address = buffer->GetBDAAddress();
+      page->MappedAddress = mapped;
+      page->Capacity = capacity;
+      page->Buffer = std::move(buffer);
+      pages.push_back(std::move(page));
+      return true;
+}
+
+bool FrameLinearAllocator::NextPage(Page* full, uint64_t aligned_size) {
+      //another thread already moved on while this one waited for the lock
+      if (_current.load(std::memory_order_acquire) != full) return true;
+
+      auto& pages = _pages[_frameIndex];
+      if (full && _currentPage + 1 < pages.size()) {
+            _currentPage++;
+      } else {
+            if (!CreatePage(std::max(PageSize, aligned_size))) return false;
+            _currentPage = (uint32_t)pages.size() - 1;
+      }
+      _current.store(pages[_currentPage].get(), std::memory_order_release);
+      return true;
+}
+
+std::optional<FrameLinearAllocation> FrameLinearAllocator::Allocate(uint64_t size) {
+      if (size == 0) return std::nullopt;
+
+      const uint64_t aligned_size = (size + Alignment - 1) & ~(Alignment - 1);
+      while (true) {
+            Page* page = _current.load(std::memory_order_acquire);
+            if (page) {
+                  const uint64_t offset = page->Head.fetch_add(aligned_size, std::memory_order_relaxed);
+                  if (offset + aligned_size <= page->Capacity) {
+                        _usedBytes.fetch_add(aligned_size, std::memory_order_relaxed);
+                        return FrameLinearAllocation{
+                              .MappedAddress = page->MappedAddress + offset,
+                              .Address = page->Address + offset,
+                              .Buffer = page->Buffer->GetBuffer(),
+                              .Offset = offset,
+                              .Size = size
+                        };
+                  }
+            }
+
+            // page full, move on to the next one
+            std::unique_lock lock(_mutex);
+            if (!NextPage(page, aligned_size)) {
+                  const auto err = std::format("[FrameLinearAllocator::Allocate] Failed to allocate a page for {} bytes - Name: \"{}\"", size, _name);
+                  MessageManager::Log(MessageType::Error, err);
+                  return std::nullopt;
+            }
+      }
+}
+
+void FrameLinearAllocator::BeginFrame(uint32_t frame_index) {
+      std::unique_lock lock(_mutex);
+      if (_current.load(std::memory_order_relaxed)) _usedPages[_frameIndex] = _currentPage + 1;
+
+      _frameIndex = frame_index % 3;
+      _currentPage = 0;
+      _usedBytes.store(0, std::memory_order_relaxed);
+
+      //the slot keeps its first page and the regular pages its last use went through,
+      //oversized pages from a burst are dropped wherever they sit
+      auto& pages = _pages[_frameIndex];
+      const uint32_t keep = _usedPages[_frameIndex];
+      std::erase_if(pages, [&](const std::unique_ptr<Page>& page) {
+            const auto index = (size_t)(&page - pages.data());
+            return index > 0 && (page->Capacity > PageSize || index >= keep);
+      });
+
+      for (auto& page : pages) {
+            page->Head.store(0, std::memory_order_relaxed);
+      }
+      _current.store(pages.empty() ? nullptr : pages.front().get(), std::memory_order_release);
+}
+
+void FrameLinearAllocator::Release() {
+      std::unique_lock lock(_mutex);
+      _current.store(nullptr, std::memory_order_release);
+      for (auto& pages : _pages) {
+            pages.clear();
+      }
+      for (auto& used : _usedPages) {
+            used = 0;
+      }
+      _currentPage = 0;
+      _usedBytes.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,83 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#pragma once
+#include "Helper.h"
+
+#include <atomic>
+#include <mutex>
+
+namespace LoFi::Component::Gfx {
+      class Buffer;
+}
+
+namespace LoFi::Internal {
+
+      struct FrameLinearAllocation {
+            void* MappedAddress = nullptr;
+            VkDeviceAddress Address = 0;
+            VkBuffer Buffer = VK_NULL_HANDLE;
+            uint64_t Offset = 0;
+            uint64_t Size = 0;
+      };
+
+      // Persistently mapped pages per frame slot, allocation is an atomic bump of the current page's head,
+      // the mutex is only taken to move on to another page. a slot is rewound once the frame that last used it
+      // has retired, allocating must not race BeginFrame.
+      class FrameLinearAllocator {
+      public:
+            static constexpr uint64_t PageSize = 4 * 1024 * 1024;
+
+            static constexpr uint64_t Alignment = 256;
+
+            NO_COPY_MOVE_CONS(FrameLinearAllocator);
+
+            FrameLinearAllocator() = default;
+
+            ~FrameLinearAllocator();
+
+            void Init(const char* name, VkBufferUsageFlags usage);
+
+            [[nodiscard]] std::optional<FrameLinearAllocation> Allocate(uint64_t size);
+
+            void BeginFrame(uint32_t frame_index);
+
+            void Release();
+
+            [[nodiscard]] uint64_t GetUsedBytes() const { return _usedBytes.load(std::memory_order_relaxed); }
+
+      private:
+            struct Page {
+                  std::unique_ptr<Component::Gfx::Buffer> Buffer{};
+                  uint8_t* MappedAddress = nullptr;
+                  VkDeviceAddress Address = 0;
+                  uint64_t Capacity = 0;
+                  std::atomic<uint64_t> Head{}; // runs past Capacity once the page is full
+            };
+
+            bool CreatePage(uint64_t capacity);
+
+            // _mutex is held, false if a new page can't be created
+            bool NextPage(Page* full, uint64_t aligned_size);
+
+      private:
+            std::string _name{};
+
+            VkBufferUsageFlags _usage{};
+
+            std::mutex _mutex{};
+
+            std::vector<std::unique_ptr<Page>> _pages[3]{};
+
+            uint32_t _usedPages[3]{}; // pages a slot went through the last time it was used
+
+            uint32_t _frameIndex = 0;
+
+            uint32_t _currentPage = 0;
+
+            std::atomic<Page*> _current{};
+
+            std::atomic<uint64_t> _usedBytes{};
+      };
+}
@@ -112,6 +112,12 @@ void Buffer::Unmap() {
       }
 }
 
+void Buffer::Flush(uint64_t offset, uint64_t size) const {
+      if (_memory && size > 0) {
+            vmaFlushAllocation(volkGetLoadedVmaAllocator(), _memory, offset, size);
+      }
+}
+
 bool Buffer::SetData(const void* p, uint64_t size, uint8_t recursive_depth) {
       if(recursive_depth > 1) {
             std::string err = "[Buffer::SetData] Create Buffer Failed! Recursive Depth > 1.";
@@ -220,11 +226,13 @@ bool Buffer::Recreate(uint64_t size) {
 
       RecreateAllViews();
 
-      const auto address_info = VkBufferDeviceAddressInfo{
-            .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
-            .buffer = _buffer
-      };
-      _address = vkGetBufferDeviceAddress(volkGetLoadedDevice(), &address_info);
+      if (_bufferCI->usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) {
+            const auto address_info = VkBufferDeviceAddressInfo{
+                  .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+                  .buffer = _buffer
+            };
+            _address = vkGetBufferDeviceAddress(volkGetLoadedDevice(), &address_info);
+      }
 
       auto str = std::format(R"([Buffer::Recreate] Recreate Buffer from "{}" to "{}" bytes at "{}" side)", back_up_size, _bufferCI->size, _isHostSide ? "Host" : "Device");
       if (!_resourceName.empty())
@@ -258,6 +266,9 @@ void Buffer::BarrierLayout(VkCommandBuffer cmd, GfxEnumKernelType new_kernel_typ
                   case GfxEnumResourceUsage::READ_WRITE_BUFFER:
                         barrier.dstAccessMask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
                         break;
+                  case GfxEnumResourceUsage::INDIRECT_BUFFER:
+                        barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+                        break;
                   default:
                         {
                               auto err = std::format("[Buffer::BarrierLayout] The Barrier in Buffer, In Compute kernel, New Usage can't be \"{}\".", ToStringResourceUsage(new_usage));
@@ -267,7 +278,7 @@ void Buffer::BarrierLayout(VkCommandBuffer cmd, GfxEnumKernelType new_kernel_typ
                               throw std::runtime_error(err);
                         }
             }
-            barrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+            barrier.dstStageMask = new_usage == GfxEnumResourceUsage::INDIRECT_BUFFER ? VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT : VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
       } else if (new_kernel_type == GfxEnumKernelType::GRAPHICS) {
             switch (new_usage) {
                   case GfxEnumResourceUsage::READ_BUFFER:
@@ -339,6 +350,10 @@ void Buffer::BarrierLayout(VkCommandBuffer cmd, GfxEnumKernelType new_kernel_typ
                         barrier.srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
                         barrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
                         break;
+                  case GfxEnumResourceUsage::INDIRECT_BUFFER:
+                        barrier.srcAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+                        barrier.srcStageMask = VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT;
+                        break;
                   default:
                         {
                               auto err = std::format("[Buffer::BarrierLayout] The Barrier in Buffer, In Compute kernel, Old Usage can't be \"{}\".", ToStringResourceUsage(new_usage));
@@ -447,11 +462,13 @@ bool Buffer::CreateBuffer() {
       vmaGetAllocationMemoryProperties(volkGetLoadedVmaAllocator(), _memory, &fgs);
       _isHostSide = (fgs & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0;
 
-      const auto address_info = VkBufferDeviceAddressInfo{
-            .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
-            .buffer = _buffer
-      };
-      _address = vkGetBufferDeviceAddress(volkGetLoadedDevice(), &address_info);
+      if (_bufferCI->usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) {
+            const auto address_info = VkBufferDeviceAddressInfo{
+                  .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+                  .buffer = _buffer
+            };
+            _address = vkGetBufferDeviceAddress(volkGetLoadedDevice(), &address_info);
+      }
 
       auto str = std::format(R"([Buffer::CreateBuffer] Emplace "{}" bytes at "{}" side)", _bufferCI->size, _isHostSide ? "Host" : "Device");
       if (!_resourceName.empty())
@@ -54,6 +54,9 @@ namespace LoFi::Component::Gfx {
 
             void Unmap();
 
+            // makes host writes to a mapped range visible, no-op on coherent memory
+            void Flush(uint64_t offset, uint64_t size) const;
+
             bool SetData(const void* p, uint64_t size, uint8_t recursive_depth = 0);
 
             bool Recreate(uint64_t size);
@@ -19,6 +19,25 @@ namespace LoFi::Component::Gfx {
             uint32_t Size;
       };
 
+      struct SpecConstantInfo {
+            uint32_t ConstantID;
+            uint32_t Size;          // bytes in the specialization data, from the reflected type (bool is a 4 byte VkBool32)
+            bool IsBool;
+            uint64_t DefaultValue;
+      };
+
+      // attachment configuration a graphics pipeline variant is built for, hashed as raw bytes
+      struct KernelRenderState {
+            static constexpr uint32_t MaxColorAttachments = 8;
+
+            VkFormat ColorFormats[MaxColorAttachments]{};
+            uint32_t ColorCount = 0;
+            VkFormat DepthFormat = VK_FORMAT_UNDEFINED;
+            VkFormat StencilFormat = VK_FORMAT_UNDEFINED;
+            VkSampleCountFlagBits Samples = VK_SAMPLE_COUNT_1_BIT;
+            GfxEnumBlendOverride Blend = GfxEnumBlendOverride::PROGRAM;
+      };
+
       enum class ProgramType {
             UNKNOWN,
             GRAPHICS,
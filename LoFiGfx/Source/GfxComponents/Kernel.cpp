@@ -7,14 +7,15 @@ using namespace LoFi::Component::Gfx;
 using namespace LoFi::Internal;
 
 Kernel::~Kernel() {
-      if (_pipeline) {
-            const ContextResourceRecoveryInfo info{
-                  .Type = ContextResourceType::PIPELINE,
-                  .Resource1 = (size_t)_pipeline,
-                  .ResourceName = _resourceName
-
-            };
-            GfxContext::Get()->RecoveryContextResource(info);
+      for (const auto& bucket : _pipelineVariants | std::views::values) {
+            for (const auto& variant : bucket) {
+                  const ContextResourceRecoveryInfo info{
+                        .Type = ContextResourceType::PIPELINE,
+                        .Resource1 = (size_t)variant.Pipeline,
+                        .ResourceName = _resourceName
+                  };
+                  GfxContext::Get()->RecoveryContextResource(info);
+            }
       }
 
       if (_pipelineLayout) {
@@ -36,6 +37,9 @@ bool Kernel::Init(const Program* program, const GfxParamCreateKernel& param) {
             return false;
       }
 
+      _program = program->Handle();
+      InitSpecConstants(program, param);
+
       if (program->IsGraphicsShader()) {
             if(CreateAsGraphics(program)) {
                   std::string str = std::format("[KernelCreate] Graphics Kernel Created.", _resourceName);
@@ -82,18 +86,151 @@ bool Kernel::CreateAsGraphics(const Program* program) {
             return false;
       }
 
+      const auto& rendering = program->_renderingCreateInfo;
+      _defaultRenderState.ColorCount = std::min(rendering.colorAttachmentCount, KernelRenderState::MaxColorAttachments);
+      std::copy_n(rendering.pColorAttachmentFormats, _defaultRenderState.ColorCount, _defaultRenderState.ColorFormats);
+      _defaultRenderState.DepthFormat = rendering.depthAttachmentFormat;
+      _defaultRenderState.StencilFormat = rendering.stencilAttachmentFormat;
+      _defaultRenderState.Samples = program->_multiSampleCreateInfo.rasterizationSamples;
+      _defaultCullMode = program->_rasterizationStateCreateInfo.cullMode;
+      _defaultFrontFace = program->_rasterizationStateCreateInfo.frontFace;
+
+      _isComputeKernel = false;
+      _pushConstantBuffer.resize(_pushConstantRange.size);
+
+      std::unique_lock lock(_variantMutex);
+      const auto pipeline = FetchPipelineVariant(program, _defaultRenderState);
+      _pipeline.store(pipeline, std::memory_order_release);
+      return pipeline != VK_NULL_HANDLE;
+}
+
+bool Kernel::CreateAsCompute(const Program* program) {
+      _pushConstantRange = program->GetPushConstantRange();
+      _pushConstantDefine = program->GetPushConstantDefine();
+
+      VkPipelineLayoutCreateInfo pipeline_layout_ci{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+            .setLayoutCount = 1,
+            .pSetLayouts = &LoFi::GfxContext::Get()->_bindlessDescriptorSetLayout,
+            .pushConstantRangeCount = 1,
+            .pPushConstantRanges = &_pushConstantRange
+      };
+
+      if (const auto result = vkCreatePipelineLayout(volkGetLoadedDevice(), &pipeline_layout_ci, nullptr, &_pipelineLayout); result != VK_SUCCESS) {
+            auto err = std::format("[Kernel::CreateAsCompute] vkCreatePipelineLayout Failed, return {}.", ToStringVkResult(result));
+            if(!_resourceName.empty()) err += std::format(" - Name: \"{}\"", _resourceName);
+            MessageManager::Log(MessageType::Error, err);
+            return false;
+      }
+
+      _isComputeKernel = true;
+      _pushConstantBuffer.resize(_pushConstantRange.size);
+
+      std::unique_lock lock(_variantMutex);
+      const auto pipeline = FetchPipelineVariant(program, _defaultRenderState);
+      _pipeline.store(pipeline, std::memory_order_release);
+      return pipeline != VK_NULL_HANDLE;
+}
+
+void Kernel::InitSpecConstants(const Program* program, const GfxParamCreateKernel& param) {
+      for (const auto& [name, info] : program->GetSpecConstantDefine()) {
+            // keep every constant naturally aligned, 64 bit constants need 8 byte offsets
+            const size_t offset = (_specValues.size() + info.Size - 1) / info.Size * info.Size;
+            _specConstantIndex[name] = (uint32_t)_specMapEntries.size();
+            _specMapEntries.push_back(VkSpecializationMapEntry{
+                  .constantID = info.ConstantID,
+                  .offset = (uint32_t)offset,
+                  .size = info.Size
+            });
+            _specIsBool.push_back(info.IsBool);
+            _specValues.resize(offset + info.Size);
+            std::memcpy(_specValues.data() + offset, &info.DefaultValue, info.Size);
+      }
+
+      std::vector<GfxInfoKernelSpecConstant> config_constants{};
+      for (const auto& [name, value] : program->GetSpecConstantConfig()) {
+            config_constants.push_back({name.c_str(), value});
+      }
+
+      ApplySpecConstants(config_constants, _specValues);
+      ApplySpecConstants(std::span(param.pSpecConstants, param.countSpecConstants), _specValues);
+}
+
+bool Kernel::ApplySpecConstants(std::span<const GfxInfoKernelSpecConstant> constants, std::vector<uint8_t>& values) const {
+      bool all_found = true;
+      for (const auto& constant : constants) {
+            const auto find = constant.pName ? _specConstantIndex.find(constant.pName) : _specConstantIndex.end();
+            if (find == _specConstantIndex.end()) {
+                  auto err = std::format("[Kernel::ApplySpecConstants] Unknown specialization constant \"{}\".", constant.pName ? constant.pName : "");
+                  if(!_resourceName.empty()) err += std::format(" - Name: \"{}\"", _resourceName);
+                  MessageManager::Log(MessageType::Warning, err);
+                  all_found = false;
+                  continue;
+            }
+            const auto& entry = _specMapEntries[find->second];
+            const uint64_t value = _specIsBool[find->second] ? (constant.Value != 0 ? 1 : 0) : constant.Value;
+            std::memcpy(values.data() + entry.offset, &value, entry.size); // little endian, narrower constants take the low bytes
+      }
+      return all_found;
+}
+
+VkPipeline Kernel::FetchPipeline(const KernelRenderState& state) {
+      if (_isComputeKernel) return _pipeline.load(std::memory_order_acquire);
+      std::unique_lock lock(_variantMutex);
+      return FetchPipelineVariant(nullptr, state);
+}
+
+VkPipeline Kernel::FetchPipelineVariant(const Program* program, const KernelRenderState& state) {
+      uint64_t key = XXH3_64bits(_specValues.data(), _specValues.size());
+      if (!_isComputeKernel) key = XXH3_64bits_withSeed(&state, sizeof(KernelRenderState), key);
+
+      // the hash only picks the bucket, a hit must match the exact values or two variants could share a pipeline
+      auto& bucket = _pipelineVariants[key];
+      for (const auto& variant : bucket) {
+            if (variant.SpecValues != _specValues) continue;
+            if (!_isComputeKernel && std::memcmp(&variant.State, &state, sizeof(KernelRenderState)) != 0) continue;
+            return variant.Pipeline;
+      }
+
+      if (!program) program = GfxContext::Get()->ResourceFetch<Program>(_program);
+      if (!program) {
+            std::string err = "[Kernel::FetchPipelineVariant] Program was destroyed, can not create a new variant.";
+            if(!_resourceName.empty()) err += std::format(" - Name: \"{}\"", _resourceName);
+            MessageManager::Log(MessageType::Error, err);
+            return VK_NULL_HANDLE;
+      }
+
+      const VkSpecializationInfo spec_info{
+            .mapEntryCount = (uint32_t)_specMapEntries.size(),
+            .pMapEntries = _specMapEntries.data(),
+            .dataSize = _specValues.size(),
+            .pData = _specValues.data()
+      };
+      const VkSpecializationInfo* spec_ptr = _specMapEntries.empty() ? nullptr : &spec_info;
+
+      const VkPipeline pipeline = _isComputeKernel ? CreateComputePipeline(program, spec_ptr) : CreateGraphicsPipeline(program, spec_ptr, state);
+      if (pipeline) {
+            bucket.push_back(PipelineVariant{_specValues, state, pipeline});
+            _variantCount.fetch_add(1, std::memory_order_relaxed);
+      }
+      return pipeline;
+}
+
+VkPipeline Kernel::CreateGraphicsPipeline(const Program* program, const VkSpecializationInfo* spec_info, const KernelRenderState& state) const {
       std::vector<VkPipelineShaderStageCreateInfo> stages{
             {
                   .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
                   .stage = VK_SHADER_STAGE_VERTEX_BIT,
-                  .module = program->GetShaderModules().at(glslang_stage_t::GLSLANG_STAGE_VERTEX).second,
-                  .pName = "main"
+                  .module = program->GetShaderModules().at(glslang_stage_t::GLSLANG_STAGE_VERTEX),
+                  .pName = "main",
+                  .pSpecializationInfo = spec_info
             },
             {
                   .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
                   .stage = VK_SHADER_STAGE_FRAGMENT_BIT,
-                  .module = program->GetShaderModules().at(glslang_stage_t::GLSLANG_STAGE_FRAGMENT).second,
-                  .pName = "main"
+                  .module = program->GetShaderModules().at(glslang_stage_t::GLSLANG_STAGE_FRAGMENT),
+                  .pName = "main",
+                  .pSpecializationInfo = spec_info
             }
       };
 
@@ -104,10 +241,63 @@ bool Kernel::CreateAsGraphics(const Program* program) {
       };
 
       VkPipelineMultisampleStateCreateInfo multisample_ci = program->_multiSampleCreateInfo;
+      multisample_ci.rasterizationSamples = state.Samples;
+
+      const VkPipelineRenderingCreateInfo rendering_ci{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO,
+            .colorAttachmentCount = state.ColorCount,
+            .pColorAttachmentFormats = state.ColorFormats,
+            .depthAttachmentFormat = state.DepthFormat,
+            .stencilAttachmentFormat = state.StencilFormat
+      };
+
+      // program blend states are reused per attachment index, extra attachments repeat the last one
+      const auto& program_blend = program->_colorBlendAttachmentState;
+      std::vector<VkPipelineColorBlendAttachmentState> blend_attachments(state.ColorCount);
+      for (uint32_t i = 0; i < state.ColorCount; i++) {
+            auto& blend = blend_attachments[i];
+            if (!program_blend.empty()) {
+                  blend = program_blend[std::min<size_t>(i, program_blend.size() - 1)];
+            } else {
+                  blend.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+            }
+
+            switch (state.Blend) {
+                  case GfxEnumBlendOverride::DISABLED:
+                        blend.blendEnable = VK_FALSE;
+                        break;
+                  case GfxEnumBlendOverride::ADD:
+                        blend.blendEnable = VK_TRUE;
+                        blend.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+                        blend.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+                        blend.colorBlendOp = VK_BLEND_OP_ADD;
+                        blend.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+                        blend.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+                        blend.alphaBlendOp = VK_BLEND_OP_ADD;
+                        break;
+                  case GfxEnumBlendOverride::ALPHA:
+                        blend.blendEnable = VK_TRUE;
+                        blend.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+                        blend.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+                        blend.colorBlendOp = VK_BLEND_OP_ADD;
+                        blend.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+                        blend.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+                        blend.alphaBlendOp = VK_BLEND_OP_ADD;
+                        break;
+                  default: break;
+            }
+      }
+
+      VkPipelineColorBlendStateCreateInfo color_blend_ci = program->_colorBlendStateCreateInfo;
+      color_blend_ci.attachmentCount = (uint32_t)blend_attachments.size();
+      color_blend_ci.pAttachments = blend_attachments.data();
 
+      // cull mode and front face are core dynamic state in Vulkan 1.3, set by RenderNode at bind time
       std::array dynamic_states{
             VK_DYNAMIC_STATE_VIEWPORT,
-            VK_DYNAMIC_STATE_SCISSOR
+            VK_DYNAMIC_STATE_SCISSOR,
+            VK_DYNAMIC_STATE_CULL_MODE,
+            VK_DYNAMIC_STATE_FRONT_FACE
       };
 
       VkPipelineDynamicStateCreateInfo dynamic_state_ci{
@@ -118,7 +308,7 @@ bool Kernel::CreateAsGraphics(const Program* program) {
 
       VkGraphicsPipelineCreateInfo pipeline_ci{
             .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
-            .pNext = &program->_renderingCreateInfo,
+            .pNext = &rendering_ci,
             .flags = 0,
             .stageCount = (uint32_t)stages.size(),
             .pStages = stages.data(),
@@ -129,48 +319,29 @@ bool Kernel::CreateAsGraphics(const Program* program) {
             .pRasterizationState = &program->_rasterizationStateCreateInfo,
             .pMultisampleState = &multisample_ci,
             .pDepthStencilState = &program->_depthStencilStateCreateInfo,
-            .pColorBlendState = &program->_colorBlendStateCreateInfo,
+            .pColorBlendState = &color_blend_ci,
             .pDynamicState = &dynamic_state_ci,
             .layout = _pipelineLayout
       };
 
-      if (const auto result = vkCreateGraphicsPipelines(volkGetLoadedDevice(), nullptr, 1, &pipeline_ci, nullptr, &_pipeline); result != VK_SUCCESS) {
-            auto err = std::format("[Kernel::CreateAsGraphics] vkCreateGraphicsPipelines Failed, return {}.", ToStringVkResult(result));
+      VkPipeline pipeline{};
+      if (const auto result = vkCreateGraphicsPipelines(volkGetLoadedDevice(), nullptr, 1, &pipeline_ci, nullptr, &pipeline); result != VK_SUCCESS) {
+            auto err = std::format("[Kernel::CreateGraphicsPipeline] vkCreateGraphicsPipelines Failed, return {}.", ToStringVkResult(result));
             if(!_resourceName.empty()) err += std::format(" - Name: \"{}\"", _resourceName);
             MessageManager::Log(MessageType::Error, err);
-            return false;
+            return VK_NULL_HANDLE;
       }
 
-      _isComputeKernel = false;
-      _pushConstantBuffer.resize(_pushConstantRange.size);
-
-      return true;
+      return pipeline;
 }
 
-bool Kernel::CreateAsCompute(const Program* program) {
-      _pushConstantRange = program->GetPushConstantRange();
-      _pushConstantDefine = program->GetPushConstantDefine();
-
-      VkPipelineLayoutCreateInfo pipeline_layout_ci{
-            .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-            .setLayoutCount = 1,
-            .pSetLayouts = &LoFi::GfxContext::Get()->_bindlessDescriptorSetLayout,
-            .pushConstantRangeCount = 1,
-            .pPushConstantRanges = &_pushConstantRange
-      };
-
-      if (const auto result = vkCreatePipelineLayout(volkGetLoadedDevice(), &pipeline_layout_ci, nullptr, &_pipelineLayout); result != VK_SUCCESS) {
-            auto err = std::format("[Kernel::CreateAsCompute] vkCreatePipelineLayout Failed, return {}.", ToStringVkResult(result));
-            if(!_resourceName.empty()) err += std::format(" - Name: \"{}\"", _resourceName);
-            MessageManager::Log(MessageType::Error, err);
-            return false;
-      }
-
+VkPipeline Kernel::CreateComputePipeline(const Program* program, const VkSpecializationInfo* spec_info) const {
       VkPipelineShaderStageCreateInfo cs_ci = {
             .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
             .stage = VK_SHADER_STAGE_COMPUTE_BIT,
-            .module = program->GetShaderModules().at(glslang_stage_t::GLSLANG_STAGE_COMPUTE).second,
-            .pName = "main"
+            .module = program->GetShaderModules().at(glslang_stage_t::GLSLANG_STAGE_COMPUTE),
+            .pName = "main",
+            .pSpecializationInfo = spec_info
       };
 
       VkComputePipelineCreateInfo pipelineInfo{
@@ -179,17 +350,33 @@ bool Kernel::CreateAsCompute(const Program* program) {
             .layout = _pipelineLayout
       };
 
-      if (const auto result = vkCreateComputePipelines(volkGetLoadedDevice(), nullptr, 1, &pipelineInfo, nullptr, &_pipeline); result != VK_SUCCESS) {
-            auto err = std::format("[Kernel::CreateAsCompute] vkCreateComputePipelines Failed, return {}.", ToStringVkResult(result));
+      VkPipeline pipeline{};
+      if (const auto result = vkCreateComputePipelines(volkGetLoadedDevice(), nullptr, 1, &pipelineInfo, nullptr, &pipeline); result != VK_SUCCESS) {
+            auto err = std::format("[Kernel::CreateComputePipeline] vkCreateComputePipelines Failed, return {}.", ToStringVkResult(result));
             if(!_resourceName.empty()) err += std::format(" - Name: \"{}\"", _resourceName);
             MessageManager::Log(MessageType::Error, err);
-            return false;
+            return VK_NULL_HANDLE;
       }
 
-      _isComputeKernel = true;
-      _pushConstantBuffer.resize(_pushConstantRange.size);
+      return pipeline;
+}
 
-      return true;
+bool Kernel::SetSpecConstants(std::span<const GfxInfoKernelSpecConstant> constants) {
+      std::unique_lock lock(_variantMutex);
+
+      std::vector<uint8_t> values = _specValues;
+      const bool all_found = ApplySpecConstants(constants, values);
+      if (values == _specValues) return all_found;
+
+      const auto previous = std::exchange(_specValues, std::move(values));
+      const auto pipeline = FetchPipelineVariant(nullptr, _defaultRenderState);
+      if (!pipeline) {
+            _specValues = previous;
+            return false;
+      }
+
+      _pipeline.store(pipeline, std::memory_order_release);
+      return all_found;
 }
 
 bool Kernel::SetConstantValue(const std::string& name, const void* data) {
@@ -201,6 +388,19 @@ bool Kernel::SetConstantValue(const std::string& name, const void* data) {
       return false;
 }
 
+bool Kernel::SetConstantValue(GfxKernelConstantSlot slot, const void* data) {
+      if(slot.Size == 0 || !data || (size_t)slot.Offset + slot.Size > _pushConstantBuffer.size()) return false;
+      std::memcpy(_pushConstantBuffer.data() + slot.Offset, data, slot.Size);
+      return true;
+}
+
+GfxKernelConstantSlot Kernel::GetConstantSlot(const std::string& name) const {
+      if(const auto parameter_find = _pushConstantDefine.find(name); parameter_find != _pushConstantDefine.end()) {
+            return {parameter_find->second.Offset, parameter_find->second.Size};
+      }
+      return {};
+}
+
 bool Kernel::FillConstantValue(const void* data, size_t size) {
       if(_pushConstantBuffer.empty()) return false;
       size_t copy_size = std::min(size, _pushConstantBuffer.size());
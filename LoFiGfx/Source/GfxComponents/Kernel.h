@@ -7,6 +7,9 @@
 #include "Defines.h"
 #include "../Helper.h"
 
+#include <atomic>
+#include <mutex>
+
 namespace LoFi::Component::Gfx {
       class Program;
       class Kernel {
@@ -21,7 +24,7 @@ namespace LoFi::Component::Gfx {
 
             [[nodiscard]] const std::string& GetResourceName() const { return _resourceName; }
 
-            [[nodiscard]] VkPipeline GetPipeline() const { return _pipeline; }
+            [[nodiscard]] VkPipeline GetPipeline() const { return _pipeline.load(std::memory_order_acquire); }
 
             [[nodiscard]] VkPipelineLayout GetPipelineLayout() const { return _pipelineLayout; }
 
@@ -41,8 +44,29 @@ namespace LoFi::Component::Gfx {
 
             void UseDefaultPushConstant(bool use) { _useDefaultPushConstant = use; }
 
+            [[nodiscard]] std::span<const uint8_t> GetDefaultPushConstantData() const {
+                  if (_pushConstantRange.size == 0 || !_useDefaultPushConstant) return {};
+                  return _pushConstantBuffer;
+            }
+
             bool SetConstantValue(const std::string& name, const void* data);
 
+            bool SetConstantValue(GfxKernelConstantSlot slot, const void* data);
+
+            [[nodiscard]] GfxKernelConstantSlot GetConstantSlot(const std::string& name) const;
+
+            // switches the active pipeline to the variant for these values, compiled on first use
+            bool SetSpecConstants(std::span<const GfxInfoKernelSpecConstant> constants);
+
+            [[nodiscard]] size_t GetPipelineVariantCount() const { return _variantCount.load(std::memory_order_relaxed); }
+
+            // graphics pipeline for the given attachments, compiled and cached on first use; compute kernels return GetPipeline()
+            VkPipeline FetchPipeline(const KernelRenderState& state);
+
+            [[nodiscard]] VkCullModeFlags GetDefaultCullMode() const { return _defaultCullMode; }
+
+            [[nodiscard]] VkFrontFace GetDefaultFrontFace() const { return _defaultFrontFace; }
+
             bool FillConstantValue(const void* data, size_t size);
 
             void CmdPushConstants(VkCommandBuffer cmd) const;
@@ -52,6 +76,23 @@ namespace LoFi::Component::Gfx {
 
             bool CreateAsCompute(const Program* program);
 
+            void InitSpecConstants(const Program* program, const GfxParamCreateKernel& param);
+
+            bool ApplySpecConstants(std::span<const GfxInfoKernelSpecConstant> constants, std::vector<uint8_t>& values) const;
+
+            // caller holds _variantMutex
+            VkPipeline FetchPipelineVariant(const Program* program, const KernelRenderState& state);
+
+            VkPipeline CreateGraphicsPipeline(const Program* program, const VkSpecializationInfo* spec_info, const KernelRenderState& state) const;
+
+            VkPipeline CreateComputePipeline(const Program* program, const VkSpecializationInfo* spec_info) const;
+
+            struct PipelineVariant {
+                  std::vector<uint8_t> SpecValues;
+                  KernelRenderState State;
+                  VkPipeline Pipeline;
+            };
+
       private:
             entt::entity _id = entt::null;
 
@@ -59,7 +100,7 @@ namespace LoFi::Component::Gfx {
 
             bool _useDefaultPushConstant = true;
 
-            VkPipeline _pipeline{};
+            std::atomic<VkPipeline> _pipeline{}; // swapped by SetSpecConstants while nodes record
 
             VkPipelineLayout _pipelineLayout{};
 
@@ -71,6 +112,29 @@ namespace LoFi::Component::Gfx {
 
             bool UsingBindless = false;
 
+            ResourceHandle _program{};
+
+            entt::dense_map<std::string, uint32_t> _specConstantIndex{}; // name -> index in _specMapEntries
+
+            std::vector<VkSpecializationMapEntry> _specMapEntries{};
+
+            std::vector<bool> _specIsBool{};
+
+            std::vector<uint8_t> _specValues{}; // packed specialization data, laid out by _specMapEntries
+
+            // keyed by hash of _specValues and render state, a bucket holds every variant sharing that hash, _pipeline is the active one
+            entt::dense_map<uint64_t, std::vector<PipelineVariant>> _pipelineVariants{};
+
+            std::atomic<size_t> _variantCount = 0;
+
+            std::mutex _variantMutex{}; // guards _specValues and _pipelineVariants
+
+            KernelRenderState _defaultRenderState{}; // from the program's "#set rt" / "#set ds"
+
+            VkCullModeFlags _defaultCullMode = VK_CULL_MODE_NONE;
+
+            VkFrontFace _defaultFrontFace = VK_FRONT_FACE_CLOCKWISE;
+
       private:
             std::string _resourceName{};
       };
@@ -6,6 +6,13 @@
 #include "../Third/spirv-cross/spirv_cross.hpp"
 #include "../Third/glslang/Public/resource_limits_c.h"
 
+#include <spirv-tools/libspirv.hpp>
+#include <spirv-tools/optimizer.hpp>
+
+#include <bit>
+#include <cstring>
+#include <ranges>
+
 using namespace LoFi::Component::Gfx;
 using namespace LoFi::Internal;
 
@@ -48,53 +55,65 @@ ProgramCompilerGroup::~ProgramCompilerGroup() {
 }
 
 Program::~Program() {
-      for (auto& value : _shaderModules | std::views::values) {
-            if (value.second != VK_NULL_HANDLE) {
-                  vkDestroyShaderModule(volkGetLoadedDevice(), value.second, nullptr);
+      for (const auto module : _shaderModules | std::views::values) {
+            if (module != VK_NULL_HANDLE) {
+                  vkDestroyShaderModule(volkGetLoadedDevice(), module, nullptr);
             }
       }
       _shaderModules.clear();
 }
 
-bool Program::Init(const char* name, std::string_view config, const std::vector<std::string_view>& sources) {
+bool Program::Init(const char* name, std::string_view config, const std::vector<std::string_view>& sources, GfxEnumShaderOptimization optimization) {
+      _programName = name ? name : "Unname Program";
+
+      optimization = PeekConfigOptimization(config, optimization);
+
+      std::vector<std::pair<glslang_stage_t, std::vector<uint32_t>>> spvs{};
+      if (std::string compile_err{}; !CompileToSpirv(sources, spvs, compile_err, optimization)) {
+            auto err = std::format("[ProgramCreate] Compile failed, Because:\n {}", compile_err);
+            if (!_programName.empty()) err += std::format(" - Name: \"{}\"", _programName);
+            MessageManager::Log(MessageType::Error, err);
+            return false;
+      }
+
+      std::vector<std::pair<glslang_stage_t, std::span<const uint32_t>>> spv_views{};
+      for (const auto& [stage, spv] : spvs) spv_views.emplace_back(stage, spv);
+      return InitFromSpirv(name, config, std::move(spv_views));
+}
+
+bool Program::InitFromSpirv(const char* name, std::string_view config, std::vector<std::pair<glslang_stage_t, std::span<const uint32_t>>> spvs) {
       _config = config;
       _programName = name ? name : "Unname Program";
 
-      ProgramCompilerGroup::TryInit();
-      std::vector<std::pair<std::string_view, glslang_stage_t>> graphics_sources{};
-      entt::dense_map<glslang_stage_t, std::string_view> source_types{};
-      for (auto source : sources) {
-            auto shader_type = RecognitionShaderTypeFromSource(source);
-            if (shader_type.has_value()) {
-                  if (source_types.contains(shader_type.value())) {
-                        auto err = std::format("[ProgramCreate] Shader Type {} is repeat.", HelperShaderStageToString(shader_type.value()));
-                        if (!_programName.empty()) err += std::format(" - Name: \"{}\"", _programName);
-                        MessageManager::Log(MessageType::Error, err);
-                        return false;
-                  } else {
-                        source_types.insert({shader_type.value(), source});
-                  }
+      entt::dense_map<glslang_stage_t, std::span<const uint32_t>> spv_types{};
+      for (const auto& [stage, spv] : spvs) {
+            if (spv_types.contains(stage)) {
+                  auto err = std::format("[ProgramCreate] Shader Type {} is repeat.", HelperShaderStageToString(stage));
+                  if (!_programName.empty()) err += std::format(" - Name: \"{}\"", _programName);
+                  MessageManager::Log(MessageType::Error, err);
+                  return false;
             }
+            spv_types.insert({stage, spv});
       }
 
-      //try pick graphics sources
-      if (source_types.contains(glslang_stage_t::GLSLANG_STAGE_VERTEX) && source_types.contains(glslang_stage_t::GLSLANG_STAGE_FRAGMENT)) {
-            graphics_sources.emplace_back(source_types.at(glslang_stage_t::GLSLANG_STAGE_VERTEX), glslang_stage_t::GLSLANG_STAGE_VERTEX);
-            graphics_sources.emplace_back(source_types.at(glslang_stage_t::GLSLANG_STAGE_FRAGMENT), glslang_stage_t::GLSLANG_STAGE_FRAGMENT);
+      if (spv_types.contains(GLSLANG_STAGE_VERTEX) && spv_types.contains(GLSLANG_STAGE_FRAGMENT)) {
+            std::vector<std::pair<glslang_stage_t, std::span<const uint32_t>>> graphics_spvs{};
+            graphics_spvs.emplace_back(GLSLANG_STAGE_VERTEX, spv_types.at(GLSLANG_STAGE_VERTEX));
+            graphics_spvs.emplace_back(GLSLANG_STAGE_FRAGMENT, spv_types.at(GLSLANG_STAGE_FRAGMENT));
             try {
-                  CompileGraphics(graphics_sources);
+                  CreateGraphics(graphics_spvs);
             } catch (std::exception& e) {
-                  auto err = std::format("[ProgramCreate] CompileGraphics failed, Because:\n {}", e.what());
+                  auto err = std::format("[ProgramCreate] CreateGraphics failed, Because:\n {}", e.what());
                   if (!_programName.empty()) err += std::format(" - Name: \"{}\"", _programName);
                   MessageManager::Log(MessageType::Error, err);
                   return false;
             }
             _programType = ProgramType::GRAPHICS;
-      } else if (source_types.contains(glslang_stage_t::GLSLANG_STAGE_COMPUTE)) {
+      } else if (spv_types.contains(GLSLANG_STAGE_COMPUTE)) {
             try {
-                  CompileCompute(source_types.at(glslang_stage_t::GLSLANG_STAGE_COMPUTE));
+                  CreateCompute(spv_types.at(GLSLANG_STAGE_COMPUTE));
             } catch (std::exception& e) {
-                  auto err = std::format("[ProgramCreate] CompileCompute failed, Because:\n {}", e.what());
+                  auto err = std::format("[ProgramCreate] CreateCompute failed, Because:\n {}", e.what());
                   if (!_programName.empty()) err += std::format(" - Name: \"{}\"", _programName);
                   MessageManager::Log(MessageType::Error, err);
                   return false;
@@ -111,10 +130,59 @@ bool Program::Init(const char* name, std::string_view config, const std::vector<
       return true;
 }
 
+bool Program::CompileToSpirv(const std::vector<std::string_view>& sources, std::vector<std::pair<glslang_stage_t, std::vector<uint32_t>>>& spvs, std::string& err_msg,
+GfxEnumShaderOptimization optimization) {
+      ProgramCompilerGroup::TryInit();
+
+      entt::dense_map<glslang_stage_t, std::string_view> source_types{};
+      for (auto source : sources) {
+            auto shader_type = RecognitionShaderTypeFromSource(source);
+            if (shader_type.has_value()) {
+                  if (source_types.contains(shader_type.value())) {
+                        err_msg = std::format("Shader Type {} is repeat.", HelperShaderStageToString(shader_type.value()));
+                        return false;
+                  }
+                  source_types.insert({shader_type.value(), source});
+            }
+      }
+
+      //try pick graphics sources
+      std::vector<glslang_stage_t> stages{};
+      if (source_types.contains(GLSLANG_STAGE_VERTEX) && source_types.contains(GLSLANG_STAGE_FRAGMENT)) {
+            stages = {GLSLANG_STAGE_VERTEX, GLSLANG_STAGE_FRAGMENT};
+      } else if (source_types.contains(GLSLANG_STAGE_COMPUTE)) {
+            stages = {GLSLANG_STAGE_COMPUTE};
+      } else {
+            err_msg = "Failed to find shader type, unknown shader type.";
+            return false;
+      }
+
+      for (auto stage : stages) {
+            const std::string_view source = source_types.at(stage);
+            std::string source_code_replace_entry = std::string{source};
+
+            for (const auto& key : ShaderTypeMap | std::views::keys) {
+                  if (auto entry_pos = source.find(key); entry_pos != std::string::npos) {
+                        source_code_replace_entry.replace(entry_pos, 6, "  main");
+                  }
+            }
+
+            std::vector<uint32_t> spv{};
+            std::string compile_err{};
+            if (!CompileFromCode(source_code_replace_entry.data(), stage, spv, compile_err, optimization)) {
+                  err_msg = std::format("Err in Shader:\"{}\".\nShaderCompiler:\n{}", HelperShaderStageToString(stage), compile_err);
+                  return false;
+            }
+            spvs.emplace_back(stage, std::move(spv));
+      }
+
+      return true;
+}
+
 Program::Program(entt::entity id) : _id(id) {}
 
 
-void Program::CompileCompute(std::string_view source) {
+void Program::CreateCompute(std::span<const uint32_t> spv) {
       _pushConstantRange = VkPushConstantRange{
             .stageFlags = VK_SHADER_STAGE_ALL,
             .offset = 0,
@@ -129,52 +197,31 @@ void Program::CompileCompute(std::string_view source) {
             .pCode = nullptr
       };
 
-      //std::string header{};
-      //header += "#extension GL_EXT_nonuniform_qualifier : enable\n";
-      //header += "#extension GL_EXT_buffer_reference : enable\n";
-      //header += "#extension GL_EXT_scalar_block_layout : enable\n";
-      //header += "#extension GL_EXT_buffer_reference2 : require\n";
-      //header += "#define BindlessSamplerBinding 0\n";
-      //header += "#define BindlessStorageTextureBinding 1\n";
-
-      std::string compile_err{};
-      std::vector<uint32_t> spv{};
       VkShaderModule shader_module{};
 
-      std::string source_code_replace_entry = std::string{source};
-
-      for (const auto& key : ShaderTypeMap | std::views::keys) {
-            if (auto entry_pos = source.find(key); entry_pos != std::string::npos) {
-                  source_code_replace_entry.replace(entry_pos, 6, "  main");
-            }
-      }
-
-      if (!CompileFromCode(source_code_replace_entry.data(), GLSLANG_STAGE_COMPUTE, spv, compile_err)) {
-            auto err = std::format(R"([Program::CompileCompute] Failed to create Compute Program: "{}" -- {}.)", _programName, compile_err);
-            if (!_programName.empty()) err += std::format(" - Name: \"{}\"", _programName);
-            MessageManager::Log(MessageType::Error, err);
-            throw std::runtime_error(err);
-      }
+      ConfigParseStage(_config);
 
+      ValidateCapabilities(spv, GLSLANG_STAGE_COMPUTE);
       ParseCS(spv);
+      ParseSpecConstants(spv);
 
       shader_ci.codeSize = spv.size() * sizeof(uint32_t);
       shader_ci.pCode = spv.data();
 
       if (auto res = vkCreateShaderModule(volkGetLoadedDevice(), &shader_ci, nullptr, &shader_module); res != VK_SUCCESS) {
-            auto err = std::format(R"([Program::CompileCompute] Failed to create Compute Program: "{}".)", _programName);
-           if (!_programName.empty()) err += std::format(" - Name: \"{}\"", _programName);
+            auto err = std::format(R"([Program::CreateCompute] Failed to create Compute Program: "{}".)", _programName);
+            if (!_programName.empty()) err += std::format(" - Name: \"{}\"", _programName);
             MessageManager::Log(MessageType::Error, err);
             throw std::runtime_error(err);
       }
 
-      _shaderModules[GLSLANG_STAGE_COMPUTE] = std::make_pair(std::move(spv), shader_module);
+      _shaderModules[GLSLANG_STAGE_COMPUTE] = shader_module;
 
-      const auto success = std::format(R"([Program::CompileCompute] Successfully compiled Compute program "{}".)", _programName);
+      const auto success = std::format(R"([Program::CreateCompute] Successfully created Compute program "{}".)", _programName);
       MessageManager::Log(MessageType::Normal, success);
 }
 
-void Program::CompileGraphics(const std::vector<std::pair<std::string_view, glslang_stage_t>>& sources) {
+void Program::CreateGraphics(const std::vector<std::pair<glslang_stage_t, std::span<const uint32_t>>>& spvs) {
       _inputAssemblyStateCreateInfo = VkPipelineInputAssemblyStateCreateInfo{
             .sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
             .pNext = nullptr,
@@ -272,37 +319,9 @@ void Program::CompileGraphics(const std::vector<std::pair<std::string_view, glsl
 
       ConfigParseStage(_config);
 
-      //header += "#extension GL_EXT_nonuniform_qualifier : enable\n";
-      //header += "#extension GL_EXT_buffer_reference : enable\n";
-      //header += "#extension GL_EXT_scalar_block_layout : enable\n";
-      //header += "#extension GL_EXT_buffer_reference2 : require\n";
-      //header += "#define BindlessSamplerBinding 0\n";
-      //header += "#define BindlessStorageTextureBinding 1\n";
-
-      for (const auto& item : sources) {
-            glslang_stage_t shader_type = item.second;
-            const std::string_view source = item.first;
-
-            std::string setter_parse_err_msg{};
-
+      for (const auto& [shader_type, spv] : spvs) {
             std::string shader_type_str = HelperShaderStageToString(shader_type);
-            std::vector<uint32_t> spv{};
             VkShaderModule shader_module{};
-            std::string source_code_replace_entry = std::string{source};
-
-            for (const auto& key : ShaderTypeMap | std::views::keys) {
-                  if (auto entry_pos = source.find(key); entry_pos != std::string::npos) {
-                        source_code_replace_entry.replace(entry_pos, 6, "  main");
-                  }
-            }
-
-            if (!CompileFromCode(source_code_replace_entry.data(), shader_type, spv, setter_parse_err_msg)) {
-                  auto err = std::format("[Program::CompileGraphics] Failed to create Graphic Program \"{}\", Err in Shader:\"{}\".\nShaderCompiler:\n{}",
-                  _programName, shader_type_str, setter_parse_err_msg);
-                  if (!_programName.empty()) err += std::format(" - Name: \"{}\"", _programName);
-                  MessageManager::Log(MessageType::Error, err);
-                  throw std::runtime_error(err);
-            }
 
             switch (shader_type) {
                   case GLSLANG_STAGE_VERTEX: ParseVS(spv);
@@ -311,30 +330,42 @@ void Program::CompileGraphics(const std::vector<std::pair<std::string_view, glsl
                         break;
                   default:
                         {
-                              auto err = std::format(R"([Program::CompileGraphics] Failed to create Graphic Program "{}", Err in Shader:"{}".)", _programName, shader_type_str);
+                              auto err = std::format(R"([Program::CreateGraphics] Failed to create Graphic Program "{}", Err in Shader:"{}".)", _programName, shader_type_str);
                               if (!_programName.empty()) err += std::format(" - Name: \"{}\"", _programName);
                               MessageManager::Log(MessageType::Error, err);
                               throw std::runtime_error(err);
                         }
             }
 
+            ValidateCapabilities(spv, shader_type);
+            ParseSpecConstants(spv);
+
             shader_ci.codeSize = spv.size() * sizeof(uint32_t);
             shader_ci.pCode = spv.data();
 
             if (auto res = vkCreateShaderModule(volkGetLoadedDevice(), &shader_ci, nullptr, &shader_module); res != VK_SUCCESS) {
-                  const auto err = std::format(R"(Program::CompileGraphics - Failed to create Graphic Program "{}", Err in Shader:"{}".)",
+                  const auto err = std::format(R"(Program::CreateGraphics - Failed to create Graphic Program "{}", Err in Shader:"{}".)",
                   _programName, shader_type_str);
                   throw std::runtime_error(err);
             }
 
-            _shaderModules[shader_type] = std::make_pair(std::move(spv), shader_module);
+            _shaderModules[shader_type] = shader_module;
       }
 
-      const auto success = std::format("Program::CompileGraphics - Successfully Create Graphics Program \"{}\".", _programName);
+      const auto success = std::format("Program::CreateGraphics - Successfully Create Graphics Program \"{}\".", _programName);
       MessageManager::Log(MessageType::Normal, success);
 }
 
-bool Program::CompileFromCode(const char* source, glslang_stage_t shader_type, std::vector<uint32_t>& spv, std::string& err_msg) {
+bool Program::CompileFromCode(const char* source, glslang_stage_t shader_type, std::vector<uint32_t>& spv, std::string& err_msg, GfxEnumShaderOptimization optimization) {
+      const uint64_t cache_key = XXH3_64bits_withSeed(source, std::strlen(source), ((uint64_t)shader_type << 8) | (uint64_t)optimization);
+      {
+            std::unique_lock lock(SpirvCacheMutex);
+            if (const auto find = SpirvCache.find(cache_key); find != SpirvCache.end()) {
+                  spv = find->second;
+                  return true;
+            }
+      }
+
       const glslang_input_t input = {
             .language = GLSLANG_SOURCE_GLSL,
             .stage = shader_type,
@@ -379,29 +410,106 @@ bool Program::CompileFromCode(const char* source, glslang_stage_t shader_type, s
             return false;
       }
 
-      // glslang_spv_options_t spv_options = {
-      //       .generate_debug_info = false,
-      //       .strip_debug_info = false,
-      //       .disable_optimizer = false,
-      //       .optimize_size = true,
-      //       .disassemble = false,
-      //       .validate = true,
-      //       .emit_nonsemantic_shader_debug_info = false,
-      //       .emit_nonsemantic_shader_debug_source = false,
-      //       .compile_only = false,
-      // };
-
-      //glslang_program_SPIRV_generate_with_options(program, stage, &spv_options);
-      glslang_program_SPIRV_generate(program, shader_type);
-
+      // generate unoptimized once, spirv-opt runs below so the requested pass set is the one that actually executes
+      glslang_spv_options_t spv_options = {
+            .generate_debug_info = false,
+            .strip_debug_info = false,
+            .disable_optimizer = true,
+            .optimize_size = false,
+            .disassemble = false,
+            .validate = false,
+            .emit_nonsemantic_shader_debug_info = false,
+            .emit_nonsemantic_shader_debug_source = false,
+            .compile_only = false,
+      };
+      glslang_program_SPIRV_generate_with_options(program, shader_type, &spv_options);
       spv.resize(glslang_program_SPIRV_get_size(program));
-      memcpy(spv.data(), glslang_program_SPIRV_get_ptr(program), glslang_program_SPIRV_get_size(program) * sizeof(uint32_t));
+      memcpy(spv.data(), glslang_program_SPIRV_get_ptr(program), spv.size() * sizeof(uint32_t));
+
       glslang_program_delete(program);
       glslang_shader_delete(shader);
 
+      if (optimization != GfxEnumShaderOptimization::NONE) {
+            OptimizeSpirv(spv, shader_type, optimization);
+      }
+
+      {
+            std::unique_lock lock(SpirvCacheMutex);
+            SpirvCache.emplace(cache_key, spv);
+      }
+
       return true;
 }
 
+GfxEnumShaderOptimization Program::PeekConfigOptimization(std::string_view config, GfxEnumShaderOptimization fallback) {
+      for (const auto line : std::views::split(config, '\n')) {
+            std::vector<std::string_view> words{};
+            for (const auto word : std::views::split(std::string_view(line.begin(), line.end()), ' ')) {
+                  if (!word.empty()) words.emplace_back(word.begin(), word.end());
+            }
+
+            if (words.size() >= 4 && words[0] == "#set" && words[1] == "optimize" && words[2] == "=") {
+                  if (words[3] == "none") return GfxEnumShaderOptimization::NONE;
+                  if (words[3] == "size") return GfxEnumShaderOptimization::SIZE;
+                  if (words[3] == "performance") return GfxEnumShaderOptimization::PERFORMANCE;
+            }
+      }
+      return fallback;
+}
+
+void Program::OptimizeSpirv(std::vector<uint32_t>& spv, glslang_stage_t shader_type, GfxEnumShaderOptimization optimization) {
+      const char* mode = optimization == GfxEnumShaderOptimization::SIZE ? "size" : "performance";
+
+      std::string diagnostics{};
+      const auto consumer = [&](spv_message_level_t level, const char*, const spv_position_t& position, const char* message) {
+            if (level > SPV_MSG_WARNING) return;
+            diagnostics += std::format(" [{}] {}", position.index, message);
+      };
+
+      spvtools::Optimizer optimizer(SPV_ENV_VULKAN_1_3);
+      optimizer.SetMessageConsumer(consumer);
+      if (optimization == GfxEnumShaderOptimization::SIZE) optimizer.RegisterSizePasses();
+      else optimizer.RegisterPerformancePasses();
+
+      // the canvas shaders use buffer_reference blocks with scalar layout, std430 rules would reject them
+      spvtools::ValidatorOptions validator_options{};
+      validator_options.SetScalarBlockLayout(true);
+      validator_options.SetRelaxBlockLayout(true);
+
+      spvtools::OptimizerOptions optimizer_options{};
+      optimizer_options.set_run_validator(true);
+      optimizer_options.set_validator_options(validator_options);
+
+      spvtools::SpirvTools validator(SPV_ENV_VULKAN_1_3);
+      validator.SetMessageConsumer(consumer);
+
+      // Run validates its input, the output is validated separately so a bad pass never reaches the driver
+      std::vector<uint32_t> optimized{};
+      if (!optimizer.Run(spv.data(), spv.size(), &optimized, optimizer_options) || !validator.Validate(optimized.data(), optimized.size(), validator_options)) {
+            const auto warn = std::format("[Program::OptimizeSpirv] SPIR-V {} {} optimization failed, using unoptimized code:{}", HelperShaderStageToString(shader_type), mode, diagnostics);
+            MessageManager::Log(MessageType::Warning, warn);
+            return;
+      }
+
+      const auto report = std::format("[Program::OptimizeSpirv] SPIR-V {} optimized ({}): {} -> {} instructions, {} -> {} words.", HelperShaderStageToString(shader_type),
+      mode, CountSpirvInstructions(spv), CountSpirvInstructions(optimized), spv.size(), optimized.size());
+      MessageManager::Log(MessageType::Normal, report);
+
+      spv = std::move(optimized);
+}
+
+uint32_t Program::CountSpirvInstructions(std::span<const uint32_t> spv) {
+      uint32_t count = 0;
+      // 5 word header, then each instruction stores its word count in the high half of its first word
+      for (size_t i = 5; i < spv.size();) {
+            const uint32_t word_count = spv[i] >> 16;
+            if (word_count == 0) break;
+            i += word_count;
+            count++;
+      }
+      return count;
+}
+
 void Program::ConfigParseStage(std::string_view config) {
       if (std::string err{}; !ParseConfig(config, err)) {
             const auto message = std::format("Program::ConfigParseStage - Failed to parse config: {}.  Err:\n{}\n", _programName, err);
@@ -561,8 +669,8 @@ bool Program::ParseConfig(std::string_view Config, std::string& error_message) {
       return true;
 }
 
-void Program::ParseVS(const std::vector<uint32_t>& spv) {
-      spirv_cross::Compiler comp(spv);
+void Program::ParseVS(std::span<const uint32_t> spv) {
+      spirv_cross::Compiler comp(spv.data(), spv.size());
       spirv_cross::ShaderResources resources = comp.get_shader_resources();
 
       if (_autoVSInputStageBind) {
@@ -728,8 +836,8 @@ void Program::ParseVS(const std::vector<uint32_t>& spv) {
       }
 }
 
-void Program::ParseFS(const std::vector<uint32_t>& spv) const {
-      spirv_cross::Compiler comp(spv);
+void Program::ParseFS(std::span<const uint32_t> spv) const {
+      spirv_cross::Compiler comp(spv.data(), spv.size());
       spirv_cross::ShaderResources resources = comp.get_shader_resources();
 
       auto output_target_count = resources.stage_outputs.size();
@@ -770,8 +878,150 @@ void Program::ParseFS(const std::vector<uint32_t>& spv) const {
       // }
 }
 
-void Program::ParseCS(const std::vector<uint32_t>& spv) {
-      spirv_cross::Compiler comp(spv);
+void Program::ValidateCapabilities(std::span<const uint32_t> spv, glslang_stage_t stage) const {
+      const auto& features = GfxContext::Get()->GetDeviceFeatures();
+      const bool subgroup_stage = stage == GLSLANG_STAGE_COMPUTE ? features.bSubgroupInCompute
+                                  : stage == GLSLANG_STAGE_VERTEX ? features.bSubgroupInVertex
+                                  : stage == GLSLANG_STAGE_FRAGMENT ? features.bSubgroupInFragment
+                                  : true;
+
+      spirv_cross::Compiler comp(spv.data(), spv.size());
+
+      std::string missing{};
+      auto Require = [&](bool enabled, const char* feature) {
+            if (enabled) return;
+            if (!missing.empty()) missing += ", ";
+            missing += feature;
+      };
+
+      for (const auto capability : comp.get_declared_capabilities()) {
+            switch (capability) {
+                  case spv::CapabilityFloat16: Require(features.bShaderFloat16, "shaderFloat16");
+                        break;
+                  case spv::CapabilityFloat64: Require(features.bShaderFloat64, "shaderFloat64");
+                        break;
+                  case spv::CapabilityInt8: Require(features.bShaderInt8, "shaderInt8");
+                        break;
+                  case spv::CapabilityInt16: Require(features.bShaderInt16, "shaderInt16");
+                        break;
+                  case spv::CapabilityInt64: Require(features.bShaderInt64, "shaderInt64");
+                        break;
+                  case spv::CapabilityInt64Atomics: {
+                        bool buffer = false, shared = false, image = false;
+                        CollectInt64AtomicStorage(spv, buffer, shared, image);
+                        if (buffer) Require(features.bShaderBufferInt64Atomics, "shaderBufferInt64Atomics");
+                        if (shared) Require(features.bShaderSharedInt64Atomics, "shaderSharedInt64Atomics");
+                        if (image) Require(false, "shaderImageInt64Atomics");
+                        break;
+                  }
+                  case spv::CapabilityInt64ImageEXT: Require(false, "shaderImageInt64Atomics");
+                        break;
+                  case spv::CapabilityStorageBuffer16BitAccess: Require(features.bStorageBuffer16BitAccess, "storageBuffer16BitAccess");
+                        break;
+                  case spv::CapabilityStorageUniform16: Require(features.bUniformAndStorageBuffer16BitAccess, "uniformAndStorageBuffer16BitAccess");
+                        break;
+                  case spv::CapabilityStoragePushConstant16: Require(features.bStoragePushConstant16, "storagePushConstant16");
+                        break;
+                  case spv::CapabilityStorageInputOutput16: Require(false, "storageInputOutput16");
+                        break;
+                  case spv::CapabilityStorageBuffer8BitAccess: Require(features.bStorageBuffer8BitAccess, "storageBuffer8BitAccess");
+                        break;
+                  case spv::CapabilityUniformAndStorageBuffer8BitAccess: Require(features.bUniformAndStorageBuffer8BitAccess, "uniformAndStorageBuffer8BitAccess");
+                        break;
+                  case spv::CapabilityStoragePushConstant8: Require(features.bStoragePushConstant8, "storagePushConstant8");
+                        break;
+                  case spv::CapabilityGroupNonUniform: Require(subgroup_stage && features.bSubgroupBasic, "subgroup basic");
+                        break;
+                  case spv::CapabilityGroupNonUniformVote: Require(subgroup_stage && features.bSubgroupVote, "subgroup vote");
+                        break;
+                  case spv::CapabilityGroupNonUniformArithmetic: Require(subgroup_stage && features.bSubgroupArithmetic, "subgroup arithmetic");
+                        break;
+                  case spv::CapabilityGroupNonUniformBallot: Require(subgroup_stage && features.bSubgroupBallot, "subgroup ballot");
+                        break;
+                  case spv::CapabilityGroupNonUniformShuffle: Require(subgroup_stage && features.bSubgroupShuffle, "subgroup shuffle");
+                        break;
+                  case spv::CapabilityGroupNonUniformShuffleRelative: Require(subgroup_stage && features.bSubgroupShuffleRelative, "subgroup shuffle relative");
+                        break;
+                  case spv::CapabilityGroupNonUniformClustered: Require(subgroup_stage && features.bSubgroupClustered, "subgroup clustered");
+                        break;
+                  case spv::CapabilityGroupNonUniformQuad: Require(subgroup_stage && features.bSubgroupQuad, "subgroup quad");
+                        break;
+                  default: break;
+            }
+      }
+
+      if (!missing.empty()) {
+            auto err = std::format("[Program::ValidateCapabilities] Shader \"{}\" requires features not enabled on this device: {}.", HelperShaderStageToString(stage), missing);
+            if (!_programName.empty()) err += std::format(" - Name: \"{}\"", _programName);
+            MessageManager::Log(MessageType::Error, err);
+            throw std::runtime_error(err);
+      }
+}
+
+void Program::CollectInt64AtomicStorage(std::span<const uint32_t> spv, bool& buffer, bool& shared, bool& image) {
+      entt::dense_map<uint32_t, uint32_t> int_width{};       // OpTypeInt id -> width
+      entt::dense_map<uint32_t, std::pair<uint32_t, uint32_t>> pointer_type{}; // OpTypePointer id -> storage class, pointee
+      entt::dense_map<uint32_t, uint32_t> pointer_value{};   // pointer value id -> its OpTypePointer id
+
+      // types and module scope variables come before the functions, so one pass sees every declaration before its use
+      for (size_t i = 5; i < spv.size();) {
+            const uint32_t word_count = spv[i] >> 16;
+            const auto op = (spv::Op)(spv[i] & 0xFFFF);
+            if (word_count == 0 || i + word_count > spv.size()) break;
+            const auto w = spv.subspan(i, word_count);
+
+            switch (op) {
+                  case spv::OpTypeInt: int_width[w[1]] = w[2];
+                        break;
+                  case spv::OpTypePointer: pointer_type[w[1]] = {w[2], w[3]};
+                        break;
+                  case spv::OpVariable:
+                  case spv::OpFunctionParameter:
+                  case spv::OpImageTexelPointer:
+                  case spv::OpAccessChain:
+                  case spv::OpInBoundsAccessChain:
+                  case spv::OpPtrAccessChain:
+                  case spv::OpCopyObject:
+                  case spv::OpLoad:
+                  case spv::OpBitcast:
+                  case spv::OpConvertUToPtr: if (pointer_type.contains(w[1])) pointer_value[w[2]] = w[1];
+                        break;
+                  default:
+                        if (op >= spv::OpAtomicLoad && op <= spv::OpAtomicXor) {
+                              const uint32_t pointer = op == spv::OpAtomicStore ? w[1] : w[3];
+                              const auto value = pointer_value.find(pointer);
+                              if (value == pointer_value.end()) break;
+                              const auto& [storage, pointee] = pointer_type[value->second];
+                              if (const auto width = int_width.find(pointee); width == int_width.end() || width->second != 64) break;
+
+                              if (storage == spv::StorageClassWorkgroup) shared = true;
+                              else if (storage == spv::StorageClassImage) image = true;
+                              else buffer = true;
+                        }
+                        break;
+            }
+            i += word_count;
+      }
+}
+
+void Program::ParseSpecConstants(std::span<const uint32_t> spv) {
+      spirv_cross::Compiler comp(spv.data(), spv.size());
+
+      for (const auto& constant : comp.get_specialization_constants()) {
+            const std::string& name = comp.get_name(constant.id);
+            if (name.empty()) continue;
+
+            const auto& value = comp.get_constant(constant.id);
+            const auto& type = comp.get_type(value.constant_type);
+            const bool is_bool = type.basetype == spirv_cross::SPIRType::Boolean;
+            const uint32_t size = is_bool ? sizeof(VkBool32) : std::max(type.width / 8, 1u);
+            const uint64_t default_value = size == 8 ? value.scalar_u64() : value.scalar();
+            _specConstantDefine.emplace(name, SpecConstantInfo{constant.constant_id, size, is_bool, default_value});
+      }
+}
+
+void Program::ParseCS(std::span<const uint32_t> spv) {
+      spirv_cross::Compiler comp(spv.data(), spv.size());
       spirv_cross::ShaderResources resources = comp.get_shader_resources();
 
       for (auto& resource : resources.push_constant_buffers) {
@@ -1240,6 +1490,37 @@ bool Program::AnalyzeConfig(const std::pair<std::string, std::vector<std::string
                   key, values.size());
                   return false;
             }
+      } else if (key == "optimize") {
+            // consumed by PeekConfigOptimization before compiling, only validated here
+            if (values.size() != 1) {
+                  return ErrorArgumentUnmatching(key, 1, values.size(), error_msg, "none, size, performance");
+            }
+            if (values[0] != "none" && values[0] != "size" && values[0] != "performance") {
+                  return ErrorArgument(key, 1, values[0], error_msg, "none, size, performance");
+            }
+      } else if (key == "spec") {
+            // name, value: true/false, float (1.0 / 1.0f), signed or unsigned integer
+            if (values.size() != 2) {
+                  return ErrorArgumentUnmatching(key, 2, values.size(), error_msg, "name, value");
+            }
+
+            const auto& value = values[1];
+            uint64_t bits;
+            try {
+                  if (value == "true" || value == "false") {
+                        bits = value == "true" ? 1 : 0;
+                  } else if (value.find('.') != std::string::npos || value.ends_with('f')) {
+                        bits = std::bit_cast<uint32_t>(std::stof(value));
+                  } else if (value.starts_with('-')) {
+                        bits = std::bit_cast<uint64_t>((int64_t)std::stoll(value));
+                  } else {
+                        bits = (uint64_t)std::stoull(value, nullptr, 0);
+                  }
+            } catch (...) {
+                  return ErrorArgument(key, 2, value, error_msg, "true, false, float, integer");
+            }
+
+            _specConstantConfig[values[0]] = bits;
       } else {
             error_msg = std::format("Invalid setter key \"{}\" .", key);
             return false;
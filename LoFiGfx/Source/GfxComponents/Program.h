@@ -6,6 +6,8 @@
 
 #include "glslang/Include/glslang_c_interface.h"
 
+#include <mutex>
+
 namespace LoFi::Component::Gfx {
 
       struct ProgramCompilerGroup {
@@ -32,6 +34,11 @@ namespace LoFi::Component::Gfx {
 
             static std::optional<glslang_stage_t> RecognitionShaderTypeFromSource(std::string_view source);
 
+            // compiled SPIR-V by hash of (source, stage, optimization level), shared by every program in the process
+            static inline std::mutex SpirvCacheMutex{};
+
+            static inline entt::dense_map<uint64_t, std::vector<uint32_t>> SpirvCache{};
+
       public:
             NO_COPY_MOVE_CONS(Program);
 
@@ -39,9 +46,18 @@ namespace LoFi::Component::Gfx {
 
             explicit Program(entt::entity id);
 
-            bool Init(const char* name, std::string_view config, const std::vector<std::string_view>& sources);
+            bool Init(const char* name, std::string_view config, const std::vector<std::string_view>& sources, GfxEnumShaderOptimization optimization = GfxEnumShaderOptimization::NONE);
+
+            // skips glslang, reflection still runs on the given modules
+            bool InitFromSpirv(const char* name, std::string_view config, std::vector<std::pair<glslang_stage_t, std::span<const uint32_t>>> spvs);
 
-            // TODO: LoadFromCache
+            static bool CompileToSpirv(const std::vector<std::string_view>& sources, std::vector<std::pair<glslang_stage_t, std::vector<uint32_t>>>& spvs, std::string& err_msg,
+                  GfxEnumShaderOptimization optimization = GfxEnumShaderOptimization::NONE);
+
+            // "#set optimize" has to be known before compiling, the rest of the config is parsed after reflection
+            static GfxEnumShaderOptimization PeekConfigOptimization(std::string_view config, GfxEnumShaderOptimization fallback);
+
+            static uint32_t CountSpirvInstructions(std::span<const uint32_t> spv);
 
             [[nodiscard]] bool IsCompiled() const { return _isCompiled; }
 
@@ -55,16 +71,25 @@ namespace LoFi::Component::Gfx {
 
             [[nodiscard]] auto& GetPushConstantRange() const { return  _pushConstantRange;}
 
-            [[nodiscard]] const entt::dense_map<glslang_stage_t, std::pair<std::vector<uint32_t>, VkShaderModule>>& GetShaderModules() const { return _shaderModules; }
+            [[nodiscard]] auto& GetSpecConstantDefine() const { return _specConstantDefine; }
+
+            [[nodiscard]] auto& GetSpecConstantConfig() const { return _specConstantConfig; }
+
+            [[nodiscard]] ResourceHandle Handle() const { return {GfxEnumResourceType::Program, _id}; }
+
+            [[nodiscard]] const entt::dense_map<glslang_stage_t, VkShaderModule>& GetShaderModules() const { return _shaderModules; }
 
       private:
-            static bool CompileFromCode(const char* source, glslang_stage_t shader_type, std::vector<uint32_t>& spv, std::string& err_msg);
+            static bool CompileFromCode(const char* source, glslang_stage_t shader_type, std::vector<uint32_t>& spv, std::string& err_msg, GfxEnumShaderOptimization optimization);
+
+            // runs spirv-opt's size or performance passes, keeps the input when the optimizer or validator rejects the result
+            static void OptimizeSpirv(std::vector<uint32_t>& spv, glslang_stage_t shader_type, GfxEnumShaderOptimization optimization);
 
             void ConfigParseStage(std::string_view config);
 
-            void CompileCompute(std::string_view source);
+            void CreateCompute(std::span<const uint32_t> spv);
 
-            void CompileGraphics(const std::vector<std::pair<std::string_view, glslang_stage_t>>& sources);
+            void CreateGraphics(const std::vector<std::pair<glslang_stage_t, std::span<const uint32_t>>>& spvs);
 
             bool ParseConfig(std::string_view Config, std::string& error_message);
 
@@ -72,11 +97,19 @@ namespace LoFi::Component::Gfx {
 
             bool VaildateConfig(std::string_view key, std::string_view value);
 
-            void ParseVS(const std::vector<uint32_t>& spv);
+            void ParseVS(std::span<const uint32_t> spv);
+
+            void ParseFS(std::span<const uint32_t> spv) const;
+
+            void ParseCS(std::span<const uint32_t> spv);
 
-            void ParseFS(const std::vector<uint32_t>& spv) const;
+            // throws when the module declares a capability the device was created without
+            void ValidateCapabilities(std::span<const uint32_t> spv, glslang_stage_t stage) const;
 
-            void ParseCS(const std::vector<uint32_t>& spv);
+            // storage classes touched by 64 bit integer atomics, Int64Atomics alone does not say which feature is needed
+            static void CollectInt64AtomicStorage(std::span<const uint32_t> spv, bool& buffer, bool& shared, bool& image);
+
+            void ParseSpecConstants(std::span<const uint32_t> spv);
 
             friend class Kernel;
 
@@ -98,7 +131,11 @@ namespace LoFi::Component::Gfx {
 
             entt::dense_map<std::string, PushConstantMemberInfo> _pushConstantDefine{};
 
-            entt::dense_map<glslang_stage_t, std::pair<std::vector<uint32_t>, VkShaderModule>> _shaderModules{};
+            entt::dense_map<std::string, SpecConstantInfo> _specConstantDefine{};
+
+            entt::dense_map<std::string, uint64_t> _specConstantConfig{}; // "#set spec = name value"
+
+            entt::dense_map<glslang_stage_t, VkShaderModule> _shaderModules{};
 
       private:
             VkPipelineInputAssemblyStateCreateInfo _inputAssemblyStateCreateInfo{};
@@ -65,11 +65,12 @@ void Texture::ClearViews() {
       ReleaseAllViews();
       _views.clear();
       _viewCIs.clear();
+      _sampledViewIndex = 0;
 }
 
 bool Texture::Resize(uint32_t w, uint32_t h) {
-      if (_isBorrow) {
-            std::string err = std::format("[Texture::Resize] Failed to (Resize)Recreate New Texture! Because this is a borrowed teture.");
+      if (_isBorrow || !IsResident()) {
+            std::string err = std::format("[Texture::Resize] Failed to (Resize)Recreate New Texture! Because this is a borrowed teture or not resident yet.");
             if (!_resourceName.empty()) err += std::format(" - Name: \"{}\"", _resourceName);
             MessageManager::Log(MessageType::Warning, err);
             return false;
@@ -114,8 +115,8 @@ bool Texture::Resize(uint32_t w, uint32_t h) {
 }
 
 void Texture::SetData(const void* data, size_t size) {
-      if (_isBorrow) {
-            std::string err = std::format("[Texture::SetData] Failed to SetData Texture! Because this is a borrowed teture.");
+      if (_isBorrow || !IsResident()) {
+            std::string err = std::format("[Texture::SetData] Failed to SetData Texture! Because this is a borrowed teture or not resident yet.");
             if (!_resourceName.empty()) err += std::format(" - Name: \"{}\"", _resourceName);
             MessageManager::Log(MessageType::Warning, err);
             return;
@@ -159,11 +160,50 @@ void Texture::SetData(const void* data, size_t size) {
 
       _intermediateBuffer->SetData(data, size);
 
-      auto imm_buffer = _intermediateBuffer->GetBuffer();
-      //auto trans_size = size;
+      RecordUpload(size);
+}
+
+void Texture::SetDataFromIntermediate(std::unique_ptr<Buffer> intermediate_buffer, size_t size) {
+      if (_isBorrow || !IsResident()) {
+            std::string err = std::format("[Texture::SetDataFromIntermediate] Failed to SetData Texture! Because this texture is borrowed or not created.");
+            if (!_resourceName.empty()) err += std::format(" - Name: \"{}\"", _resourceName);
+            MessageManager::Log(MessageType::Warning, err);
+            return;
+      }
+
+      _intermediateBuffer = std::move(intermediate_buffer);
+      RecordUpload(size);
+}
+
+bool Texture::SetRegionData(uint32_t x, uint32_t y, uint32_t w, uint32_t h, const void* data, size_t size) {
+      if (_isBorrow || !IsResident()) {
+            std::string err = std::format("[Texture::SetRegionData] Failed to SetData Texture! Because this is a borrowed teture or not resident yet.");
+            if (!_resourceName.empty()) err += std::format(" - Name: \"{}\"", _resourceName);
+            MessageManager::Log(MessageType::Warning, err);
+            return false;
+      }
+
+      if (w == 0 || h == 0 || x + w > _imageCI->extent.width || y + h > _imageCI->extent.height) {
+            auto err = std::format("[Texture::SetRegionData] Region ({}, {}, {}, {}) is out of the texture extent ({}, {}).", x, y, w, h, _imageCI->extent.width, _imageCI->extent.height);
+            if (!_resourceName.empty()) err += std::format(" - Name: \"{}\"", _resourceName);
+            MessageManager::Log(MessageType::Error, err);
+            return false;
+      }
+
+      const size_t region_size = GetFormatLevelSize(_imageCI->format, w, h);
+      if (size < region_size) {
+            auto err = std::format("[Texture::SetRegionData] Failed to Set Texture Data! Size Mismatch, Region Size: {}, New Data Size: {}.", region_size, size);
+            if (!_resourceName.empty()) err += std::format(" - Name: \"{}\"", _resourceName);
+            MessageManager::Log(MessageType::Error, err);
+            return false;
+      }
+
+      const size_t offset = _regionData.size();
+      _regionData.resize(offset + region_size);
+      memcpy(_regionData.data() + offset, data, region_size);
 
-      VkBufferImageCopy buffer_copyto_image{
-            .bufferOffset = 0,
+      _regionCopies.push_back(VkBufferImageCopy{
+            .bufferOffset = offset,
             .bufferRowLength = 0,
             .bufferImageHeight = 0,
             .imageSubresource = {
@@ -172,18 +212,61 @@ void Texture::SetData(const void* data, size_t size) {
                   .baseArrayLayer = 0,
                   .layerCount = 1
             },
-            .imageOffset = {},
-            .imageExtent = {
-                  .width = _imageCI->extent.width,
-                  .height = _imageCI->extent.height,
-                  .depth = 1
+            .imageOffset = {(int32_t)x, (int32_t)y, 0},
+            .imageExtent = {w, h, 1}
+      });
+
+      if (!_bNeedUpdate) {
+            LoFi::GfxContext::Get()->EnqueueTextureUpdate(GetHandle());
+            _bNeedUpdate = true;
+      }
+
+      return true;
+}
+
+void Texture::RecordUpload(size_t size) {
+      auto imm_buffer = _intermediateBuffer->GetBuffer();
+
+      // data is laid out level by level (mip 0 first), each level tightly packed in texel blocks
+      std::vector<VkBufferImageCopy> regions{};
+      size_t offset = 0;
+      for (uint32_t level = 0; level < _imageCI->mipLevels; level++) {
+            const uint32_t level_w = glm::max(_imageCI->extent.width >> level, 1u);
+            const uint32_t level_h = glm::max(_imageCI->extent.height >> level, 1u);
+            const size_t level_size = GetFormatLevelSize(_imageCI->format, level_w, level_h);
+            if (level_size > size - offset) {
+                  // the views cover every level, one left unwritten would be sampled undefined
+                  auto err = std::format("[Texture::RecordUpload] Failed to Set Texture Data! Data Size {} ends inside mip level {} of {}, it needs {} more bytes.", size, level,
+                  _imageCI->mipLevels, offset + level_size - size);
+                  if (!_resourceName.empty()) err += std::format(" - Name: \"{}\"", _resourceName);
+                  MessageManager::Log(MessageType::Error, err);
+                  return;
             }
-      };
 
-      _updateCommand = [=, this](VkCommandBuffer cmd) {
+            regions.push_back(VkBufferImageCopy{
+                  .bufferOffset = offset,
+                  .bufferRowLength = 0,
+                  .bufferImageHeight = 0,
+                  .imageSubresource = {
+                        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                        .mipLevel = level,
+                        .baseArrayLayer = 0,
+                        .layerCount = 1
+                  },
+                  .imageOffset = {},
+                  .imageExtent = {
+                        .width = level_w,
+                        .height = level_h,
+                        .depth = 1
+                  }
+            });
+            offset += level_size;
+      }
+
+      _updateCommand = [=, this, regions = std::move(regions)](VkCommandBuffer cmd) {
             this->BarrierLayout(cmd, GfxEnumKernelType::OUT_OF_KERNEL, GfxEnumResourceUsage::TRANS_DST);
             _intermediateBuffer->BarrierLayout(cmd, GfxEnumKernelType::OUT_OF_KERNEL, GfxEnumResourceUsage::TRANS_SRC);
-            vkCmdCopyBufferToImage(cmd, imm_buffer, _image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &buffer_copyto_image);
+            vkCmdCopyBufferToImage(cmd, imm_buffer, _image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, regions.size(), regions.data());
       };
 
       if (!_bNeedUpdate) {
@@ -203,7 +286,7 @@ void Texture::BarrierLayout(VkCommandBuffer cmd, GfxEnumKernelType new_kernel_ty
       barrier.subresourceRange = {
             .aspectMask = _viewCIs.at(0).subresourceRange.aspectMask,
             .baseMipLevel = 0,
-            .levelCount = 1,
+            .levelCount = _imageCI->mipLevels,
             .baseArrayLayer = 0,
             .layerCount = 1
       };
@@ -447,7 +530,7 @@ void Texture::SetBindlessIndex(std::optional<uint32_t> index) {
 }
 
 void Texture::DestroyTexture() {
-      if(_isBorrow) return;
+      if(_isBorrow || !IsResident()) return;
       ContextResourceRecoveryInfo info{
             .Type = ContextResourceType::IMAGE,
             .Resource1 = (size_t)_image,
@@ -461,6 +544,47 @@ void Texture::DestroyTexture() {
 void Texture::Update(VkCommandBuffer cmd) {
       if (_updateCommand) {
             _updateCommand(cmd);
-            _bNeedUpdate = false;
+            _updateCommand = {};
       }
+
+      if (!_regionCopies.empty()) {
+            auto& staging = _regionStaging[GfxContext::Get()->GetCurrentFrameIndex()];
+            bool staging_ready = true;
+            if (staging == nullptr) {
+                  staging = std::make_unique<Buffer>();
+                  std::string buffer_name = std::format("Texture[{}]Region Upload Buffer", _resourceName);
+                  staging_ready = staging->Init(buffer_name.c_str(), VkBufferCreateInfo{
+                        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+                        .pNext = nullptr,
+                        .flags = 0,
+                        .size = _regionData.size(),
+                        .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+                        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+                        .queueFamilyIndexCount = 0,
+                        .pQueueFamilyIndices = nullptr
+                  }, VmaAllocationCreateInfo{
+                        .usage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST,
+                        .requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+                  });
+                  if (!staging_ready) staging.reset();
+            } else if (staging->GetCapacity() < _regionData.size()) {
+                  // the slot was sized by an earlier, smaller batch
+                  staging_ready = staging->Recreate(_regionData.size());
+            }
+
+            if (!staging_ready) {
+                  auto err = std::format("[Texture::Update] Failed to prepare the region upload buffer ({} bytes), {} region updates dropped.", _regionData.size(), _regionCopies.size());
+                  if (!_resourceName.empty()) err += std::format(" - Name: \"{}\"", _resourceName);
+                  MessageManager::Log(MessageType::Error, err);
+            } else if (staging->SetData(_regionData.data(), _regionData.size())) {
+                  staging->Flush(0, _regionData.size());
+                  this->BarrierLayout(cmd, GfxEnumKernelType::OUT_OF_KERNEL, GfxEnumResourceUsage::TRANS_DST);
+                  staging->BarrierLayout(cmd, GfxEnumKernelType::OUT_OF_KERNEL, GfxEnumResourceUsage::TRANS_SRC);
+                  vkCmdCopyBufferToImage(cmd, staging->GetBuffer(), _image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, _regionCopies.size(), _regionCopies.data());
+            }
+            _regionData.clear();
+            _regionCopies.clear();
+      }
+
+      _bNeedUpdate = false;
 }
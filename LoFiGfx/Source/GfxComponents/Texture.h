@@ -40,12 +40,27 @@ namespace LoFi::Component::Gfx {
 
             [[nodiscard]] bool IsBorrowed() const { return _isBorrow; }
 
+            [[nodiscard]] bool IsResident() const { return _image != VK_NULL_HANDLE; }
+
+            // async file load gave up, the texture stays on the placeholder
+            [[nodiscard]] bool IsLoadFailed() const { return _loadFailed; }
+
+            void SetLoadFailed() { _loadFailed = true; }
+
             [[nodiscard]] ResourceHandle GetHandle() const { return {GfxEnumResourceType::Texture2D, _id}; }
 
             [[nodiscard]] VkExtent3D GetExtent() const { return _imageCI->extent; }
 
             [[nodiscard]] VkFormat GetFormat() const { return _imageCI->format; }
 
+            [[nodiscard]] VkSampleCountFlagBits GetSampleCount() const { return _imageCI->samples; }
+
+            [[nodiscard]] uint32_t GetMipLevels() const { return _imageCI->mipLevels; }
+
+            [[nodiscard]] VkImageUsageFlags GetUsage() const { return _imageCI->usage; }
+
+            [[nodiscard]] bool IsTextureFormatCompressed() const { return Internal::IsCompressedFormat(_imageCI->format); }
+
             [[nodiscard]] bool IsTextureFormatColor() const { return !Internal::IsDepthStencilFormat(_imageCI->format); }
 
             [[nodiscard]] bool IsTextureFormatDepthOnly() const { return Internal::IsDepthOnlyFormat(_imageCI->format); }
@@ -64,6 +79,9 @@ namespace LoFi::Component::Gfx {
 
             [[nodiscard]] const VkImageViewCreateInfo& GetViewCI(uint32_t idx) const { return _viewCIs.at(idx); }
 
+            // view covering the whole mip chain, view 0 only spans the base level for attachments and storage
+            [[nodiscard]] uint32_t GetSampledViewIndex() const { return _sampledViewIndex; }
+
             VkImageView CreateView(VkImageViewCreateInfo view_ci);
 
             void ClearViews();
@@ -72,6 +90,11 @@ namespace LoFi::Component::Gfx {
 
             void SetData(const void* data, size_t size);
 
+            void SetDataFromIntermediate(std::unique_ptr<Buffer> intermediate_buffer, size_t size);
+
+            // tightly packed texels of the first level, copies queued in the same frame are recorded together
+            bool SetRegionData(uint32_t x, uint32_t y, uint32_t w, uint32_t h, const void* data, size_t size);
+
             void BarrierLayout(VkCommandBuffer cmd, GfxEnumKernelType new_kernel_type, GfxEnumResourceUsage new_usage);
 
             void SetLayout(GfxEnumKernelType new_kernel_type, GfxEnumResourceUsage new_usage);
@@ -90,6 +113,8 @@ namespace LoFi::Component::Gfx {
 
             void Update(VkCommandBuffer cmd);
 
+            void RecordUpload(size_t size);
+
             friend class Swapchain;
 
             friend class ::LoFi::GfxContext;
@@ -99,6 +124,8 @@ namespace LoFi::Component::Gfx {
 
             bool _isBorrow{};
 
+            bool _loadFailed{};
+
             std::optional<uint32_t> _bindlessIndex{};
 
             VkImage _image{};
@@ -113,6 +140,8 @@ namespace LoFi::Component::Gfx {
 
             std::vector<VkImageViewCreateInfo> _viewCIs{};
 
+            uint32_t _sampledViewIndex{};
+
             VkSampler _sampler{};
 
             GfxEnumKernelType _currentKernelType = GfxEnumKernelType::OUT_OF_KERNEL;
@@ -125,6 +154,13 @@ namespace LoFi::Component::Gfx {
 
             std::function<void(VkCommandBuffer)> _updateCommand{};
 
+            std::vector<uint8_t> _regionData{};
+
+            std::vector<VkBufferImageCopy> _regionCopies{};
+
+            // one per frame slot, a slot has retired by the time its frame records the copies again
+            std::unique_ptr<Buffer> _regionStaging[3]{};
+
       private:
             std::string _resourceName{};
 
@@ -4,6 +4,10 @@
 #include "Message.h"
 #include "PhysicalDevice.h"
 #include "FrameGraph.h"
+#include "TextureLoader.h"
+#include "AssetPack.h"
+#include "FrameLinearAllocator.h"
+#include "GpuPrimitives.h"
 
 #include "GfxComponents/Swapchain.h"
 #include "GfxComponents/Buffer.h"
@@ -12,6 +16,10 @@
 #include "GfxComponents/Kernel.h"
 #include "GfxComponents/Buffer3F.h"
 
+#include "taskflow/taskflow.hpp"
+
+#include <bit>
+#include <numeric>
 #include <fstream>
 #include <sstream>
 
@@ -31,9 +39,6 @@ GfxContext::GfxContext() {
       dst_stage_wait_for.reserve(32);
       swap_chains.reserve(32);
       present_image_index.reserve(32);
-      _resoureceRecoveryList[0].reserve(512);
-      _resoureceRecoveryList[1].reserve(512);
-      _resoureceRecoveryList[2].reserve(512);
 }
 
 GfxContext::~GfxContext() {
@@ -43,7 +48,7 @@ GfxContext::~GfxContext() {
       }
 }
 
-void GfxContext::Init() {
+void GfxContext::Init(const GfxParamInit& param) {
       volkInitialize();
 
       std::vector<const char*> instance_layers{};
@@ -205,14 +210,15 @@ void GfxContext::Init() {
             //       .meshShaderQueries = false
             // };
 
-            VkPhysicalDeviceBufferDeviceAddressFeatures buffer_device_address_features{};
-            buffer_device_address_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES;
-            buffer_device_address_features.pNext = nullptr;
-            buffer_device_address_features.bufferDeviceAddress = true;
+            // optional shader features, requested only when the device supports them
+            const auto& supported = _physicalDeviceAbility;
+            const bool enable_16bit = param.bShader16Bit;
+            const bool enable_8bit = param.bShader8Bit;
+            const bool enable_64bit = param.bShader64Bit;
 
             VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2_features{
                   .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR,
-                  .pNext = &buffer_device_address_features,
+                  .pNext = nullptr,
                   .synchronization2 = true,
             };
 
@@ -225,9 +231,9 @@ void GfxContext::Init() {
             VkPhysicalDeviceVulkan11Features vulkan11_features = {
                   .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES,
                   .pNext = &dynamic_rendering_features,
-                  .storageBuffer16BitAccess = false,
-                  .uniformAndStorageBuffer16BitAccess = false,
-                  .storagePushConstant16 = false,
+                  .storageBuffer16BitAccess = enable_16bit && supported._vulkan11Features.storageBuffer16BitAccess,
+                  .uniformAndStorageBuffer16BitAccess = enable_16bit && supported._vulkan11Features.uniformAndStorageBuffer16BitAccess,
+                  .storagePushConstant16 = enable_16bit && supported._vulkan11Features.storagePushConstant16,
                   .storageInputOutput16 = false,
                   .multiview = false,
                   .multiviewGeometryShader = false,
@@ -239,9 +245,18 @@ void GfxContext::Init() {
                   .shaderDrawParameters = true
             };
 
-            VkPhysicalDeviceDescriptorIndexingFeatures descriptor_indexing_features = {
-                  .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES,
+            // the 1.2 core features, the spec doesn't allow chaining their per-extension structs next to this one
+            VkPhysicalDeviceVulkan12Features vulkan12_features = {
+                  .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
                   .pNext = &vulkan11_features,
+                  .drawIndirectCount = param.bDrawIndirectCount && supported._vulkan12Features.drawIndirectCount,
+                  .storageBuffer8BitAccess = enable_8bit && supported._storage8BitFeatures.storageBuffer8BitAccess,
+                  .uniformAndStorageBuffer8BitAccess = enable_8bit && supported._storage8BitFeatures.uniformAndStorageBuffer8BitAccess,
+                  .storagePushConstant8 = enable_8bit && supported._storage8BitFeatures.storagePushConstant8,
+                  .shaderBufferInt64Atomics = enable_64bit && supported._shaderAtomicInt64Features.shaderBufferInt64Atomics,
+                  .shaderSharedInt64Atomics = enable_64bit && supported._shaderAtomicInt64Features.shaderSharedInt64Atomics,
+                  .shaderFloat16 = enable_16bit && supported._shaderFloat16Int8Features.shaderFloat16,
+                  .shaderInt8 = enable_8bit && supported._shaderFloat16Int8Features.shaderInt8,
                   .shaderInputAttachmentArrayDynamicIndexing = true,
                   .shaderUniformTexelBufferArrayDynamicIndexing = true,
                   .shaderStorageTexelBufferArrayDynamicIndexing = true,
@@ -261,12 +276,15 @@ void GfxContext::Init() {
                   .descriptorBindingUpdateUnusedWhilePending = true,
                   .descriptorBindingPartiallyBound = true,
                   .descriptorBindingVariableDescriptorCount = true,
-                  .runtimeDescriptorArray = true
+                  .runtimeDescriptorArray = true,
+                  .shaderSubgroupExtendedTypes = param.bSubgroupExtendedTypes && supported._subgroupExtendedTypesFeatures.shaderSubgroupExtendedTypes,
+                  .timelineSemaphore = true,
+                  .bufferDeviceAddress = true,
             };
 
             VkPhysicalDeviceFeatures2 features2{
                   .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
-                  .pNext = &descriptor_indexing_features,
+                  .pNext = &vulkan12_features,
                   .features = {
                         .robustBufferAccess = false,
                         .fullDrawIndexUint32 = false,
@@ -288,11 +306,11 @@ void GfxContext::Init() {
                         .alphaToOne = false,
                         .multiViewport = false,
                         .samplerAnisotropy = true,
-                        .textureCompressionETC2 = false,
-                        .textureCompressionASTC_LDR = false,
-                        .textureCompressionBC = false,
-                        .occlusionQueryPrecise = false,
-                        .pipelineStatisticsQuery = false,
+                        .textureCompressionETC2 = _physicalDeviceAbility._features2.features.textureCompressionETC2,
+                        .textureCompressionASTC_LDR = _physicalDeviceAbility._features2.features.textureCompressionASTC_LDR,
+                        .textureCompressionBC = _physicalDeviceAbility._features2.features.textureCompressionBC,
+                        .occlusionQueryPrecise = supported._features2.features.occlusionQueryPrecise,
+                        .pipelineStatisticsQuery = supported._features2.features.pipelineStatisticsQuery,
                         .vertexPipelineStoresAndAtomics = false,
                         .fragmentStoresAndAtomics = false,
                         .shaderTessellationAndGeometryPointSize = false,
@@ -307,9 +325,9 @@ void GfxContext::Init() {
                         .shaderStorageImageArrayDynamicIndexing = false,
                         .shaderClipDistance = false,
                         .shaderCullDistance = false,
-                        .shaderFloat64 = false,
-                        .shaderInt64 = false,
-                        .shaderInt16 = false,
+                        .shaderFloat64 = enable_64bit && supported._features2.features.shaderFloat64,
+                        .shaderInt64 = enable_64bit && supported._features2.features.shaderInt64,
+                        .shaderInt16 = enable_16bit && supported._features2.features.shaderInt16,
                         .shaderResourceResidency = false,
                         .shaderResourceMinLod = false,
                         .sparseBinding = false,
@@ -340,6 +358,48 @@ void GfxContext::Init() {
                   throw std::runtime_error("Failed to create Vulkan device");
             }
 
+            const auto& subgroup = supported._vulkan11Properties;
+            const auto HasSubgroupOp = [&](VkSubgroupFeatureFlags op) { return (subgroup.subgroupSupportedOperations & op) != 0; };
+            _deviceFeatures = GfxInfoDeviceFeatures{
+                  .pDeviceName = supported._properties2.properties.deviceName,
+                  .SubgroupSize = subgroup.subgroupSize,
+                  .MinSubgroupSize = supported._subgroupSizeControlProperties.minSubgroupSize,
+                  .MaxSubgroupSize = supported._subgroupSizeControlProperties.maxSubgroupSize,
+                  .bSubgroupInVertex = (subgroup.subgroupSupportedStages & VK_SHADER_STAGE_VERTEX_BIT) != 0,
+                  .bSubgroupInFragment = (subgroup.subgroupSupportedStages & VK_SHADER_STAGE_FRAGMENT_BIT) != 0,
+                  .bSubgroupInCompute = (subgroup.subgroupSupportedStages & VK_SHADER_STAGE_COMPUTE_BIT) != 0,
+                  .bSubgroupBasic = HasSubgroupOp(VK_SUBGROUP_FEATURE_BASIC_BIT),
+                  .bSubgroupVote = HasSubgroupOp(VK_SUBGROUP_FEATURE_VOTE_BIT),
+                  .bSubgroupArithmetic = HasSubgroupOp(VK_SUBGROUP_FEATURE_ARITHMETIC_BIT),
+                  .bSubgroupBallot = HasSubgroupOp(VK_SUBGROUP_FEATURE_BALLOT_BIT),
+                  .bSubgroupShuffle = HasSubgroupOp(VK_SUBGROUP_FEATURE_SHUFFLE_BIT),
+                  .bSubgroupShuffleRelative = HasSubgroupOp(VK_SUBGROUP_FEATURE_SHUFFLE_RELATIVE_BIT),
+                  .bSubgroupClustered = HasSubgroupOp(VK_SUBGROUP_FEATURE_CLUSTERED_BIT),
+                  .bSubgroupQuad = HasSubgroupOp(VK_SUBGROUP_FEATURE_QUAD_BIT),
+                  .bSubgroupExtendedTypes = (bool)vulkan12_features.shaderSubgroupExtendedTypes,
+                  .bShaderFloat16 = (bool)vulkan12_features.shaderFloat16,
+                  .bShaderInt8 = (bool)vulkan12_features.shaderInt8,
+                  .bShaderInt16 = (bool)features2.features.shaderInt16,
+                  .bShaderInt64 = (bool)features2.features.shaderInt64,
+                  .bShaderFloat64 = (bool)features2.features.shaderFloat64,
+                  .bShaderBufferInt64Atomics = (bool)vulkan12_features.shaderBufferInt64Atomics,
+                  .bShaderSharedInt64Atomics = (bool)vulkan12_features.shaderSharedInt64Atomics,
+                  .bStorageBuffer16BitAccess = (bool)vulkan11_features.storageBuffer16BitAccess,
+                  .bUniformAndStorageBuffer16BitAccess = (bool)vulkan11_features.uniformAndStorageBuffer16BitAccess,
+                  .bStoragePushConstant16 = (bool)vulkan11_features.storagePushConstant16,
+                  .bStorageBuffer8BitAccess = (bool)vulkan12_features.storageBuffer8BitAccess,
+                  .bUniformAndStorageBuffer8BitAccess = (bool)vulkan12_features.uniformAndStorageBuffer8BitAccess,
+                  .bStoragePushConstant8 = (bool)vulkan12_features.storagePushConstant8,
+                  .bPipelineStatisticsQuery = (bool)features2.features.pipelineStatisticsQuery,
+                  .bOcclusionQueryPrecise = (bool)features2.features.occlusionQueryPrecise,
+                  .bDrawIndirectCount = (bool)vulkan12_features.drawIndirectCount,
+            };
+
+            const auto features_message = std::format("Shader features: subgroup size {} ({}-{}), fp16 {}, int8 {}, int16 {}, int64 {}, fp64 {}, 16-bit storage {}, 8-bit storage {}",
+                  _deviceFeatures.SubgroupSize, _deviceFeatures.MinSubgroupSize, _deviceFeatures.MaxSubgroupSize, _deviceFeatures.bShaderFloat16, _deviceFeatures.bShaderInt8,
+                  _deviceFeatures.bShaderInt16, _deviceFeatures.bShaderInt64, _deviceFeatures.bShaderFloat64, _deviceFeatures.bStorageBuffer16BitAccess, _deviceFeatures.bStorageBuffer8BitAccess);
+            MessageManager::Log(MessageType::Normal, features_message);
+
             _device = device;
             volkLoadDevice(device);
             volkLoadPhysicalDevice(_physicalDevice);
@@ -416,20 +476,25 @@ void GfxContext::Init() {
       }
 
       {
-            VkFenceCreateInfo fence_ci{};
-            fence_ci.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-            fence_ci.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+            VkSemaphoreTypeCreateInfo timeline_ci{};
+            timeline_ci.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+            timeline_ci.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+            timeline_ci.initialValue = 0;
+
+            VkSemaphoreCreateInfo timeline_semaphore_ci{};
+            timeline_semaphore_ci.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+            timeline_semaphore_ci.pNext = &timeline_ci;
+
+            if (vkCreateSemaphore(_device, &timeline_semaphore_ci, nullptr, &_frameTimeline) != VK_SUCCESS) {
+                  const auto err = "Context::Init Failed to create frame timeline semaphore";
+                  MessageManager::Log(MessageType::Error, err);
+                  throw std::runtime_error(err);
+            }
 
             VkSemaphoreCreateInfo semaphore_ci{};
             semaphore_ci.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
             for (int i = 0; i < 3; i++) {
-                  if (vkCreateFence(_device, &fence_ci, nullptr, &_mainCommandFence[i]) != VK_SUCCESS) {
-                        const auto err = "Context::Init Failed to create fence";
-                        MessageManager::Log(MessageType::Error, err);
-                        throw std::runtime_error(err);
-                  }
-
                   if (vkCreateSemaphore(_device, &semaphore_ci, nullptr, &_mainCommandQueueSemaphore[i]) != VK_SUCCESS) {
                         const auto err = "Context::Init Failed to create semaphore";
                         MessageManager::Log(MessageType::Error, err);
@@ -548,17 +613,55 @@ void GfxContext::Init() {
       }
 
 
+      {
+            _frameConstantAllocator = std::make_unique<Internal::FrameLinearAllocator>();
+            _frameConstantAllocator->Init("Frame Constant Allocator", VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
+            _gpuPrimitives = std::make_unique<GpuPrimitives>(this);
+      }
+
+      {
+            _taskExecutor = std::make_unique<tf::Executor>();
+
+            //Placeholder for textures still loading
+            constexpr uint32_t placeholder_pixel = 0xFF808080;
+            _placeholderTexture = CreateTexture2D(VK_FORMAT_R8G8B8A8_UNORM, 1, 1, {
+                  .pResourceName = "Placeholder Texture",
+                  .pData = &placeholder_pixel,
+                  .DataSize = sizeof(placeholder_pixel)
+            });
+      }
+
       MessageManager::Log(MessageType::Normal, "Successfully initialized LoFi context");
 }
 
 void GfxContext::Shutdown() {
+      if (_taskExecutor) {
+            _taskExecutor->wait_for_all();
+            AsyncTextureLoadResult result{};
+            while (_queueTextureLoaded.try_dequeue(result)) {}
+            _taskExecutor.reset();
+      }
+
       vkDeviceWaitIdle(_device);
 
+      ReadbackRequest readback{};
+      while (_queueReadbackRequest.try_dequeue(readback)) {}
+      _readbackInFlight.clear();
+      _readbackTickets.clear();
+      _readbackRing.reset();
+      _frameConstantAllocator.reset();
+      _gpuPrimitives.reset();
+
       for(auto i : _2DCanvas) {
-            delete (Gfx2DCanvas*)i;
+            delete i;
       }
       _2DCanvas.clear();
 
+      for(auto i : _assetPacks) {
+            delete i;
+      }
+      _assetPacks.clear();
+
       vkDestroyCommandPool(_device, _commandPool, nullptr);
       _frameGraph.reset();
 
@@ -599,8 +702,8 @@ void GfxContext::Shutdown() {
 
       RecoveryAllContextResourceImmediately();
 
+      vkDestroySemaphore(_device, _frameTimeline, nullptr);
       for (int i = 0; i < 3; i++) {
-            vkDestroyFence(_device, _mainCommandFence[i], nullptr);
             vkDestroySemaphore(_device, _mainCommandQueueSemaphore[i], nullptr);
       }
 
@@ -667,6 +770,46 @@ ResourceHandle GfxContext::CreateTexture2D(VkFormat format, uint32_t w, uint32_t
             ptr = &p;
       }
 
+      try {
+            if(!InitTexture2D(ptr, format, w, h, param)) {
+                  std::unique_lock lock(_worldRWMutex);
+                  _world.destroy(id);
+                  return {GfxEnumResourceType::INVALID_RESOURCE_TYPE, entt::null };
+            }
+            if(param.DataSize != 0 && param.pData != nullptr) {
+                  ptr->SetData(param.pData, param.DataSize);
+            }
+            return {GfxEnumResourceType::Texture2D, id };
+      } catch (std::exception&) {
+            std::unique_lock lock(_worldRWMutex);
+            _world.destroy(id);
+            MessageManager::Log(MessageType::Error, "[GfxContext::CreateTexture2D] Failed.");
+            return {GfxEnumResourceType::INVALID_RESOURCE_TYPE, entt::null };
+      }
+}
+
+bool GfxContext::InitTexture2D(Component::Gfx::Texture* ptr, VkFormat format, uint32_t w, uint32_t h, const GfxParamCreateTexture2D& param) {
+      const char* resource_name = param.pResourceName;
+
+      const auto is_compressed = IsCompressedFormat(format);
+      if (is_compressed) {
+            VkFormatProperties format_properties{};
+            vkGetPhysicalDeviceFormatProperties(_physicalDevice, format, &format_properties);
+            if (!(format_properties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT)) {
+                  auto err = std::format("[Context::CreateTexture2D] Compressed format {} is not supported by this device, create texture failed, return null.", ToStringVkFormat(format));
+                  if(resource_name) err += std::format(" - \"{}\"", resource_name);
+                  MessageManager::Log(MessageType::Error, err);
+                  return false;
+            }
+      }
+
+      const uint32_t max_mip_count = std::bit_width(std::max(w, h));
+      if (param.MipMapCount == 0 || param.MipMapCount > max_mip_count) {
+            auto err = std::format("[Context::CreateTexture2D] Invalid mipmap count {}, {}x{} texture allows 1 to {}, create texture failed, return null.", param.MipMapCount, w, h, max_mip_count);
+            if(resource_name) err += std::format(" - \"{}\"", resource_name);
+            MessageManager::Log(MessageType::Error, err);
+            return false;
+      }
 
       auto is_depth_stencil = IsDepthStencilFormat(format);
       VkImageCreateInfo image_ci{};
@@ -684,6 +827,8 @@ ResourceHandle GfxContext::CreateTexture2D(VkFormat format, uint32_t w, uint32_t
 
       if (is_depth_stencil) {
             image_ci.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+      } else if (is_compressed) {
+            image_ci.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
       } else {
             image_ci.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
       }
@@ -699,44 +844,143 @@ ResourceHandle GfxContext::CreateTexture2D(VkFormat format, uint32_t w, uint32_t
       VmaAllocationCreateInfo alloc_ci{};
       alloc_ci.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
 
-      try {
-            if(!ptr->Init(image_ci, alloc_ci, param)) {
-                  std::unique_lock lock(_worldRWMutex);
-                  _world.destroy(id);
-                  return {GfxEnumResourceType::Texture2D, id };
-            } else {
+      if(!ptr->Init(image_ci, alloc_ci, param)) {
+            return false;
+      }
 
-                  VkImageViewCreateInfo view_ci{};
-                  view_ci.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-                  view_ci.viewType = VK_IMAGE_VIEW_TYPE_2D;
-                  view_ci.format = format;
-                  view_ci.components.r = VK_COMPONENT_SWIZZLE_R;
-                  view_ci.components.g = VK_COMPONENT_SWIZZLE_G;
-                  view_ci.components.b = VK_COMPONENT_SWIZZLE_B;
-                  view_ci.components.a = VK_COMPONENT_SWIZZLE_A;
-                  view_ci.subresourceRange.aspectMask = as_flag;
-                  view_ci.subresourceRange.baseMipLevel = 0;
-                  view_ci.subresourceRange.levelCount = 1;
-                  view_ci.subresourceRange.baseArrayLayer = 0;
-                  view_ci.subresourceRange.layerCount = 1;
-
-                  ptr->CreateView(view_ci);
-                  if (param.MipMapCount != 1) {
-                        //TODO
+      VkImageViewCreateInfo view_ci{};
+      view_ci.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+      view_ci.viewType = VK_IMAGE_VIEW_TYPE_2D;
+      view_ci.format = format;
+      view_ci.components.r = VK_COMPONENT_SWIZZLE_R;
+      view_ci.components.g = VK_COMPONENT_SWIZZLE_G;
+      view_ci.components.b = VK_COMPONENT_SWIZZLE_B;
+      view_ci.components.a = VK_COMPONENT_SWIZZLE_A;
+      view_ci.subresourceRange.aspectMask = as_flag;
+      view_ci.subresourceRange.baseMipLevel = 0;
+      view_ci.subresourceRange.levelCount = 1;
+      view_ci.subresourceRange.baseArrayLayer = 0;
+      view_ci.subresourceRange.layerCount = 1;
+
+      ptr->CreateView(view_ci);
+
+      //attachments and storage stay on the base level, sampling sees the whole chain
+      if (param.MipMapCount > 1) {
+            view_ci.subresourceRange.levelCount = param.MipMapCount;
+            ptr->CreateView(view_ci);
+            ptr->_sampledViewIndex = 1;
+      }
+      if(!is_depth_stencil) {
+            MakeBindlessIndexTexture(ptr);
+      }
+      return true;
+}
+
+ResourceHandle GfxContext::CreateTexture2DFromFileAsync(const char* file_path, const GfxParamCreateTexture2D& param) {
+      if (!file_path) {
+            MessageManager::Log(MessageType::Error, "[Context::CreateTexture2DFromFileAsync] File path is null, return null.");
+            return {GfxEnumResourceType::INVALID_RESOURCE_TYPE, entt::null};
+      }
+
+      entt::entity id = entt::null;
+      {
+            std::unique_lock lock(_worldRWMutex);
+            id = _world.create();
+            if(param.pResourceName) {
+                  _world.emplace<Component::Gfx::ComponentResourceName>(id, std::string(param.pResourceName));
+            }
+            _world.emplace<Component::Gfx::Texture>(id, id);
+      }
+
+      const ResourceHandle handle{GfxEnumResourceType::Texture2D, id};
+      std::string path = file_path;
+      std::string name = param.pResourceName ? param.pResourceName : path;
+
+      // decode on worker, the image itself is created on the frame thread when the result is staged
+      _taskExecutor->silent_async([this, handle, path = std::move(path), name = std::move(name)]() {
+            AsyncTextureLoadResult result{.Texture = handle};
+
+            const auto make_intermediate = [&](size_t size) -> void* {
+                  auto buffer = std::make_unique<Component::Gfx::Buffer>();
+                  const std::string buffer_name = std::format("Texture[{}]Upload Intermediate Buffer", name);
+                  if (!buffer->Init(buffer_name.c_str(), VkBufferCreateInfo{
+                        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+                        .size = size,
+                        .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+                        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+                  }, VmaAllocationCreateInfo{
+                        .usage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST,
+                        .requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+                  })) {
+                        return nullptr;
                   }
-                  if(!is_depth_stencil) {
-                        MakeBindlessIndexTexture(ptr);
+                  result.Intermediate = std::move(buffer);
+                  result.DataSize = size;
+                  return result.Intermediate->Map();
+            };
+
+            if (TextureLoader::IsContainerFile(path)) {
+                  // levels go from the file buffer straight into the mapped intermediate
+                  TextureFileData file{};
+                  if (TextureLoader::Load(path.c_str(), file, make_intermediate)) {
+                        result.Format = file.Format;
+                        result.Width = file.Width;
+                        result.Height = file.Height;
+                        result.MipLevels = file.MipLevels;
                   }
-                  if(param.DataSize != 0 && param.pData != nullptr) {
-                        ptr->SetData(param.pData, param.DataSize);
+            } else {
+                  int w, h, channels;
+                  if (unsigned char* data = stbi_load(path.c_str(), &w, &h, &channels, 4); data) {
+                        const size_t size = (size_t)w * h * 4;
+                        if (void* dst = make_intermediate(size); dst) {
+                              memcpy(dst, data, size);
+                              result.Format = VK_FORMAT_R8G8B8A8_UNORM;
+                              result.Width = w;
+                              result.Height = h;
+                        }
+                        stbi_image_free(data);
                   }
-                  return {GfxEnumResourceType::Texture2D, id };
             }
-      } catch (std::exception&) {
-            std::unique_lock lock(_worldRWMutex);
-            _world.destroy(id);
-            MessageManager::Log(MessageType::Error, "[GfxContext::CreateTexture2D] Failed.");
-            return {GfxEnumResourceType::INVALID_RESOURCE_TYPE, entt::null };
+
+            if (result.Format == VK_FORMAT_UNDEFINED) {
+                  const auto err = std::format("[Context::CreateTexture2DFromFileAsync] Load file \"{}\" failed, texture keeps the placeholder.", path);
+                  MessageManager::Log(MessageType::Error, err);
+                  result.Intermediate.reset();
+            }
+
+            _queueTextureLoaded.enqueue(std::move(result));
+      });
+
+      return handle;
+}
+
+void GfxContext::StageAsyncTextureLoad() {
+      AsyncTextureLoadResult result{};
+      while (_queueTextureLoaded.try_dequeue(result)) {
+            auto ptr = ResourceFetch<Component::Gfx::Texture>(result.Texture);
+            if (!ptr) continue; // destroyed before loading finished
+
+            if (!result.Intermediate) {
+                  ptr->SetLoadFailed();
+                  continue;
+            }
+
+            const auto name = ResourceFetch<Component::Gfx::ComponentResourceName>(result.Texture);
+            const GfxParamCreateTexture2D param {
+                  .pResourceName = name ? name->ResourceName.c_str() : nullptr,
+                  .MipMapCount = result.MipLevels
+            };
+
+            try {
+                  if (InitTexture2D(ptr, result.Format, result.Width, result.Height, param)) {
+                        ptr->SetDataFromIntermediate(std::move(result.Intermediate), result.DataSize);
+                  } else {
+                        ptr->SetLoadFailed();
+                  }
+            } catch (std::exception&) {
+                  MessageManager::Log(MessageType::Error, "[GfxContext::StageAsyncTextureLoad] Failed.");
+                  ptr->SetLoadFailed();
+            }
       }
 }
 
@@ -815,6 +1059,33 @@ ResourceHandle GfxContext::CreateBuffer3F(const GfxParamCreateBuffer3F& param) {
       }
 }
 
+GfxInfoConstantBuffer GfxContext::CreateConstantBuffer(const GfxParamCreateConstantBuffer& param) {
+      if (param.DataSize == 0) {
+            std::string err = "[GfxContext::CreateConstantBuffer] Invalid Size 0, Create Constant Buffer Failed.";
+            if(param.pResourceName) err += std::format(" - Name: \"{}\"", param.pResourceName);
+            MessageManager::Log(MessageType::Error, err);
+            return {};
+      }
+
+      const auto allocation = _frameConstantAllocator->Allocate(param.DataSize);
+      if (!allocation.has_value()) {
+            std::string err = std::format("[GfxContext::CreateConstantBuffer] Failed to allocate {} bytes.", param.DataSize);
+            if(param.pResourceName) err += std::format(" - Name: \"{}\"", param.pResourceName);
+            MessageManager::Log(MessageType::Error, err);
+            return {};
+      }
+
+      if (param.pData) {
+            memcpy(allocation->MappedAddress, param.pData, param.DataSize);
+      }
+
+      return {
+            .pMappedAddress = allocation->MappedAddress,
+            .BindlessAddress = allocation->Address,
+            .Size = allocation->Size
+      };
+}
+
 ResourceHandle GfxContext::CreateProgram(const GfxParamCreateProgram& param) {
 
       entt::entity id = entt::null;
@@ -833,7 +1104,7 @@ ResourceHandle GfxContext::CreateProgram(const GfxParamCreateProgram& param) {
             for(uint32_t i = 0; i < param.countSourceCode; i++) {
                   source_codes.emplace_back(param.pSourceCodes[i]);
             }
-            if(!ptr->Init(param.pResourceName, param.pConfig, source_codes)) {
+            if(!ptr->Init(param.pResourceName, param.pConfig, source_codes, param.Optimization)) {
                   std::unique_lock lock(_worldRWMutex);
                   _world.destroy(id);
                   return { GfxEnumResourceType::INVALID_RESOURCE_TYPE, entt::null };
@@ -876,7 +1147,8 @@ ResourceHandle GfxContext::CreateProgramFromFile(const GfxParamCreateProgramFrom
             .pResourceName = param.pResourceName,
             .pConfig = param.pConfig,
             .pSourceCodes = codes_view.data(),
-            .countSourceCode = codes_view.size()
+            .countSourceCode = codes_view.size(),
+            .Optimization = param.Optimization
       });
 }
 
@@ -946,24 +1218,117 @@ ResourceHandle GfxContext::CreateRenderNode(const GfxParamCreateRenderNode& para
             entt::entity id = entt::null;
             id = _world.create();
             RenderNode* ptr = &_world.emplace<RenderNode>(id, id, node_name);
+            ptr->EnableQueries(param.bPipelineStatistics, param.bOcclusionQuery);
             _frameGraph->AddNode(ptr);
             return {GfxEnumResourceType::RenderGraphNode, id};
       }
 }
 
+// canvas handles are recorders, the canvas' own one or a sub canvas'
 Gfx2DCanvas GfxContext::Create2DCanvas() {
       auto ptr = new PfxContext();
       _2DCanvas.insert(ptr);
-      return (Gfx2DCanvas)ptr;
+      return (Gfx2DCanvas)ptr->GetRecorder();
 }
 
 void GfxContext::Destroy2DCanvas(Gfx2DCanvas canvas) {
-      if(_2DCanvas.contains((PfxContext*)canvas)) {
-            _2DCanvas.erase((PfxContext*)canvas);
-            delete (PfxContext*)canvas;
+      const auto recorder = (PfxRecorder*)canvas;
+      const auto ptr = recorder->GetCanvas();
+      if(!_2DCanvas.contains(ptr)) return;
+
+      if(recorder == ptr->GetRecorder()) {
+            _2DCanvas.erase(ptr);
+            delete ptr;
+      } else {
+            ptr->DestroySubCanvas(recorder);
+      }
+}
+
+GfxAssetPack GfxContext::OpenAssetPack(const char* path) {
+      auto ptr = new Internal::AssetPack();
+      if(!ptr->Open(path)) {
+            delete ptr;
+            return 0;
+      }
+      _assetPacks.insert(ptr);
+      return (GfxAssetPack)ptr;
+}
+
+void GfxContext::CloseAssetPack(GfxAssetPack pack) {
+      if(_assetPacks.contains((Internal::AssetPack*)pack)) {
+            _assetPacks.erase((Internal::AssetPack*)pack);
+            delete (Internal::AssetPack*)pack;
+      }
+}
+
+ResourceHandle GfxContext::CreateTexture2DFromPack(GfxAssetPack pack, const char* entry_name, const GfxParamCreateTexture2D& param) {
+      const auto ptr = (Internal::AssetPack*)pack;
+      const Internal::AssetPackEntry* entry = _assetPacks.contains(ptr) ? ptr->Find(entry_name, Internal::AssetPackEntryType::TEXTURE) : nullptr;
+      if(!entry) {
+            auto err = std::format("[GfxContext::CreateTexture2DFromPack] Texture \"{}\" not found in asset pack.", entry_name);
+            if(param.pResourceName) err += std::format(" - Name: \"{}\"", param.pResourceName);
+            MessageManager::Log(MessageType::Error, err);
+            return {GfxEnumResourceType::INVALID_RESOURCE_TYPE, entt::null};
+      }
+
+      // staged straight from the mapped view, no intermediate decode
+      return CreateTexture2D((VkFormat)entry->Format, entry->Width, entry->Height, {
+            .pResourceName = param.pResourceName,
+            .pData = ptr->GetData(entry),
+            .DataSize = entry->Size,
+            .MipMapCount = entry->MipLevels
+      });
+}
+
+ResourceHandle GfxContext::CreateProgramFromPack(GfxAssetPack pack, const char* entry_name, const char* resource_name) {
+      const auto pack_ptr = (Internal::AssetPack*)pack;
+      const Internal::AssetPackEntry* entry = _assetPacks.contains(pack_ptr) ? pack_ptr->Find(entry_name, Internal::AssetPackEntryType::PROGRAM) : nullptr;
+      if(!entry) {
+            auto err = std::format("[GfxContext::CreateProgramFromPack] Program \"{}\" not found in asset pack.", entry_name);
+            if(resource_name) err += std::format(" - Name: \"{}\"", resource_name);
+            MessageManager::Log(MessageType::Error, err);
+            return {GfxEnumResourceType::INVALID_RESOURCE_TYPE, entt::null};
+      }
+
+      entt::entity id = entt::null;
+      Component::Gfx::Program* ptr;
+
+      {
+            std::unique_lock lock(_worldRWMutex);
+            id = _world.create();
+            if(resource_name) {
+                  _world.emplace<Component::Gfx::ComponentResourceName>(id, std::string(resource_name));
+            }
+            ptr = &_world.emplace<Component::Gfx::Program>(id, id);
+      }
+      try {
+            if(!ptr->InitFromSpirv(resource_name, pack_ptr->GetProgramConfig(entry), pack_ptr->GetProgramSpirv(entry))) {
+                  std::unique_lock lock(_worldRWMutex);
+                  _world.destroy(id);
+                  return { GfxEnumResourceType::INVALID_RESOURCE_TYPE, entt::null };
+            }
+            return { GfxEnumResourceType::Program, id };
+      } catch (const std::exception&) {
+            std::unique_lock lock(_worldRWMutex);
+            _world.destroy(id);
+            MessageManager::Log(MessageType::Error, "[GfxContext::CreateProgramFromPack] Failed.");
+            return { GfxEnumResourceType::INVALID_RESOURCE_TYPE, entt::null };
       }
 }
 
+const void* GfxContext::GetAssetPackData(GfxAssetPack pack, const char* entry_name, size_t* size) const {
+      const auto ptr = (Internal::AssetPack*)pack;
+      const Internal::AssetPackEntry* entry = _assetPacks.contains(ptr) ? ptr->Find(entry_name, Internal::AssetPackEntryType::RAW) : nullptr;
+      if(!entry) {
+            const auto err = std::format("[GfxContext::GetAssetPackData] Entry \"{}\" not found in asset pack.", entry_name);
+            MessageManager::Log(MessageType::Error, err);
+            if(size) *size = 0;
+            return nullptr;
+      }
+      if(size) *size = entry->Size;
+      return ptr->GetData(entry);
+}
+
 void GfxContext::SetRootRenderNode(ResourceHandle node) const {
       return _frameGraph->SetRootNode(node);
 }
@@ -1002,6 +1367,84 @@ bool GfxContext::SetKernelConstant(ResourceHandle kernel, const std::string& nam
       return ptr->SetConstantValue(name, data);
 }
 
+GfxKernelConstantSlot GfxContext::GetKernelConstantSlot(ResourceHandle kernel, const std::string& name) {
+      if(kernel.Type != GfxEnumResourceType::Kernel) {
+            const auto err = std::format("[Context::GetKernelConstantSlot] Invalid Resource Type, Need a Kernel, but got {}.", ToStringResourceType(kernel.Type));
+            MessageManager::Log(MessageType::Warning, err);
+            return {};
+      }
+
+      const auto ptr = ResourceFetch<Component::Gfx::Kernel>(kernel);
+      if (!ptr) {
+            const std::string err = "[Context::GetKernelConstantSlot] Invalid Kernel Handle";
+            MessageManager::Log(MessageType::Warning, err);
+            return {};
+      }
+
+      const auto slot = ptr->GetConstantSlot(name);
+      if (slot.Size == 0) {
+            auto err = std::format("[Context::GetKernelConstantSlot] Push constant member \"{}\" not found.", name);
+            if(!ptr->GetResourceName().empty()) err += std::format(" - Name: \"{}\"", ptr->GetResourceName());
+            MessageManager::Log(MessageType::Warning, err);
+      }
+      return slot;
+}
+
+bool GfxContext::SetKernelConstant(ResourceHandle kernel, GfxKernelConstantSlot slot, const void* data) {
+      if(kernel.Type != GfxEnumResourceType::Kernel) {
+            const auto err = std::format("[Context::SetKernelConstant] Invalid Resource Type, Need a Kernel, but got {}.", ToStringResourceType(kernel.Type));
+            MessageManager::Log(MessageType::Warning, err);
+            return false;
+      }
+
+      const auto ptr = ResourceFetch<Component::Gfx::Kernel>(kernel);
+      if (!ptr) {
+            const std::string err = "[Context::SetKernelConstant] Invalid Kernel Handle";
+            MessageManager::Log(MessageType::Warning, err);
+            return false;
+      }
+
+      return ptr->SetConstantValue(slot, data);
+}
+
+bool GfxContext::SetKernelConstants(ResourceHandle kernel, std::span<const GfxInfoKernelConstant> constants) {
+      if(kernel.Type != GfxEnumResourceType::Kernel) {
+            const auto err = std::format("[Context::SetKernelConstants] Invalid Resource Type, Need a Kernel, but got {}.", ToStringResourceType(kernel.Type));
+            MessageManager::Log(MessageType::Warning, err);
+            return false;
+      }
+
+      const auto ptr = ResourceFetch<Component::Gfx::Kernel>(kernel);
+      if (!ptr) {
+            const std::string err = "[Context::SetKernelConstants] Invalid Kernel Handle";
+            MessageManager::Log(MessageType::Warning, err);
+            return false;
+      }
+
+      bool all_set = true;
+      for (const auto& constant : constants) {
+            all_set &= ptr->SetConstantValue(constant.Slot, constant.pData);
+      }
+      return all_set;
+}
+
+bool GfxContext::SetKernelSpecConstants(ResourceHandle kernel, std::span<const GfxInfoKernelSpecConstant> constants) {
+      if(kernel.Type != GfxEnumResourceType::Kernel) {
+            const auto err = std::format("[Context::SetKernelSpecConstants] Invalid Resource Type, Need a Kernel, but got {}.", ToStringResourceType(kernel.Type));
+            MessageManager::Log(MessageType::Warning, err);
+            return false;
+      }
+
+      const auto ptr = ResourceFetch<Component::Gfx::Kernel>(kernel);
+      if (!ptr) {
+            const std::string err = "[Context::SetKernelSpecConstants] Invalid Kernel Handle";
+            MessageManager::Log(MessageType::Warning, err);
+            return false;
+      }
+
+      return ptr->SetSpecConstants(constants);
+}
+
 bool GfxContext::FillKernelConstant(ResourceHandle kernel, const void* data, size_t size) {
       if(kernel.Type != GfxEnumResourceType::Kernel) {
             const auto err = std::format("[Context::FillKernelConstant] Invalid Resource Type, Need a Kernel, but got {}.", ToStringResourceType(kernel.Type));
@@ -1027,6 +1470,7 @@ void GfxContext::DestroyHandle(ResourceHandle handle) {
             std::unique_lock lock(_worldRWMutex);
             if (auto ptr = _world.try_get<RenderNode>(handle.RHandle); ptr != nullptr) {
                   _frameGraph->RemoveNode(ptr);
+                  if (_gpuPrimitives) _gpuPrimitives->ReleaseNode(handle.RHandle);
                   _world.destroy(handle.RHandle);
             }
       } else {
@@ -1103,6 +1547,11 @@ bool GfxContext::SetTexture2D(ResourceHandle texture, const void* data, uint64_t
                   MessageManager::Log(MessageType::Warning, err);
                   return false;
             }
+            if (!ptr->IsResident()) {
+                  std::string err = "[Context::UploadTexture2D] Texture is still loading, upload ignored.";
+                  MessageManager::Log(MessageType::Warning, err);
+                  return false;
+            }
             ptr->SetData(data, size);
             return true;
       } catch (...) {
@@ -1111,6 +1560,32 @@ bool GfxContext::SetTexture2D(ResourceHandle texture, const void* data, uint64_t
       }
 }
 
+bool GfxContext::SetTexture2DRegion(ResourceHandle texture, uint32_t x, uint32_t y, uint32_t w, uint32_t h, const void* data, uint64_t size) {
+      if(texture.Type != GfxEnumResourceType::Texture2D) {
+            const auto err = std::format("[Context::SetTexture2DRegion] Invalid Resource Type, Need a Texture2D, but got {}.", ToStringResourceType(texture.Type));
+            MessageManager::Log(MessageType::Warning, err);
+            return false;
+      }
+
+      try {
+            const auto ptr = ResourceFetch<Component::Gfx::Texture>(texture);
+            if (!ptr) {
+                  std::string err = "[Context::SetTexture2DRegion] Invalid Texture Handle";
+                  MessageManager::Log(MessageType::Warning, err);
+                  return false;
+            }
+            if (!ptr->IsResident()) {
+                  std::string err = "[Context::SetTexture2DRegion] Texture is still loading, upload ignored.";
+                  MessageManager::Log(MessageType::Warning, err);
+                  return false;
+            }
+            return ptr->SetRegionData(x, y, w, h, data, size);
+      } catch (...) {
+            MessageManager::Log(MessageType::Error, "[GfxContext::SetTexture2DRegion] Failed.");
+            return false;
+      }
+}
+
 bool GfxContext::ResizeTexture2D(ResourceHandle texture, uint32_t w, uint32_t h) {
       if(texture.Type != GfxEnumResourceType::Texture2D) {
             const auto err = std::format("[ResizeTexture2D::UploadTexture2D] Invalid Resource Type, Need a Texture2D, but got {}.", ToStringResourceType(texture.Type));
@@ -1275,14 +1750,6 @@ GfxInfoKernelLayout GfxContext::GetKernelLayout(ResourceHandle kernel) {
 // }
 
 void GfxContext::GenFrame() {
-      if(_first_call) {
-            auto fence = GetCurrentFence();
-            vkWaitForFences(_device, 1, &fence, true, UINT64_MAX);
-            vkResetFences(_device, 1, &fence);
-            _first_call = false;
-      }
-      //Wait pre 3 frame done
-      //WaitPreviewFramesDone();
       {
             std::shared_lock lock(_worldRWMutex);
 
@@ -1312,6 +1779,9 @@ void GfxContext::GenFrame() {
             //Gen Commands
             _frameGraph->GenFrameGraph(current_frame_index);
 
+            //Copy Readbacks
+            StageReadback();
+
             //Prepare To Present
             semaphores_wait_for.clear();
             dst_stage_wait_for.clear();
@@ -1344,29 +1814,48 @@ void GfxContext::GenFrame() {
             vk_submit_info.pWaitSemaphores = semaphores_wait_for.data();
             vk_submit_info.waitSemaphoreCount = semaphores_wait_for.size();
             vk_submit_info.pWaitDstStageMask = dst_stage_wait_for.data();
-            vk_submit_info.pSignalSemaphores = &_mainCommandQueueSemaphore[GetCurrentFrameIndex()];
-            vk_submit_info.signalSemaphoreCount = 1;
 
-            if (const auto res = vkQueueSubmit(_queue, 1, &vk_submit_info, GetCurrentFence()); res != VK_SUCCESS) {
+            //binary semaphore for present, timeline value for everything waiting on this frame
+            //headless frames (no swapchain) skip the present semaphore and present call
+            const bool present = !swap_chains.empty();
+            const uint32_t signal_first = present ? 0 : 1;
+            const uint64_t frame_value = _frameTimelineValue + 1;
+            VkSemaphore signal_semaphores[] = {_mainCommandQueueSemaphore[current_frame_index], _frameTimeline};
+            const uint64_t signal_values[] = {0, frame_value};
+            VkTimelineSemaphoreSubmitInfo timeline_submit_info{};
+            timeline_submit_info.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+            timeline_submit_info.signalSemaphoreValueCount = 2 - signal_first;
+            timeline_submit_info.pSignalSemaphoreValues = signal_values + signal_first;
+
+            vk_submit_info.pNext = &timeline_submit_info;
+            vk_submit_info.pSignalSemaphores = signal_semaphores + signal_first;
+            vk_submit_info.signalSemaphoreCount = 2 - signal_first;
+
+            if (const auto res = vkQueueSubmit(_queue, 1, &vk_submit_info, VK_NULL_HANDLE); res != VK_SUCCESS) {
                   const auto err = std::format("[GfxContext::GenFrame] vkQueueSubmit Failed. return {}, at frame {}.", ToStringVkResult(res), current_frame_index);
                   MessageManager::Log(MessageType::Error, err);
                   throw std::runtime_error(err);
             }
 
-            VkPresentInfoKHR present_info{};
-            present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-            present_info.waitSemaphoreCount = 1;
-            present_info.pWaitSemaphores = &_mainCommandQueueSemaphore[GetCurrentFrameIndex()];
-            present_info.pImageIndices = present_image_index.data();
-            present_info.pSwapchains = swap_chains.data();
-            present_info.swapchainCount = (uint32_t)swap_chains.size();
-
-            if (const auto res = vkQueuePresentKHR(_queue, &present_info); res == VK_ERROR_OUT_OF_DATE_KHR || res == VK_SUBOPTIMAL_KHR) {
-                  //NeedUpdate Ignore, it will be done in Acquire
-            } else if (res != VK_SUCCESS) {
-                  const auto err = std::format("[GfxContext::GenFrame] vkQueuePresentKHR Failed to present. return {}, at frame {}.", ToStringVkResult(res), current_frame_index);
-                  MessageManager::Log(MessageType::Error, err);
-                  throw std::runtime_error(err);
+            _frameTimelineValue = frame_value;
+            _frameSlotValue[current_frame_index] = frame_value;
+
+            if (present) {
+                  VkPresentInfoKHR present_info{};
+                  present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+                  present_info.waitSemaphoreCount = 1;
+                  present_info.pWaitSemaphores = &_mainCommandQueueSemaphore[GetCurrentFrameIndex()];
+                  present_info.pImageIndices = present_image_index.data();
+                  present_info.pSwapchains = swap_chains.data();
+                  present_info.swapchainCount = (uint32_t)swap_chains.size();
+
+                  if (const auto res = vkQueuePresentKHR(_queue, &present_info); res == VK_ERROR_OUT_OF_DATE_KHR || res == VK_SUBOPTIMAL_KHR) {
+                        //NeedUpdate Ignore, it will be done in Acquire
+                  } else if (res != VK_SUCCESS) {
+                        const auto err = std::format("[GfxContext::GenFrame] vkQueuePresentKHR Failed to present. return {}, at frame {}.", ToStringVkResult(res), current_frame_index);
+                        MessageManager::Log(MessageType::Error, err);
+                        throw std::runtime_error(err);
+                  }
             }
 
             //Recovery Resource
@@ -1374,18 +1863,19 @@ void GfxContext::GenFrame() {
             //Frame Done
             GoNextFrame();
 
-            auto fence = GetCurrentFence();
-            vkWaitForFences(_device, 1, &fence, true, UINT64_MAX);
+            //the slot's previous frame must retire before its command buffer is reused
+            WaitFrame(_frameSlotValue[GetCurrentFrameIndex()]);
+            _frameConstantAllocator->BeginFrame(GetCurrentFrameIndex());
             _frameGraph->PrepareNextFrame();
             //Prepare Next Frame's Swapchain
             _world.view<Component::Gfx::Swapchain>().each([&](auto entity, Component::Gfx::Swapchain& swapchain) {
                   swapchain.AcquireNextImage();
                   uint32_t curr = swapchain.GetCurrentSemaphoreIndex();
             });
-
-            vkResetFences(_device, 1, &fence);
-
       }
+
+      //Deliver readbacks of retired frames, outside the world lock so callbacks may create resources
+      CompleteReadback(GetCompletedFrameValue());
 }
 
 
@@ -1400,7 +1890,7 @@ uint32_t GfxContext::MakeBindlessIndexTexture(Component::Gfx::Texture* texture,
       //Sample
       VkDescriptorImageInfo image_info_sampler = {
             .sampler = sampler,
-            .imageView = texture->GetView(viewIndex),
+            .imageView = texture->GetView(viewIndex == 0 ? texture->GetSampledViewIndex() : viewIndex),
             .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
       };
 
@@ -1421,7 +1911,16 @@ uint32_t GfxContext::MakeBindlessIndexTexture(Component::Gfx::Texture* texture,
 
       vkUpdateDescriptorSets(_device, 1, &write_sampler, 0, nullptr);
 
-      //Storage:
+      texture->SetBindlessIndex(free_index);
+
+      //Storage: (compressed textures have no storage usage)
+      if (!(texture->GetUsage() & VK_IMAGE_USAGE_STORAGE_BIT)) {
+            auto str = std::format("[Context::MakeBindlessIndexTexture] Texture id: {}, index: {}, sampled only.", (uint32_t)texture->GetHandle().RHandle, free_index);
+            if(!texture->GetResourceName().empty()) str += std::format(" - Name: \"{}\"", texture->GetResourceName());
+            MessageManager::Log(MessageType::Normal, str);
+            return free_index;
+      }
+
       VkDescriptorImageInfo image_info_storage = {
             .sampler = sampler,
             .imageView = texture->GetView(viewIndex),
@@ -1443,7 +1942,6 @@ uint32_t GfxContext::MakeBindlessIndexTexture(Component::Gfx::Texture* texture,
 
       vkUpdateDescriptorSets(_device, 1, &write_compute, 0, nullptr);
 
-      texture->SetBindlessIndex(free_index);
       auto str = std::format("[Context::MakeBindlessIndexTexture] Texture id: {}, index: {}.", (uint32_t)texture->GetHandle().RHandle, free_index);
       if(!texture->GetResourceName().empty()) str += std::format(" - Name: \"{}\"", texture->GetResourceName());
       MessageManager::Log(MessageType::Normal, str);
@@ -1457,6 +1955,28 @@ void GfxContext::RemoveBindlessIndexTextureImmediately(Component::Gfx::Texture*
       }
 }
 
+bool GfxContext::IsTextureResident(ResourceHandle texture) {
+      if(texture.Type != GfxEnumResourceType::Texture2D) {
+            return texture.Type == GfxEnumResourceType::SwapChain;
+      }
+      const auto ptr = ResourceFetch<Component::Gfx::Texture>(texture);
+      return ptr && ptr->IsResident();
+}
+
+GfxEnumTextureLoadState GfxContext::GetTextureLoadState(ResourceHandle texture) {
+      if(texture.Type != GfxEnumResourceType::Texture2D) {
+            return texture.Type == GfxEnumResourceType::SwapChain ? GfxEnumTextureLoadState::READY : GfxEnumTextureLoadState::INVALID;
+      }
+      const auto ptr = ResourceFetch<Component::Gfx::Texture>(texture);
+      if (!ptr) return GfxEnumTextureLoadState::INVALID;
+      if (ptr->IsResident()) return GfxEnumTextureLoadState::READY;
+      return ptr->IsLoadFailed() ? GfxEnumTextureLoadState::FAILED : GfxEnumTextureLoadState::LOADING;
+}
+
+Component::Gfx::Texture* GfxContext::GetPlaceholderTexture() {
+      return ResourceFetch<Component::Gfx::Texture>(_placeholderTexture);
+}
+
 uint32_t GfxContext::GetTextureBindlessIndex(ResourceHandle texture) {
       if(texture.Type == GfxEnumResourceType::Texture2D) {
             const auto texture_component = ResourceFetch<Component::Gfx::Texture>(texture);
@@ -1466,6 +1986,10 @@ uint32_t GfxContext::GetTextureBindlessIndex(ResourceHandle texture) {
                   return 0;
             }
 
+            if(!texture_component->IsResident()) {
+                  return GetPlaceholderTexture()->GetBindlessIndex().value_or(0);
+            }
+
             if(texture_component->IsTextureFormatDepthStencilOnly()) {
                   std::string err = "[Context::GetTextureBindlessIndex] this texture is a depth stencil texture, it can't be used as bindless texture!";
                   if(const auto myname = ResourceFetch<Component::Gfx::ComponentResourceName>(texture); myname)
@@ -1491,18 +2015,18 @@ uint32_t GfxContext::GetTextureBindlessIndex(ResourceHandle texture) {
 }
 
 uint64_t GfxContext::GetBufferBindlessAddress(ResourceHandle buffer) {
-      if(buffer.Type != GfxEnumResourceType::Buffer) {
+      if(buffer.Type == GfxEnumResourceType::Buffer) {
             const auto ptr = ResourceFetch<Component::Gfx::Buffer>(buffer);
             if (!ptr) {
-                  const auto err = "[Context::GetBufferBindlessAddress] Invalid Texture Handle";
+                  const auto err = "[Context::GetBufferBindlessAddress] Invalid Buffer Handle";
                   MessageManager::Log(MessageType::Warning, err);
                   return 0;
             }
             return ptr->GetBDAAddress();
-      } else if(buffer.Type != GfxEnumResourceType::Buffer3F) {
+      } else if(buffer.Type == GfxEnumResourceType::Buffer3F) {
             const auto ptr = ResourceFetch<Component::Gfx::Buffer3F>(buffer);
             if (!ptr) {
-                  const auto err = "[Context::GetBufferBindlessAddress] Invalid Texture Handle";
+                  const auto err = "[Context::GetBufferBindlessAddress] Invalid Buffer Handle";
                   MessageManager::Log(MessageType::Warning, err);
                   return 0;
             }
@@ -1531,6 +2055,305 @@ void* GfxContext::GetBufferMappedAddress(ResourceHandle buffer) {
       return ptr->Map();
 }
 
+GfxReadbackTicket GfxContext::ReadbackTexture(ResourceHandle texture, const GfxParamReadback& param) {
+      if(texture.Type != GfxEnumResourceType::Texture2D) {
+            const auto err = std::format("[Context::ReadbackTexture] Invalid Resource Type, Need a Texture2D, but got {}.", ToStringResourceType(texture.Type));
+            MessageManager::Log(MessageType::Error, err);
+            return 0;
+      }
+
+      const auto ptr = ResourceFetch<Component::Gfx::Texture>(texture);
+      if (!ptr || !ptr->IsResident()) {
+            const auto err = "[Context::ReadbackTexture] Invalid or not resident Texture Handle";
+            MessageManager::Log(MessageType::Warning, err);
+            return 0;
+      }
+
+      if (ptr->IsTextureFormatDepthStencil() && !ptr->IsTextureFormatDepthOnly()) {
+            auto err = std::string("[Context::ReadbackTexture] Readback of combined depth stencil formats is not supported.");
+            if (!ptr->GetResourceName().empty()) err += std::format(" - Name: \"{}\"", ptr->GetResourceName());
+            MessageManager::Log(MessageType::Error, err);
+            return 0;
+      }
+
+      const VkFormat format = ptr->GetFormat();
+      const VkExtent3D extent = ptr->GetExtent();
+
+      bool encodable = true;
+      switch (param.Encode) {
+            case GfxEnumReadbackEncode::PNG:
+                  encodable = format == VK_FORMAT_R8_UNORM || format == VK_FORMAT_R8G8B8A8_UNORM || format == VK_FORMAT_R8G8B8A8_SRGB
+                        || format == VK_FORMAT_B8G8R8A8_UNORM || format == VK_FORMAT_B8G8R8A8_SRGB;
+                  break;
+            case GfxEnumReadbackEncode::HDR:
+                  encodable = format == VK_FORMAT_R32_SFLOAT || format == VK_FORMAT_R32G32B32A32_SFLOAT;
+                  break;
+            default: break;
+      }
+
+      if (!encodable || (param.Encode != GfxEnumReadbackEncode::NONE && !param.pEncodeFilePath)) {
+            auto err = std::format("[Context::ReadbackTexture] Can't encode format {} to the requested file type, or the file path is null.", (uint32_t)format);
+            if (!ptr->GetResourceName().empty()) err += std::format(" - Name: \"{}\"", ptr->GetResourceName());
+            MessageManager::Log(MessageType::Error, err);
+            return 0;
+      }
+
+      return EnqueueReadback({
+            .Source = texture,
+            .Size = GetFormatLevelSize(format, extent.width, extent.height),
+            .Format = format,
+            .Width = extent.width,
+            .Height = extent.height
+      }, param);
+}
+
+GfxReadbackTicket GfxContext::ReadbackBuffer(ResourceHandle buffer, uint64_t offset, uint64_t size, const GfxParamReadback& param) {
+      if(buffer.Type != GfxEnumResourceType::Buffer) {
+            const auto err = std::format("[Context::ReadbackBuffer] Invalid Resource Type, Need a Buffer, but got {}.", ToStringResourceType(buffer.Type));
+            MessageManager::Log(MessageType::Error, err);
+            return 0;
+      }
+
+      const auto ptr = ResourceFetch<Component::Gfx::Buffer>(buffer);
+      if (!ptr) {
+            const auto err = "[Context::ReadbackBuffer] Invalid Buffer Handle";
+            MessageManager::Log(MessageType::Warning, err);
+            return 0;
+      }
+
+      if (size == 0 && offset < ptr->GetCapacity()) size = ptr->GetCapacity() - offset;
+      if (size == 0 || offset + size > ptr->GetCapacity() || param.Encode != GfxEnumReadbackEncode::NONE) {
+            auto err = std::format("[Context::ReadbackBuffer] Invalid range [{}, {}) for capacity {}, buffers can't be encoded.", offset, offset + size, ptr->GetCapacity());
+            if (!ptr->GetResourceName().empty()) err += std::format(" - Name: \"{}\"", ptr->GetResourceName());
+            MessageManager::Log(MessageType::Error, err);
+            return 0;
+      }
+
+      return EnqueueReadback({
+            .Source = buffer,
+            .Offset = offset,
+            .Size = size,
+      }, param);
+}
+
+GfxEnumReadbackState GfxContext::QueryReadback(GfxReadbackTicket ticket) {
+      std::unique_lock lock(_readbackMutex);
+      const auto it = _readbackTickets.find(ticket);
+      return it == _readbackTickets.end() ? GfxEnumReadbackState::INVALID : it->second->State.load();
+}
+
+const void* GfxContext::GetReadbackData(GfxReadbackTicket ticket, uint64_t* size) {
+      std::unique_lock lock(_readbackMutex);
+      const auto it = _readbackTickets.find(ticket);
+      if (it == _readbackTickets.end() || it->second->State != GfxEnumReadbackState::READY) {
+            if (size) *size = 0;
+            return nullptr;
+      }
+      if (size) *size = it->second->Data.size();
+      return it->second->Data.data();
+}
+
+void GfxContext::ReleaseReadback(GfxReadbackTicket ticket) {
+      std::unique_lock lock(_readbackMutex);
+      _readbackTickets.erase(ticket);
+}
+
+GfxReadbackTicket GfxContext::EnqueueReadback(ReadbackRequest&& request, const GfxParamReadback& param) {
+      request.Ticket = _readbackTicketCounter++;
+      request.Encode = param.Encode;
+      request.EncodePath = param.pEncodeFilePath ? param.pEncodeFilePath : std::string{};
+      request.AnyHandleForCallback = param.AnyHandleForCallback;
+      request.PtrOnReadbackDone = param.PtrOnReadbackDone;
+
+      {
+            std::unique_lock lock(_readbackMutex);
+            _readbackTickets[request.Ticket] = std::make_shared<ReadbackTicketState>();
+      }
+
+      const auto ticket = request.Ticket;
+      _queueReadbackRequest.enqueue(std::move(request));
+      return ticket;
+}
+
+void GfxContext::StageReadback() {
+      VkCommandBuffer cmd = _commandBuffer[GetCurrentFrameIndex()];
+      auto& in_flight = _readbackInFlight;
+      _readbackRingHead = 0;
+
+      const auto make_readback_buffer = [](const char* name, uint64_t size) {
+            auto buffer = std::make_unique<Component::Gfx::Buffer>();
+            if (!buffer->Init(name, VkBufferCreateInfo{
+                  .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+                  .size = size,
+                  .usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                  .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+            }, VmaAllocationCreateInfo{
+                  .flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT,
+                  .usage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST,
+                  .requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                  .preferredFlags = VK_MEMORY_PROPERTY_HOST_CACHED_BIT,
+            }) || !buffer->Map()) {
+                  buffer.reset();
+            }
+            return buffer;
+      };
+
+      // failures are reported with the frame's other readbacks, callbacks never run under the world lock
+      const auto fail = [&](ReadbackRequest& request) {
+            request.Failed = true;
+            request.FrameValue = GetCurrentFrameValue();
+            in_flight.push_back(std::move(request));
+      };
+
+      ReadbackRequest request{};
+      bool has_copy = false;
+      while (_queueReadbackRequest.try_dequeue(request)) {
+            const auto texture = request.Source.Type == GfxEnumResourceType::Texture2D ? _world.try_get<Component::Gfx::Texture>(request.Source.RHandle) : nullptr;
+            const auto buffer = request.Source.Type == GfxEnumResourceType::Buffer ? _world.try_get<Component::Gfx::Buffer>(request.Source.RHandle) : nullptr;
+            if ((!texture || !texture->IsResident()) && !buffer) {
+                  fail(request); // destroyed before the copy was recorded
+                  continue;
+            }
+
+            if (!_readbackRing) {
+                  _readbackRing = make_readback_buffer("Readback Ring Buffer", ReadbackRingFrameSize * 3);
+                  if (!_readbackRing) {
+                        fail(request);
+                        continue;
+                  }
+            }
+
+            // image copies need offsets aligned to 4 and to the texel block size
+            const uint64_t alignment = std::lcm<uint64_t>(16, texture ? GetFormatBlockSize(request.Format) : 1);
+            const uint64_t aligned_head = (_readbackRingHead + alignment - 1) / alignment * alignment;
+
+            VkBuffer dst{};
+            uint64_t dst_offset = 0;
+            if (aligned_head + request.Size <= ReadbackRingFrameSize) {
+                  request.RingOffset = GetCurrentFrameIndex() * ReadbackRingFrameSize + aligned_head;
+                  _readbackRingHead = aligned_head + request.Size;
+                  _readbackRing->BarrierLayout(cmd, GfxEnumKernelType::OUT_OF_KERNEL, GfxEnumResourceUsage::TRANS_DST);
+                  dst = _readbackRing->GetBuffer();
+                  dst_offset = request.RingOffset;
+            } else {
+                  request.Dedicated = make_readback_buffer(std::format("Readback Buffer {}", request.Ticket).c_str(), request.Size);
+                  if (!request.Dedicated) {
+                        fail(request);
+                        continue;
+                  }
+                  request.Dedicated->BarrierLayout(cmd, GfxEnumKernelType::OUT_OF_KERNEL, GfxEnumResourceUsage::TRANS_DST);
+                  dst = request.Dedicated->GetBuffer();
+            }
+
+            if (texture) {
+                  texture->BarrierLayout(cmd, GfxEnumKernelType::OUT_OF_KERNEL, GfxEnumResourceUsage::TRANS_SRC);
+                  const VkBufferImageCopy region {
+                        .bufferOffset = dst_offset,
+                        .bufferRowLength = 0,
+                        .bufferImageHeight = 0,
+                        .imageSubresource = {
+                              .aspectMask = texture->IsTextureFormatDepthOnly() ? (VkImageAspectFlags)VK_IMAGE_ASPECT_DEPTH_BIT : (VkImageAspectFlags)VK_IMAGE_ASPECT_COLOR_BIT,
+                              .mipLevel = 0,
+                              .baseArrayLayer = 0,
+                              .layerCount = 1
+                        },
+                        .imageOffset = {0, 0, 0},
+                        .imageExtent = {request.Width, request.Height, 1}
+                  };
+                  vkCmdCopyImageToBuffer(cmd, texture->GetImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, dst, 1, &region);
+            } else {
+                  buffer->BarrierLayout(cmd, GfxEnumKernelType::OUT_OF_KERNEL, GfxEnumResourceUsage::TRANS_SRC);
+                  const VkBufferCopy region {
+                        .srcOffset = request.Offset,
+                        .dstOffset = dst_offset,
+                        .size = request.Size
+                  };
+                  vkCmdCopyBuffer(cmd, buffer->GetBuffer(), dst, 1, &region);
+            }
+
+            has_copy = true;
+            request.FrameValue = GetCurrentFrameValue();
+            in_flight.push_back(std::move(request));
+      }
+
+      if (has_copy) {
+            const VkMemoryBarrier2 barrier {
+                  .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+                  .srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                  .srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                  .dstStageMask = VK_PIPELINE_STAGE_2_HOST_BIT,
+                  .dstAccessMask = VK_ACCESS_2_HOST_READ_BIT
+            };
+            const VkDependencyInfo dependency {
+                  .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+                  .memoryBarrierCount = 1,
+                  .pMemoryBarriers = &barrier
+            };
+            vkCmdPipelineBarrier2(cmd, &dependency);
+      }
+}
+
+void GfxContext::CompleteReadback(uint64_t completed_frame_value) {
+      std::vector<ReadbackRequest> still_in_flight{};
+      for (auto& request : _readbackInFlight) {
+            if (request.FrameValue > completed_frame_value) {
+                  still_in_flight.push_back(std::move(request));
+                  continue;
+            }
+
+            std::shared_ptr<ReadbackTicketState> state{};
+            {
+                  std::unique_lock lock(_readbackMutex);
+                  if (const auto it = _readbackTickets.find(request.Ticket); it != _readbackTickets.end()) state = it->second;
+            }
+            if (!state) continue; // released while in flight
+
+            if (request.Failed) {
+                  FinishReadback(request, state, GfxEnumReadbackState::FAILED);
+                  continue;
+            }
+
+            const auto src = request.Dedicated ? (const uint8_t*)request.Dedicated->Map() : (const uint8_t*)_readbackRing->Map() + request.RingOffset;
+            state->Data.assign(src, src + request.Size);
+            request.Dedicated.reset();
+
+            if (request.Encode == GfxEnumReadbackEncode::NONE) {
+                  FinishReadback(request, state, GfxEnumReadbackState::READY);
+                  continue;
+            }
+
+            _taskExecutor->silent_async([this, request, state]() {
+                  const int comp = (int)(GetFormatBlockSize(request.Format) / (request.Encode == GfxEnumReadbackEncode::HDR ? 4 : 1));
+                  int res = 0;
+                  if (request.Encode == GfxEnumReadbackEncode::HDR) {
+                        res = stbi_write_hdr(request.EncodePath.c_str(), (int)request.Width, (int)request.Height, comp, (const float*)state->Data.data());
+                  } else if (request.Format == VK_FORMAT_B8G8R8A8_UNORM || request.Format == VK_FORMAT_B8G8R8A8_SRGB) {
+                        std::vector<uint8_t> rgba = state->Data;
+                        for (size_t i = 0; i + 3 < rgba.size(); i += 4) std::swap(rgba[i], rgba[i + 2]);
+                        res = stbi_write_png(request.EncodePath.c_str(), (int)request.Width, (int)request.Height, comp, rgba.data(), (int)request.Width * comp);
+                  } else {
+                        res = stbi_write_png(request.EncodePath.c_str(), (int)request.Width, (int)request.Height, comp, state->Data.data(), (int)request.Width * comp);
+                  }
+
+                  if (!res) {
+                        const auto err = std::format("[Context::CompleteReadback] Failed to encode readback to \"{}\".", request.EncodePath);
+                        MessageManager::Log(MessageType::Error, err);
+                  }
+                  FinishReadback(request, state, res ? GfxEnumReadbackState::READY : GfxEnumReadbackState::FAILED);
+            });
+      }
+      _readbackInFlight = std::move(still_in_flight);
+}
+
+void GfxContext::FinishReadback(const ReadbackRequest& request, const std::shared_ptr<ReadbackTicketState>& state, GfxEnumReadbackState result) {
+      state->State = result;
+      if (request.PtrOnReadbackDone) {
+            const bool ready = result == GfxEnumReadbackState::READY;
+            request.PtrOnReadbackDone(request.AnyHandleForCallback, request.Ticket, ready ? state->Data.data() : nullptr, ready ? state->Data.size() : 0);
+            ReleaseReadback(request.Ticket);
+      }
+}
+
 FrameGraph* GfxContext::GetFrameGraph() const {
       return _frameGraph.get();
 }
@@ -1590,6 +2413,8 @@ void GfxContext::EnqueueBuffer3FUpdate(ResourceHandle handle) {
 void GfxContext::StageResourceUpdate() {
      // _updateBuffer3FLeft
 
+      StageAsyncTextureLoad();
+
       {
             VkCommandBuffer cmd = _commandBuffer[GetCurrentFrameIndex()];
             ResourceHandle handle{};
@@ -1619,8 +2444,21 @@ void GfxContext::StageResourceUpdate() {
       }
 }
 
-VkFence GfxContext::GetCurrentFence() const {
-      return _mainCommandFence[_currentCommandBufferIndex];
+uint64_t GfxContext::GetCompletedFrameValue() const {
+      uint64_t value = 0;
+      vkGetSemaphoreCounterValue(_device, _frameTimeline, &value);
+      return value;
+}
+
+bool GfxContext::WaitFrame(uint64_t frame_value, uint64_t timeout) const {
+      if (frame_value == 0) return true;
+      const VkSemaphoreWaitInfo wait_info{
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+            .semaphoreCount = 1,
+            .pSemaphores = &_frameTimeline,
+            .pValues = &frame_value
+      };
+      return vkWaitSemaphores(_device, &wait_info, timeout) == VK_SUCCESS;
 }
 
 void GfxContext::GoNextFrame() {
@@ -1632,101 +2470,60 @@ void GfxContext::RecoveryContextResource(const ContextResourceRecoveryInfo& pack
 }
 
 void GfxContext::StageRecoveryContextResource() {
-      std::vector<ContextResourceRecoveryInfo>& current_list = _resoureceRecoveryList[GetCurrentFrameIndex()];
-      if (!current_list.empty()) {
-            for (auto& i : current_list) {
-                  switch (i.Type) {
-                        case ContextResourceType::BUFFER:
-                              RecoveryContextResourceBuffer(i);
-                              break;
-                        case ContextResourceType::BUFFER_VIEW:
-                              RecoveryContextResourceBufferView(i);
-                              break;
-                        case ContextResourceType::IMAGE:
-                              RecoveryContextResourceImage(i);
-                              break;
-                        case ContextResourceType::IMAGE_VIEW:
-                              RecoveryContextResourceImageView(i);
-                              break;
-                        case ContextResourceType::PIPELINE:
-                              RecoveryContextResourcePipeline(i);
-                              break;
-                        case ContextResourceType::PIPELINE_LAYOUT:
-                              RecoveryContextResourcePipelineLayout(i);
-                        default: break;
-                  }
+      const uint64_t completed = GetCompletedFrameValue();
+      while (!_resourceRecoveryPending.empty() && _resourceRecoveryPending.front().first <= completed) {
+            for (auto& i : _resourceRecoveryPending.front().second) {
+                  RecoveryContextResourceDispatch(i);
             }
+            _resourceRecoveryPending.pop_front();
       }
 
-      current_list.clear();
-
+      //anything released up to now may still be referenced by the frame just submitted
+      std::vector<ContextResourceRecoveryInfo> current_list{};
       ContextResourceRecoveryInfo temp{};
       while (_resourceRecoveryQueue.try_dequeue(temp)) {
             current_list.push_back(temp);
       }
+
+      if (!current_list.empty()) {
+            _resourceRecoveryPending.emplace_back(_frameTimelineValue, std::move(current_list));
+      }
 }
 
 void GfxContext::RecoveryAllContextResourceImmediately() {
-      for (size_t i = GetCurrentFrameIndex(); i < GetCurrentFrameIndex() + 3; i++) {
-            std::vector<ContextResourceRecoveryInfo>& current_list = _resoureceRecoveryList[i % 3];
-            if (!current_list.empty()) {
-                  for (auto& resource : current_list) {
-                        switch (resource.Type) {
-                              case ContextResourceType::BUFFER:
-                                    RecoveryContextResourceBuffer(resource);
-                                    break;
-                              case ContextResourceType::BUFFER_VIEW:
-                                    RecoveryContextResourceBufferView(resource);
-                                    break;
-                              case ContextResourceType::IMAGE:
-                                    RecoveryContextResourceImage(resource);
-                                    break;
-                              case ContextResourceType::IMAGE_VIEW:
-                                    RecoveryContextResourceImageView(resource);
-                                    break;
-                              case ContextResourceType::PIPELINE:
-                                    RecoveryContextResourcePipeline(resource);
-                                    break;
-                              case ContextResourceType::PIPELINE_LAYOUT:
-                                    RecoveryContextResourcePipelineLayout(resource);
-                              default: break;
-                        }
-                  }
+      for (auto& list : _resourceRecoveryPending | std::views::values) {
+            for (auto& i : list) {
+                  RecoveryContextResourceDispatch(i);
             }
-            current_list.clear();
       }
-
-      std::vector<ContextResourceRecoveryInfo>& current_list = _resoureceRecoveryList[0];
+      _resourceRecoveryPending.clear();
 
       ContextResourceRecoveryInfo temp{};
       while (_resourceRecoveryQueue.try_dequeue(temp)) {
-            current_list.push_back(temp);
+            RecoveryContextResourceDispatch(temp);
       }
+}
 
-      if (!current_list.empty()) {
-            for (auto& i : current_list) {
-                  switch (i.Type) {
-                        case ContextResourceType::BUFFER:
-                              RecoveryContextResourceBuffer(i);
-                              break;
-                        case ContextResourceType::BUFFER_VIEW:
-                              RecoveryContextResourceBufferView(i);
-                              break;
-                        case ContextResourceType::IMAGE:
-                              RecoveryContextResourceImage(i);
-                              break;
-                        case ContextResourceType::IMAGE_VIEW:
-                              RecoveryContextResourceImageView(i);
-                              break;
-                        case ContextResourceType::PIPELINE:
-                              RecoveryContextResourcePipeline(i);
-                              break;
-                        case ContextResourceType::PIPELINE_LAYOUT:
-                              RecoveryContextResourcePipelineLayout(i);
-                              break;
-                        default: break;
-                  }
-            }
+void GfxContext::RecoveryContextResourceDispatch(const ContextResourceRecoveryInfo& pack) {
+      switch (pack.Type) {
+            case ContextResourceType::BUFFER:
+                  RecoveryContextResourceBuffer(pack);
+                  break;
+            case ContextResourceType::BUFFER_VIEW:
+                  RecoveryContextResourceBufferView(pack);
+                  break;
+            case ContextResourceType::IMAGE:
+                  RecoveryContextResourceImage(pack);
+                  break;
+            case ContextResourceType::IMAGE_VIEW:
+                  RecoveryContextResourceImageView(pack);
+                  break;
+            case ContextResourceType::PIPELINE:
+                  RecoveryContextResourcePipeline(pack);
+                  break;
+            case ContextResourceType::PIPELINE_LAYOUT:
+                  RecoveryContextResourcePipelineLayout(pack);
+            default: break;
       }
 }
 
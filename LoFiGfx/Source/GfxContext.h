@@ -4,11 +4,18 @@
 #pragma once
 
 #include <shared_mutex>
+#include <mutex>
+#include <atomic>
+#include <deque>
 
 #include "Helper.h"
 #include "PhysicalDevice.h"
 #include "LoFiGfxDefines.h"
 
+namespace tf {
+      class Executor;
+}
+
 namespace LoFi {
 
       namespace Component::Gfx {
@@ -20,8 +27,15 @@ namespace LoFi {
             class Swapchain;
       }
 
+      namespace Internal {
+            class AssetPack;
+            class FrameLinearAllocator;
+      }
+
       class PfxContext;
 
+      class GpuPrimitives;
+
       class GfxContext {
             friend class Component::Gfx::Buffer;
             friend class Component::Gfx::Buffer3F;
@@ -44,6 +58,41 @@ namespace LoFi {
                   }
             };
 
+            struct AsyncTextureLoadResult {
+                  ResourceHandle Texture{};
+                  VkFormat Format = VK_FORMAT_UNDEFINED;
+                  uint32_t Width = 0;
+                  uint32_t Height = 0;
+                  uint32_t MipLevels = 1;
+                  size_t DataSize = 0;
+                  std::unique_ptr<Component::Gfx::Buffer> Intermediate{};
+            };
+
+            struct ReadbackTicketState {
+                  std::atomic<GfxEnumReadbackState> State = GfxEnumReadbackState::PENDING;
+                  std::vector<uint8_t> Data{};
+            };
+
+            struct ReadbackRequest {
+                  GfxReadbackTicket Ticket = 0;
+                  ResourceHandle Source{};
+                  uint64_t Offset = 0;
+                  uint64_t Size = 0;
+                  VkFormat Format = VK_FORMAT_UNDEFINED;
+                  uint32_t Width = 0;
+                  uint32_t Height = 0;
+                  GfxEnumReadbackEncode Encode = GfxEnumReadbackEncode::NONE;
+                  std::string EncodePath{};
+                  uint64_t AnyHandleForCallback = 0;
+                  void (*PtrOnReadbackDone)(uint64_t, GfxReadbackTicket, const void*, uint64_t) = nullptr;
+                  uint64_t RingOffset = 0;
+                  std::shared_ptr<Component::Gfx::Buffer> Dedicated{}; // used when the ring segment is full
+                  bool Failed = false;
+                  uint64_t FrameValue = 0;
+            };
+
+            static constexpr uint64_t ReadbackRingFrameSize = 16 * 1024 * 1024;
+
             static GfxContext* GlobalContext;
 
       public:
@@ -55,7 +104,7 @@ namespace LoFi {
 
             ~GfxContext();
 
-            void Init();
+            void Init(const GfxParamInit& param = {});
 
             void DestroyHandle(ResourceHandle handle);
 
@@ -63,10 +112,14 @@ namespace LoFi {
 
             [[nodiscard]] ResourceHandle CreateTexture2D(VkFormat format, uint32_t w, uint32_t h, const GfxParamCreateTexture2D& param = {});
 
+            [[nodiscard]] ResourceHandle CreateTexture2DFromFileAsync(const char* file_path, const GfxParamCreateTexture2D& param = {});
+
             [[nodiscard]] ResourceHandle CreateBuffer(const GfxParamCreateBuffer& param);
 
             [[nodiscard]] ResourceHandle CreateBuffer3F(const GfxParamCreateBuffer3F& param);
 
+            [[nodiscard]] GfxInfoConstantBuffer CreateConstantBuffer(const GfxParamCreateConstantBuffer& param);
+
             [[nodiscard]] ResourceHandle CreateProgram(const GfxParamCreateProgram& param);
 
             [[nodiscard]] ResourceHandle CreateProgramFromFile(const GfxParamCreateProgramFromFile& param);
@@ -79,6 +132,16 @@ namespace LoFi {
 
             void Destroy2DCanvas(Gfx2DCanvas canvas);
 
+            [[nodiscard]] GfxAssetPack OpenAssetPack(const char* path);
+
+            void CloseAssetPack(GfxAssetPack pack);
+
+            [[nodiscard]] ResourceHandle CreateTexture2DFromPack(GfxAssetPack pack, const char* entry_name, const GfxParamCreateTexture2D& param = {});
+
+            [[nodiscard]] ResourceHandle CreateProgramFromPack(GfxAssetPack pack, const char* entry_name, const char* resource_name = nullptr);
+
+            [[nodiscard]] const void* GetAssetPackData(GfxAssetPack pack, const char* entry_name, size_t* size) const;
+
             void SetRootRenderNode(ResourceHandle node) const;
 
             bool SetRenderNodeWait(ResourceHandle node, const GfxInfoRenderNodeWait& param);
@@ -87,12 +150,22 @@ namespace LoFi {
 
             bool FillKernelConstant(ResourceHandle kernel, const void* data, size_t size);
 
+            [[nodiscard]] GfxKernelConstantSlot GetKernelConstantSlot(ResourceHandle kernel, const std::string& name);
+
+            bool SetKernelConstant(ResourceHandle kernel, GfxKernelConstantSlot slot, const void* data);
+
+            bool SetKernelConstants(ResourceHandle kernel, std::span<const GfxInfoKernelConstant> constants);
+
+            bool SetKernelSpecConstants(ResourceHandle kernel, std::span<const GfxInfoKernelSpecConstant> constants);
+
             bool SetBuffer(ResourceHandle buffer, const void* data, uint64_t size, uint64_t offset_for_3f = 0);
 
             bool ResizeBuffer(ResourceHandle buffer, uint64_t size);
 
             bool SetTexture2D(ResourceHandle texture, const void* data, uint64_t size);
 
+            bool SetTexture2DRegion(ResourceHandle texture, uint32_t x, uint32_t y, uint32_t w, uint32_t h, const void* data, uint64_t size);
+
             bool ResizeTexture2D(ResourceHandle texture, uint32_t w, uint32_t h);
 
             void SetTextureSampler(ResourceHandle texture, const VkSamplerCreateInfo& sampler_ci);
@@ -111,14 +184,42 @@ namespace LoFi {
 
             [[nodiscard]] uint32_t GetTextureBindlessIndex(ResourceHandle texture);
 
+            [[nodiscard]] bool IsTextureResident(ResourceHandle texture);
+
+            [[nodiscard]] GfxEnumTextureLoadState GetTextureLoadState(ResourceHandle texture);
+
+            [[nodiscard]] Component::Gfx::Texture* GetPlaceholderTexture();
+
             [[nodiscard]] uint64_t GetBufferBindlessAddress(ResourceHandle buffer);
 
             [[nodiscard]] void* GetBufferMappedAddress(ResourceHandle buffer);
 
+            [[nodiscard]] GfxReadbackTicket ReadbackTexture(ResourceHandle texture, const GfxParamReadback& param = {});
+
+            [[nodiscard]] GfxReadbackTicket ReadbackBuffer(ResourceHandle buffer, uint64_t offset, uint64_t size, const GfxParamReadback& param = {});
+
+            [[nodiscard]] GfxEnumReadbackState QueryReadback(GfxReadbackTicket ticket);
+
+            [[nodiscard]] const void* GetReadbackData(GfxReadbackTicket ticket, uint64_t* size);
+
+            void ReleaseReadback(GfxReadbackTicket ticket);
+
             [[nodiscard]] FrameGraph* GetFrameGraph() const;
 
+            [[nodiscard]] GpuPrimitives* GetGpuPrimitives() const { return _gpuPrimitives.get(); }
+
+            [[nodiscard]] tf::Executor* GetTaskExecutor() const { return _taskExecutor.get(); }
+
+            [[nodiscard]] const GfxInfoDeviceFeatures& GetDeviceFeatures() const { return _deviceFeatures; }
+
             [[nodiscard]] uint32_t GetCurrentFrameIndex() const;
 
+            [[nodiscard]] uint64_t GetCurrentFrameValue() const { return _frameTimelineValue + 1; }
+
+            [[nodiscard]] uint64_t GetCompletedFrameValue() const;
+
+            bool WaitFrame(uint64_t frame_value, uint64_t timeout = UINT64_MAX) const;
+
             [[nodiscard]] bool IsValidHandle(ResourceHandle handle);
 
             void WaitDevice() const;
@@ -139,6 +240,18 @@ namespace LoFi {
 
             void StageResourceUpdate();
 
+            void StageAsyncTextureLoad();
+
+            bool InitTexture2D(Component::Gfx::Texture* ptr, VkFormat format, uint32_t w, uint32_t h, const GfxParamCreateTexture2D& param);
+
+            GfxReadbackTicket EnqueueReadback(ReadbackRequest&& request, const GfxParamReadback& param);
+
+            void StageReadback();
+
+            void CompleteReadback(uint64_t completed_frame_value);
+
+            void FinishReadback(const ReadbackRequest& request, const std::shared_ptr<ReadbackTicketState>& state, GfxEnumReadbackState result);
+
       private:
             void RecoveryContextResource(const Internal::ContextResourceRecoveryInfo& pack);
 
@@ -146,6 +259,8 @@ namespace LoFi {
 
             void RecoveryAllContextResourceImmediately();
 
+            void RecoveryContextResourceDispatch(const Internal::ContextResourceRecoveryInfo& pack);
+
             void RecoveryContextResourceBuffer(const Internal::ContextResourceRecoveryInfo& pack) const;
 
             void RecoveryContextResourceBufferView(const Internal::ContextResourceRecoveryInfo& pack) const;
@@ -168,8 +283,6 @@ namespace LoFi {
 
             //void PrepareSwapChainRenderTarget();
 
-            VkFence GetCurrentFence() const;
-
             void GoNextFrame();
 
       private:
@@ -181,6 +294,8 @@ namespace LoFi {
 
             PhysicalDevice _physicalDeviceAbility{};
 
+            GfxInfoDeviceFeatures _deviceFeatures{};
+
             VkDevice _device{};
 
             VmaAllocator _allocator{};
@@ -191,7 +306,11 @@ namespace LoFi {
 
             VkCommandBuffer _commandBuffer[3]{};
 
-            VkFence _mainCommandFence[3]{};
+            VkSemaphore _frameTimeline{}; // signalled with _frameTimelineValue by each submitted frame
+
+            uint64_t _frameTimelineValue = 0;
+
+            uint64_t _frameSlotValue[3]{};
 
             VkSemaphore _mainCommandQueueSemaphore[3]{};
 
@@ -229,10 +348,32 @@ namespace LoFi {
 
             std::vector<ResourceHandle> _updateBuffer3FLeft{};
 
+            moodycamel::ConcurrentQueue<AsyncTextureLoadResult> _queueTextureLoaded{};
+
+            std::unique_ptr<tf::Executor> _taskExecutor{};
+
+            ResourceHandle _placeholderTexture{};
+
+            moodycamel::ConcurrentQueue<ReadbackRequest> _queueReadbackRequest{};
+
+            std::vector<ReadbackRequest> _readbackInFlight{};
+
+            std::unique_ptr<Component::Gfx::Buffer> _readbackRing{}; // 3 persistently mapped segments, one per frame
+
+            uint64_t _readbackRingHead = 0;
+
+            std::mutex _readbackMutex{};
+
+            entt::dense_map<GfxReadbackTicket, std::shared_ptr<ReadbackTicketState>> _readbackTickets{};
+
+            std::atomic<GfxReadbackTicket> _readbackTicketCounter = 1;
+
+            std::unique_ptr<Internal::FrameLinearAllocator> _frameConstantAllocator{};
+
       private:
             moodycamel::ConcurrentQueue<Internal::ContextResourceRecoveryInfo> _resourceRecoveryQueue{};
 
-            std::vector<Internal::ContextResourceRecoveryInfo> _resoureceRecoveryList[3]{};
+            std::deque<std::pair<uint64_t, std::vector<Internal::ContextResourceRecoveryInfo>>> _resourceRecoveryPending{}; // keyed by frame value
 
       private:
             std::unique_ptr<FrameGraph> _frameGraph{};
@@ -246,7 +387,9 @@ namespace LoFi {
       private:
             entt::dense_set<PfxContext*> _2DCanvas{};
 
-      private:
-            bool _first_call = true;
+            entt::dense_set<Internal::AssetPack*> _assetPacks{};
+
+            std::unique_ptr<GpuPrimitives> _gpuPrimitives{};
+
       };
 }
@@ -0,0 +1,773 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#include "GpuPrimitives.h"
+#include "GfxContext.h"
+#include "RenderNode.h"
+#include "Message.h"
+
+#include "GfxComponents/Buffer.h"
+#include "GfxComponents/Kernel.h"
+
+using namespace LoFi;
+
+namespace {
+      constexpr auto PrimitiveCommon = R"(
+            #extension GL_EXT_buffer_reference : enable
+            #extension GL_EXT_buffer_reference2 : enable
+            #extension GL_EXT_scalar_block_layout : enable
+
+            layout(buffer_reference, scalar, buffer_reference_align = 4) buffer UintArray { uint v[]; };
+
+            uint GroupIndex() { return gl_WorkGroupID.x + gl_WorkGroupID.y * gl_NumWorkGroups.x; }
+      )";
+
+      // Mode 1 scans (value != 0 ? 1 : 0), used by stream compaction
+      constexpr auto PrimitiveScanTile = R"(
+            layout(local_size_x = 256) in;
+
+            layout(push_constant) uniform Params {
+                  UintArray Src;
+                  UintArray Dst;
+                  UintArray BlockSums;
+                  uint Count;
+                  uint Inclusive;
+                  uint WriteBlockSums;
+                  uint Mode;
+            } pc;
+
+            shared uint s_sums[256];
+
+            void CSMain() {
+                  const uint group = GroupIndex();
+                  if (group * 1024 >= pc.Count) return;
+
+                  const uint t = gl_LocalInvocationID.x;
+                  const uint base = group * 1024 + t * 4;
+
+                  uint vals[4];
+                  uint local_sum = 0;
+                  for (uint i = 0; i < 4; i++) {
+                        const uint idx = base + i;
+                        uint v = idx < pc.Count ? pc.Src.v[idx] : 0;
+                        if (pc.Mode == 1) v = v != 0 ? 1 : 0;
+                        vals[i] = v;
+                        local_sum += v;
+                  }
+
+                  s_sums[t] = local_sum;
+                  barrier();
+                  for (uint offset = 1; offset < 256; offset <<= 1) {
+                        const uint add = t >= offset ? s_sums[t - offset] : 0;
+                        barrier();
+                        s_sums[t] += add;
+                        barrier();
+                  }
+
+                  uint prefix = t > 0 ? s_sums[t - 1] : 0;
+                  for (uint i = 0; i < 4; i++) {
+                        const uint idx = base + i;
+                        if (idx >= pc.Count) break;
+                        if (pc.Inclusive != 0) {
+                              prefix += vals[i];
+                              pc.Dst.v[idx] = prefix;
+                        } else {
+                              pc.Dst.v[idx] = prefix;
+                              prefix += vals[i];
+                        }
+                  }
+
+                  if (pc.WriteBlockSums != 0 && t == 255) {
+                        pc.BlockSums.v[group] = s_sums[255];
+                  }
+            }
+      )";
+
+      constexpr auto PrimitiveScanAdd = R"(
+            layout(local_size_x = 256) in;
+
+            layout(push_constant) uniform Params {
+                  UintArray Data;
+                  UintArray BlockSums;
+                  uint Count;
+            } pc;
+
+            void CSMain() {
+                  const uint group = GroupIndex();
+                  if (group * 1024 >= pc.Count) return;
+
+                  const uint add = pc.BlockSums.v[group];
+                  const uint base = group * 1024 + gl_LocalInvocationID.x;
+                  for (uint i = 0; i < 4; i++) {
+                        const uint idx = base + i * 256;
+                        if (idx < pc.Count) pc.Data.v[idx] += add;
+                  }
+            }
+      )";
+
+      // Hist is digit-major (digit * BlockCount + block), so one exclusive scan yields scatter bases
+      constexpr auto PrimitiveRadixHistogram = R"(
+            layout(local_size_x = 256) in;
+
+            layout(push_constant) uniform Params {
+                  UintArray Keys;
+                  UintArray Hist;
+                  uint Count;
+                  uint Shift;
+                  uint BlockCount;
+            } pc;
+
+            shared uint s_hist[16];
+
+            void CSMain() {
+                  const uint group = GroupIndex();
+                  if (group * 1024 >= pc.Count) return;
+
+                  const uint t = gl_LocalInvocationID.x;
+                  if (t < 16) s_hist[t] = 0;
+                  barrier();
+
+                  const uint base = group * 1024 + t * 4;
+                  for (uint i = 0; i < 4; i++) {
+                        const uint idx = base + i;
+                        if (idx < pc.Count) atomicAdd(s_hist[(pc.Keys.v[idx] >> pc.Shift) & 15], 1);
+                  }
+                  barrier();
+
+                  if (t < 16) pc.Hist.v[t * pc.BlockCount + group] = s_hist[t];
+            }
+      )";
+
+      constexpr auto PrimitiveRadixScatter = R"(
+            layout(local_size_x = 256) in;
+
+            layout(push_constant) uniform Params {
+                  UintArray KeysIn;
+                  UintArray ValuesIn;
+                  UintArray KeysOut;
+                  UintArray ValuesOut;
+                  UintArray HistScanned;
+                  uint Count;
+                  uint Shift;
+                  uint BlockCount;
+                  uint HasValues;
+            } pc;
+
+            // digit pairs share a word, 16 bits each, a tile never counts past 1024 so the halves can't carry.
+            // 9KB, below the 16KB every device supports
+            shared uint s_counts[8][256];
+            shared uint s_partial[8][32];
+
+            void CSMain() {
+                  const uint group = GroupIndex();
+                  if (group * 1024 >= pc.Count) return;
+
+                  const uint t = gl_LocalInvocationID.x;
+                  const uint base = group * 1024 + t * 4;
+
+                  for (uint p = 0; p < 8; p++) s_counts[p][t] = 0;
+
+                  uint keys[4];
+                  uint digits[4];
+                  for (uint i = 0; i < 4; i++) {
+                        const uint idx = base + i;
+                        const bool valid = idx < pc.Count;
+                        keys[i] = valid ? pc.KeysIn.v[idx] : 0;
+                        digits[i] = valid ? (keys[i] >> pc.Shift) & 15 : 16;
+                        if (valid) s_counts[digits[i] >> 1][t] += 1u << ((digits[i] & 1) * 16);
+                  }
+                  barrier();
+
+                  // exclusive scan of every digit pair row across threads, 32 chunks of 8 entries per row
+                  const uint row = t & 7;
+                  const uint chunk = t >> 3;
+                  uint chunk_sum = 0;
+                  for (uint j = 0; j < 8; j++) chunk_sum += s_counts[row][chunk * 8 + j];
+                  s_partial[row][chunk] = chunk_sum;
+                  barrier();
+
+                  if (t < 8) {
+                        uint run = 0;
+                        for (uint c = 0; c < 32; c++) {
+                              const uint v = s_partial[t][c];
+                              s_partial[t][c] = run;
+                              run += v;
+                        }
+                  }
+                  barrier();
+
+                  uint run = s_partial[row][chunk];
+                  for (uint j = 0; j < 8; j++) {
+                        const uint v = s_counts[row][chunk * 8 + j];
+                        s_counts[row][chunk * 8 + j] = run;
+                        run += v;
+                  }
+                  barrier();
+
+                  for (uint i = 0; i < 4; i++) {
+                        const uint d = digits[i];
+                        if (d >= 16) continue;
+
+                        uint rank = (s_counts[d >> 1][t] >> ((d & 1) * 16)) & 0xFFFF;
+                        for (uint k = 0; k < i; k++) rank += digits[k] == d ? 1 : 0;
+
+                        const uint dst = pc.HistScanned.v[d * pc.BlockCount + group] + rank;
+                        pc.KeysOut.v[dst] = keys[i];
+                        if (pc.HasValues != 0) pc.ValuesOut.v[dst] = pc.ValuesIn.v[base + i];
+                  }
+            }
+      )";
+
+      constexpr auto PrimitiveSegmentedReduce = R"(
+            layout(local_size_x = 256) in;
+
+            layout(push_constant) uniform Params {
+                  UintArray Values;
+                  UintArray Offsets;
+                  UintArray Dst;
+                  uint SegmentCount;
+                  uint Op;
+            } pc;
+
+            shared uint s_reduce[256];
+
+            uint Identity() {
+                  switch (pc.Op) {
+                        case 1: return 0xFFFFFFFFu;
+                        case 3: return floatBitsToUint(0.0f);
+                        case 4: return 0x7F800000u;
+                        case 5: return 0xFF800000u;
+                        default: return 0u;
+                  }
+            }
+
+            uint Combine(uint a, uint b) {
+                  switch (pc.Op) {
+                        case 1: return min(a, b);
+                        case 2: return max(a, b);
+                        case 3: return floatBitsToUint(uintBitsToFloat(a) + uintBitsToFloat(b));
+                        case 4: return floatBitsToUint(min(uintBitsToFloat(a), uintBitsToFloat(b)));
+                        case 5: return floatBitsToUint(max(uintBitsToFloat(a), uintBitsToFloat(b)));
+                        default: return a + b;
+                  }
+            }
+
+            void CSMain() {
+                  const uint segment = GroupIndex();
+                  if (segment >= pc.SegmentCount) return;
+
+                  const uint t = gl_LocalInvocationID.x;
+                  const uint begin = pc.Offsets.v[segment];
+                  const uint end = pc.Offsets.v[segment + 1];
+
+                  uint acc = Identity();
+                  for (uint i = begin + t; i < end; i += 256) acc = Combine(acc, pc.Values.v[i]);
+                  s_reduce[t] = acc;
+                  barrier();
+
+                  for (uint stride = 128; stride > 0; stride >>= 1) {
+                        if (t < stride) s_reduce[t] = Combine(s_reduce[t], s_reduce[t + stride]);
+                        barrier();
+                  }
+
+                  if (t == 0) pc.Dst.v[segment] = s_reduce[0];
+            }
+      )";
+
+      constexpr auto PrimitiveCompactScatter = R"(
+            layout(local_size_x = 256) in;
+
+            layout(push_constant) uniform Params {
+                  UintArray Src;
+                  UintArray Flags;
+                  UintArray Indices;
+                  UintArray Dst;
+                  UintArray CountDst;
+                  uint Count;
+                  uint WriteCount;
+            } pc;
+
+            void CSMain() {
+                  const uint group = GroupIndex();
+                  if (group * 1024 >= pc.Count) return;
+
+                  const uint base = group * 1024 + gl_LocalInvocationID.x;
+                  for (uint i = 0; i < 4; i++) {
+                        const uint idx = base + i * 256;
+                        if (idx >= pc.Count) break;
+
+                        const bool keep = pc.Flags.v[idx] != 0;
+                        if (keep) pc.Dst.v[pc.Indices.v[idx]] = pc.Src.v[idx];
+                        if (pc.WriteCount != 0 && idx == pc.Count - 1) pc.CountDst.v[0] = pc.Indices.v[idx] + (keep ? 1 : 0);
+                  }
+            }
+      )";
+
+      constexpr auto PrimitiveHistogram = R"(
+            layout(local_size_x = 256) in;
+
+            layout(push_constant) uniform Params {
+                  UintArray Src;
+                  UintArray Bins;
+                  uint Count;
+                  uint BinCount;
+                  uint Shift;
+            } pc;
+
+            shared uint s_bins[4096];
+
+            void CSMain() {
+                  const uint group = GroupIndex();
+                  if (group * 1024 >= pc.Count) return;
+
+                  const uint t = gl_LocalInvocationID.x;
+                  const uint base = group * 1024 + t;
+                  const bool privatized = pc.BinCount <= 4096;
+
+                  if (privatized) {
+                        for (uint b = t; b < pc.BinCount; b += 256) s_bins[b] = 0;
+                  }
+                  barrier();
+
+                  for (uint i = 0; i < 4; i++) {
+                        const uint idx = base + i * 256;
+                        if (idx >= pc.Count) break;
+                        const uint bin = min(pc.Src.v[idx] >> pc.Shift, pc.BinCount - 1);
+                        if (privatized) atomicAdd(s_bins[bin], 1);
+                        else atomicAdd(pc.Bins.v[bin], 1);
+                  }
+                  barrier();
+
+                  if (privatized) {
+                        for (uint b = t; b < pc.BinCount; b += 256) {
+                              if (s_bins[b] != 0) atomicAdd(pc.Bins.v[b], s_bins[b]);
+                        }
+                  }
+            }
+      )";
+
+      constexpr auto PrimitiveFill = R"(
+            layout(local_size_x = 256) in;
+
+            layout(push_constant) uniform Params {
+                  UintArray Dst;
+                  uint Count;
+                  uint Value;
+            } pc;
+
+            void CSMain() {
+                  const uint base = GroupIndex() * 1024 + gl_LocalInvocationID.x;
+                  for (uint i = 0; i < 4; i++) {
+                        const uint idx = base + i * 256;
+                        if (idx < pc.Count) pc.Dst.v[idx] = pc.Value;
+                  }
+            }
+      )";
+
+      constexpr auto PrimitiveCopy = R"(
+            layout(local_size_x = 256) in;
+
+            layout(push_constant) uniform Params {
+                  UintArray Src;
+                  UintArray Dst;
+                  uint Count;
+            } pc;
+
+            void CSMain() {
+                  const uint base = GroupIndex() * 1024 + gl_LocalInvocationID.x;
+                  for (uint i = 0; i < 4; i++) {
+                        const uint idx = base + i * 256;
+                        if (idx < pc.Count) pc.Dst.v[idx] = pc.Src.v[idx];
+                  }
+            }
+      )";
+
+      struct PrimitiveKernelSource {
+            const char* Name;
+            const char* Source;
+      };
+
+      constexpr PrimitiveKernelSource PrimitiveKernelSources[] = {
+            {"Primitive-ScanTile", PrimitiveScanTile},
+            {"Primitive-ScanAdd", PrimitiveScanAdd},
+            {"Primitive-RadixHistogram", PrimitiveRadixHistogram},
+            {"Primitive-RadixScatter", PrimitiveRadixScatter},
+            {"Primitive-SegmentedReduce", PrimitiveSegmentedReduce},
+            {"Primitive-CompactScatter", PrimitiveCompactScatter},
+            {"Primitive-Histogram", PrimitiveHistogram},
+            {"Primitive-Fill", PrimitiveFill},
+            {"Primitive-Copy", PrimitiveCopy},
+      };
+
+      static_assert(std::size(PrimitiveKernelSources) == (size_t)GpuPrimitiveKernel::COUNT);
+
+      struct ScanTileConstants {
+            uint64_t Src;
+            uint64_t Dst;
+            uint64_t BlockSums;
+            uint32_t Count;
+            uint32_t Inclusive;
+            uint32_t WriteBlockSums;
+            uint32_t Mode;
+      };
+
+      struct ScanAddConstants {
+            uint64_t Data;
+            uint64_t BlockSums;
+            uint32_t Count;
+      };
+
+      struct RadixHistogramConstants {
+            uint64_t Keys;
+            uint64_t Hist;
+            uint32_t Count;
+            uint32_t Shift;
+            uint32_t BlockCount;
+      };
+
+      struct RadixScatterConstants {
+            uint64_t KeysIn;
+            uint64_t ValuesIn;
+            uint64_t KeysOut;
+            uint64_t ValuesOut;
+            uint64_t HistScanned;
+            uint32_t Count;
+            uint32_t Shift;
+            uint32_t BlockCount;
+            uint32_t HasValues;
+      };
+
+      struct SegmentedReduceConstants {
+            uint64_t Values;
+            uint64_t Offsets;
+            uint64_t Dst;
+            uint32_t SegmentCount;
+            uint32_t Op;
+      };
+
+      struct CompactScatterConstants {
+            uint64_t Src;
+            uint64_t Flags;
+            uint64_t Indices;
+            uint64_t Dst;
+            uint64_t CountDst;
+            uint32_t Count;
+            uint32_t WriteCount;
+      };
+
+      struct HistogramConstants {
+            uint64_t Src;
+            uint64_t Bins;
+            uint32_t Count;
+            uint32_t BinCount;
+            uint32_t Shift;
+      };
+
+      struct FillConstants {
+            uint64_t Dst;
+            uint32_t Count;
+            uint32_t Value;
+      };
+
+      struct CopyConstants {
+            uint64_t Src;
+            uint64_t Dst;
+            uint32_t Count;
+      };
+}
+
+GpuPrimitives::GpuPrimitives(GfxContext* gfx) : _gfx(gfx) {}
+
+GpuPrimitives::~GpuPrimitives() {
+      for (uint32_t i = 0; i < (uint32_t)GpuPrimitiveKernel::COUNT; i++) {
+            if (_kernels[i].RHandle != entt::null) _gfx->DestroyHandle(_kernels[i]);
+            if (_programs[i].RHandle != entt::null) _gfx->DestroyHandle(_programs[i]);
+      }
+}
+
+Component::Gfx::Kernel* GpuPrimitives::FetchKernel(GpuPrimitiveKernel which) {
+      const auto index = (uint32_t)which;
+      {
+            std::unique_lock lock(_mutex);
+            if (_failed[index]) return nullptr;
+            if (_kernels[index].RHandle == entt::null) {
+                  const auto& source = PrimitiveKernelSources[index];
+                  const std::string code = std::string(PrimitiveCommon) + source.Source;
+                  const char* codes[] = {code.c_str()};
+
+                  _programs[index] = _gfx->CreateProgram({
+                        .pResourceName = source.Name,
+                        .pConfig = "",
+                        .pSourceCodes = codes,
+                        .countSourceCode = 1,
+                        .Optimization = GfxEnumShaderOptimization::PERFORMANCE
+                  });
+                  if (_programs[index].RHandle == entt::null) {
+                        const auto err = std::format("[GpuPrimitives::FetchKernel] Failed to create program - Name: \"{}\"", source.Name);
+                        MessageManager::Log(MessageType::Error, err);
+                        _failed[index] = true;
+                        return nullptr;
+                  }
+
+                  _kernels[index] = _gfx->CreateKernel(_programs[index], {.pResourceName = source.Name});
+                  if (_kernels[index].RHandle == entt::null) {
+                        const auto err = std::format("[GpuPrimitives::FetchKernel] Failed to create kernel - Name: \"{}\"", source.Name);
+                        MessageManager::Log(MessageType::Error, err);
+                        _gfx->DestroyHandle(_programs[index]);
+                        _programs[index] = {};
+                        _failed[index] = true;
+                        return nullptr;
+                  }
+            }
+      }
+      return _gfx->ResourceFetch<Component::Gfx::Kernel>(_kernels[index]);
+}
+
+uint64_t GpuPrimitives::EnsureScratch(RenderNode* node, uint64_t element_count) {
+      std::unique_lock lock(_mutex);
+      auto& node_scratch = _scratch[node->GetHandle().RHandle];
+      const uint64_t size = std::max<uint64_t>(element_count, 1) * sizeof(uint32_t);
+      if (!node_scratch || node_scratch->GetCapacity() < size) {
+            // the old scratch is released through the context recovery queue, after frames using it retire
+            auto scratch = std::make_unique<Component::Gfx::Buffer>();
+            const uint64_t capacity = std::max<uint64_t>(size + size / 2, 1024 * 1024);
+            const std::string name = std::format("GpuPrimitives Scratch Buffer - Node: \"{}\"", node->GetNodeName());
+            if (!scratch->Init(name.c_str(), VkBufferCreateInfo{
+                  .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+                  .size = capacity,
+                  .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+                  .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+            }, VmaAllocationCreateInfo{
+                  .usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+            })) {
+                  return 0;
+            }
+            node_scratch = std::move(scratch);
+      }
+      return node_scratch->GetBDAAddress();
+}
+
+void GpuPrimitives::ReleaseNode(entt::entity node) {
+      std::unique_lock lock(_mutex);
+      _scratch.erase(node);
+}
+
+void GpuPrimitives::Dispatch(RenderNode* node, GpuPrimitiveKernel which, const void* constants, uint32_t constants_size, uint32_t group_count) {
+      const auto kernel = FetchKernel(which);
+      if (!kernel || group_count == 0) return;
+
+      node->CmdBindKernel(_kernels[(uint32_t)which]);
+      node->CmdPushConstant(kernel->GetLayout(), constants, constants_size);
+
+      const uint32_t x = std::min(group_count, 65535u);
+      const uint32_t y = (group_count + x - 1) / x;
+      node->CmdComputeDispatch(x, y, 1);
+}
+
+uint64_t GpuPrimitives::ScanScratchSize(uint32_t count) {
+      uint64_t total = 0;
+      for (uint32_t level = TileCount(count); level > 1; level = TileCount(level)) {
+            total += level;
+      }
+      return total;
+}
+
+void GpuPrimitives::RecordScan(RenderNode* node, uint64_t src, uint64_t dst, uint32_t count, bool inclusive, bool predicate, uint64_t scratch) {
+      const uint32_t tiles = TileCount(count);
+
+      ScanTileConstants tile{
+            .Src = src,
+            .Dst = dst,
+            .BlockSums = scratch,
+            .Count = count,
+            .Inclusive = inclusive ? 1u : 0u,
+            .WriteBlockSums = tiles > 1 ? 1u : 0u,
+            .Mode = predicate ? 1u : 0u
+      };
+      Dispatch(node, GpuPrimitiveKernel::SCAN_TILE, &tile, sizeof(tile), tiles);
+      if (tiles == 1) return;
+
+      // scan the tile totals in place, then add them back
+      node->CmdComputeBarrier();
+      RecordScan(node, scratch, scratch, tiles, false, false, scratch + tiles * sizeof(uint32_t));
+      node->CmdComputeBarrier();
+
+      ScanAddConstants add{
+            .Data = dst,
+            .BlockSums = scratch,
+            .Count = count
+      };
+      Dispatch(node, GpuPrimitiveKernel::SCAN_ADD, &add, sizeof(add), tiles);
+}
+
+bool GpuPrimitives::CmdScan(RenderNode* node, uint64_t src, uint64_t dst, uint32_t count, bool inclusive) {
+      if (!node || !src || !dst) {
+            MessageManager::Log(MessageType::Error, "[GpuPrimitives::CmdScan] Invalid node or buffer address.");
+            return false;
+      }
+      if (count == 0) return true;
+
+      const uint64_t scratch = EnsureScratch(node, ScanScratchSize(count));
+      if (!scratch) return false;
+
+      node->CmdComputeBarrier(true);
+      RecordScan(node, src, dst, count, inclusive, false, scratch);
+      node->CmdComputeBarrier(true);
+      return true;
+}
+
+bool GpuPrimitives::CmdRadixSort(RenderNode* node, uint64_t keys, uint64_t values, uint32_t count, uint32_t key_bits) {
+      if (!node || !keys) {
+            MessageManager::Log(MessageType::Error, "[GpuPrimitives::CmdRadixSort] Invalid node or buffer address.");
+            return false;
+      }
+      if (count <= 1) return true;
+
+      key_bits = std::clamp(key_bits, 1u, 32u);
+      const uint32_t passes = (key_bits + 3) / 4;
+      const uint32_t tiles = TileCount(count);
+      const uint32_t hist_count = tiles * 16;
+
+      // scratch: keys | values | hist | scan levels of hist
+      const uint64_t keys_tmp_offset = 0;
+      const uint64_t values_tmp_offset = count;
+      const uint64_t hist_offset = values_tmp_offset + (values ? count : 0);
+      const uint64_t scan_offset = hist_offset + hist_count;
+
+      const uint64_t scratch = EnsureScratch(node, scan_offset + ScanScratchSize(hist_count));
+      if (!scratch) return false;
+
+      const uint64_t keys_tmp = scratch + keys_tmp_offset * sizeof(uint32_t);
+      const uint64_t values_tmp = values ? scratch + values_tmp_offset * sizeof(uint32_t) : 0;
+      const uint64_t hist = scratch + hist_offset * sizeof(uint32_t);
+      const uint64_t hist_scan = scratch + scan_offset * sizeof(uint32_t);
+
+      uint64_t keys_in = keys, keys_out = keys_tmp;
+      uint64_t values_in = values, values_out = values_tmp;
+
+      node->CmdComputeBarrier(true);
+      for (uint32_t pass = 0; pass < passes; pass++) {
+            RadixHistogramConstants histogram{
+                  .Keys = keys_in,
+                  .Hist = hist,
+                  .Count = count,
+                  .Shift = pass * 4,
+                  .BlockCount = tiles
+            };
+            Dispatch(node, GpuPrimitiveKernel::RADIX_HISTOGRAM, &histogram, sizeof(histogram), tiles);
+            node->CmdComputeBarrier();
+
+            RecordScan(node, hist, hist, hist_count, false, false, hist_scan);
+            node->CmdComputeBarrier();
+
+            RadixScatterConstants scatter{
+                  .KeysIn = keys_in,
+                  .ValuesIn = values_in,
+                  .KeysOut = keys_out,
+                  .ValuesOut = values_out,
+                  .HistScanned = hist,
+                  .Count = count,
+                  .Shift = pass * 4,
+                  .BlockCount = tiles,
+                  .HasValues = values ? 1u : 0u
+            };
+            Dispatch(node, GpuPrimitiveKernel::RADIX_SCATTER, &scatter, sizeof(scatter), tiles);
+            node->CmdComputeBarrier();
+
+            std::swap(keys_in, keys_out);
+            std::swap(values_in, values_out);
+      }
+
+      // odd pass count leaves the result in scratch
+      if (keys_in != keys) {
+            CopyConstants copy_keys{.Src = keys_in, .Dst = keys, .Count = count};
+            Dispatch(node, GpuPrimitiveKernel::COPY, &copy_keys, sizeof(copy_keys), tiles);
+            if (values) {
+                  CopyConstants copy_values{.Src = values_in, .Dst = values, .Count = count};
+                  Dispatch(node, GpuPrimitiveKernel::COPY, &copy_values, sizeof(copy_values), tiles);
+            }
+      }
+      node->CmdComputeBarrier(true);
+      return true;
+}
+
+bool GpuPrimitives::CmdSegmentedReduce(RenderNode* node, uint64_t values, uint64_t segment_offsets, uint64_t dst, uint32_t segment_count, GfxEnumPrimitiveReduceOp op) {
+      if (!node || !values || !segment_offsets || !dst) {
+            MessageManager::Log(MessageType::Error, "[GpuPrimitives::CmdSegmentedReduce] Invalid node or buffer address.");
+            return false;
+      }
+      if (segment_count == 0) return true;
+
+      SegmentedReduceConstants reduce{
+            .Values = values,
+            .Offsets = segment_offsets,
+            .Dst = dst,
+            .SegmentCount = segment_count,
+            .Op = (uint32_t)op
+      };
+
+      node->CmdComputeBarrier(true);
+      Dispatch(node, GpuPrimitiveKernel::SEGMENTED_REDUCE, &reduce, sizeof(reduce), segment_count);
+      node->CmdComputeBarrier(true);
+      return true;
+}
+
+bool GpuPrimitives::CmdCompact(RenderNode* node, uint64_t src, uint64_t flags, uint64_t dst, uint64_t count_dst, uint32_t count) {
+      if (!node || !src || !flags || !dst) {
+            MessageManager::Log(MessageType::Error, "[GpuPrimitives::CmdCompact] Invalid node or buffer address.");
+            return false;
+      }
+      if (count == 0) return true;
+
+      // scratch: indices | scan levels
+      const uint64_t scratch = EnsureScratch(node, count + ScanScratchSize(count));
+      if (!scratch) return false;
+
+      const uint64_t indices = scratch;
+      const uint64_t scan_scratch = scratch + (uint64_t)count * sizeof(uint32_t);
+
+      node->CmdComputeBarrier(true);
+      RecordScan(node, flags, indices, count, false, true, scan_scratch);
+      node->CmdComputeBarrier();
+
+      CompactScatterConstants scatter{
+            .Src = src,
+            .Flags = flags,
+            .Indices = indices,
+            .Dst = dst,
+            .CountDst = count_dst,
+            .Count = count,
+            .WriteCount = count_dst ? 1u : 0u
+      };
+      Dispatch(node, GpuPrimitiveKernel::COMPACT_SCATTER, &scatter, sizeof(scatter), TileCount(count));
+      node->CmdComputeBarrier(true);
+      return true;
+}
+
+bool GpuPrimitives::CmdHistogram(RenderNode* node, uint64_t src, uint64_t bins, uint32_t count, uint32_t bin_count, uint32_t value_shift) {
+      if (!node || !src || !bins || bin_count == 0) {
+            MessageManager::Log(MessageType::Error, "[GpuPrimitives::CmdHistogram] Invalid node, buffer address or bin count.");
+            return false;
+      }
+
+      node->CmdComputeBarrier(true);
+
+      FillConstants fill{.Dst = bins, .Count = bin_count, .Value = 0};
+      Dispatch(node, GpuPrimitiveKernel::FILL, &fill, sizeof(fill), TileCount(bin_count));
+
+      if (count != 0) {
+            node->CmdComputeBarrier();
+            HistogramConstants histogram{
+                  .Src = src,
+                  .Bins = bins,
+                  .Count = count,
+                  .BinCount = bin_count,
+                  .Shift = std::min(value_shift, 31u)
+            };
+            Dispatch(node, GpuPrimitiveKernel::HISTOGRAM, &histogram, sizeof(histogram), TileCount(count));
+      }
+
+      node->CmdComputeBarrier(true);
+      return true;
+}
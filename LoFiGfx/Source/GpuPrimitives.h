@@ -0,0 +1,85 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#pragma once
+#include "Helper.h"
+
+#include <mutex>
+
+namespace LoFi::Component::Gfx {
+      class Buffer;
+      class Kernel;
+}
+
+namespace LoFi {
+
+      class GfxContext;
+      class RenderNode;
+
+      enum class GpuPrimitiveKernel : uint32_t {
+            SCAN_TILE,
+            SCAN_ADD,
+            RADIX_HISTOGRAM,
+            RADIX_SCATTER,
+            SEGMENTED_REDUCE,
+            COMPACT_SCATTER,
+            HISTOGRAM,
+            FILL,
+            COPY,
+            COUNT
+      };
+
+      // Built-in compute kernels working on buffer device addresses (uint32 elements),
+      // recorded into the caller's compute pass. Kernels are compiled on first use,
+      // every node gets its own scratch so nodes can record primitives concurrently.
+      class GpuPrimitives {
+      public:
+            static constexpr uint32_t TileSize = 1024; // 256 threads x 4 items
+
+            NO_COPY_MOVE_CONS(GpuPrimitives);
+
+            explicit GpuPrimitives(GfxContext* gfx);
+
+            ~GpuPrimitives();
+
+            bool CmdScan(RenderNode* node, uint64_t src, uint64_t dst, uint32_t count, bool inclusive);
+
+            bool CmdRadixSort(RenderNode* node, uint64_t keys, uint64_t values, uint32_t count, uint32_t key_bits);
+
+            bool CmdSegmentedReduce(RenderNode* node, uint64_t values, uint64_t segment_offsets, uint64_t dst, uint32_t segment_count, GfxEnumPrimitiveReduceOp op);
+
+            bool CmdCompact(RenderNode* node, uint64_t src, uint64_t flags, uint64_t dst, uint64_t count_dst, uint32_t count);
+
+            bool CmdHistogram(RenderNode* node, uint64_t src, uint64_t bins, uint32_t count, uint32_t bin_count, uint32_t value_shift);
+
+            // drops the node's scratch, called when the node is destroyed
+            void ReleaseNode(entt::entity node);
+
+      private:
+            Component::Gfx::Kernel* FetchKernel(GpuPrimitiveKernel which);
+
+            uint64_t EnsureScratch(RenderNode* node, uint64_t element_count);
+
+            void Dispatch(RenderNode* node, GpuPrimitiveKernel which, const void* constants, uint32_t constants_size, uint32_t group_count);
+
+            void RecordScan(RenderNode* node, uint64_t src, uint64_t dst, uint32_t count, bool inclusive, bool predicate, uint64_t scratch);
+
+            static uint64_t ScanScratchSize(uint32_t count);
+
+            static uint32_t TileCount(uint32_t count) { return (count + TileSize - 1) / TileSize; }
+
+      private:
+            GfxContext* _gfx{};
+
+            std::mutex _mutex{};
+
+            ResourceHandle _programs[(uint32_t)GpuPrimitiveKernel::COUNT]{};
+
+            ResourceHandle _kernels[(uint32_t)GpuPrimitiveKernel::COUNT]{};
+
+            bool _failed[(uint32_t)GpuPrimitiveKernel::COUNT]{}; // reported once, later calls don't compile again
+
+            entt::dense_map<entt::entity, std::unique_ptr<Component::Gfx::Buffer>> _scratch{};
+      };
+}
@@ -1182,6 +1182,109 @@ namespace LoFi::Internal {
             return IsDepthOnlyFormat(format) || IsDepthStencilOnlyFormat(format);
       }
 
+      bool IsCompressedFormat(VkFormat format) {
+            return (format >= VK_FORMAT_BC1_RGB_UNORM_BLOCK && format <= VK_FORMAT_ASTC_12x12_SRGB_BLOCK);
+      }
+
+      VkExtent2D GetFormatBlockExtent(VkFormat format) {
+            if (format >= VK_FORMAT_BC1_RGB_UNORM_BLOCK && format <= VK_FORMAT_EAC_R11G11_SNORM_BLOCK) return {4, 4};
+            switch (format) {
+                  case VK_FORMAT_ASTC_4x4_UNORM_BLOCK: case VK_FORMAT_ASTC_4x4_SRGB_BLOCK: return {4, 4};
+                  case VK_FORMAT_ASTC_5x4_UNORM_BLOCK: case VK_FORMAT_ASTC_5x4_SRGB_BLOCK: return {5, 4};
+                  case VK_FORMAT_ASTC_5x5_UNORM_BLOCK: case VK_FORMAT_ASTC_5x5_SRGB_BLOCK: return {5, 5};
+                  case VK_FORMAT_ASTC_6x5_UNORM_BLOCK: case VK_FORMAT_ASTC_6x5_SRGB_BLOCK: return {6, 5};
+                  case VK_FORMAT_ASTC_6x6_UNORM_BLOCK: case VK_FORMAT_ASTC_6x6_SRGB_BLOCK: return {6, 6};
+                  case VK_FORMAT_ASTC_8x5_UNORM_BLOCK: case VK_FORMAT_ASTC_8x5_SRGB_BLOCK: return {8, 5};
+                  case VK_FORMAT_ASTC_8x6_UNORM_BLOCK: case VK_FORMAT_ASTC_8x6_SRGB_BLOCK: return {8, 6};
+                  case VK_FORMAT_ASTC_8x8_UNORM_BLOCK: case VK_FORMAT_ASTC_8x8_SRGB_BLOCK: return {8, 8};
+                  case VK_FORMAT_ASTC_10x5_UNORM_BLOCK: case VK_FORMAT_ASTC_10x5_SRGB_BLOCK: return {10, 5};
+                  case VK_FORMAT_ASTC_10x6_UNORM_BLOCK: case VK_FORMAT_ASTC_10x6_SRGB_BLOCK: return {10, 6};
+                  case VK_FORMAT_ASTC_10x8_UNORM_BLOCK: case VK_FORMAT_ASTC_10x8_SRGB_BLOCK: return {10, 8};
+                  case VK_FORMAT_ASTC_10x10_UNORM_BLOCK: case VK_FORMAT_ASTC_10x10_SRGB_BLOCK: return {10, 10};
+                  case VK_FORMAT_ASTC_12x10_UNORM_BLOCK: case VK_FORMAT_ASTC_12x10_SRGB_BLOCK: return {12, 10};
+                  case VK_FORMAT_ASTC_12x12_UNORM_BLOCK: case VK_FORMAT_ASTC_12x12_SRGB_BLOCK: return {12, 12};
+                  default: return {1, 1};
+            }
+      }
+
+      uint32_t GetFormatBlockSize(VkFormat format) {
+            switch (format) {
+                  case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+                  case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+                  case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+                  case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+                  case VK_FORMAT_BC4_UNORM_BLOCK:
+                  case VK_FORMAT_BC4_SNORM_BLOCK:
+                  case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
+                  case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+                  case VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK:
+                  case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:
+                  case VK_FORMAT_EAC_R11_UNORM_BLOCK:
+                  case VK_FORMAT_EAC_R11_SNORM_BLOCK:
+                        return 8;
+                  case VK_FORMAT_R8_UNORM:
+                  case VK_FORMAT_R8_SNORM:
+                  case VK_FORMAT_R8_UINT:
+                  case VK_FORMAT_R8_SINT:
+                  case VK_FORMAT_R8_SRGB:
+                  case VK_FORMAT_S8_UINT:
+                        return 1;
+                  case VK_FORMAT_R8G8_UNORM:
+                  case VK_FORMAT_R8G8_SNORM:
+                  case VK_FORMAT_R8G8_UINT:
+                  case VK_FORMAT_R8G8_SINT:
+                  case VK_FORMAT_R8G8_SRGB:
+                  case VK_FORMAT_R16_UNORM:
+                  case VK_FORMAT_R16_SNORM:
+                  case VK_FORMAT_R16_UINT:
+                  case VK_FORMAT_R16_SINT:
+                  case VK_FORMAT_R16_SFLOAT:
+                  case VK_FORMAT_D16_UNORM:
+                  case VK_FORMAT_R5G6B5_UNORM_PACK16:
+                  case VK_FORMAT_B5G6R5_UNORM_PACK16:
+                  case VK_FORMAT_R4G4B4A4_UNORM_PACK16:
+                  case VK_FORMAT_B4G4R4A4_UNORM_PACK16:
+                  case VK_FORMAT_R5G5B5A1_UNORM_PACK16:
+                  case VK_FORMAT_B5G5R5A1_UNORM_PACK16:
+                  case VK_FORMAT_A1R5G5B5_UNORM_PACK16:
+                        return 2;
+                  case VK_FORMAT_R8G8B8_UNORM:
+                  case VK_FORMAT_R8G8B8_SRGB:
+                  case VK_FORMAT_B8G8R8_UNORM:
+                  case VK_FORMAT_B8G8R8_SRGB:
+                        return 3;
+                  case VK_FORMAT_R16G16B16_UNORM:
+                  case VK_FORMAT_R16G16B16_SFLOAT:
+                        return 6;
+                  case VK_FORMAT_R16G16B16A16_UNORM:
+                  case VK_FORMAT_R16G16B16A16_SNORM:
+                  case VK_FORMAT_R16G16B16A16_UINT:
+                  case VK_FORMAT_R16G16B16A16_SINT:
+                  case VK_FORMAT_R16G16B16A16_SFLOAT:
+                  case VK_FORMAT_R32G32_UINT:
+                  case VK_FORMAT_R32G32_SINT:
+                  case VK_FORMAT_R32G32_SFLOAT:
+                        return 8;
+                  case VK_FORMAT_R32G32B32_UINT:
+                  case VK_FORMAT_R32G32B32_SINT:
+                  case VK_FORMAT_R32G32B32_SFLOAT:
+                        return 12;
+                  case VK_FORMAT_R32G32B32A32_UINT:
+                  case VK_FORMAT_R32G32B32A32_SINT:
+                  case VK_FORMAT_R32G32B32A32_SFLOAT:
+                        return 16;
+                  default:
+                        return IsCompressedFormat(format) ? 16 : 4;
+            }
+      }
+
+      size_t GetFormatLevelSize(VkFormat format, uint32_t w, uint32_t h) {
+            const auto block = GetFormatBlockExtent(format);
+            const size_t block_x = (glm::max(w, 1u) + block.width - 1) / block.width;
+            const size_t block_y = (glm::max(h, 1u) + block.height - 1) / block.height;
+            return block_x * block_y * GetFormatBlockSize(format);
+      }
+
       const char* GetImageLayoutString(VkImageLayout layout) {
             switch (layout) {
                   case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL: return "VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL";
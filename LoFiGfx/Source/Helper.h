@@ -84,6 +84,14 @@ namespace LoFi::Internal {
 
       bool IsDepthStencilFormat(VkFormat format);
 
+      bool IsCompressedFormat(VkFormat format);
+
+      VkExtent2D GetFormatBlockExtent(VkFormat format);
+
+      uint32_t GetFormatBlockSize(VkFormat format);
+
+      size_t GetFormatLevelSize(VkFormat format, uint32_t w, uint32_t h);
+
       const char* GetImageLayoutString(VkImageLayout layout);
 
       const char* ToStringResourceUsage(GfxEnumResourceUsage stage);
@@ -6,12 +6,15 @@
 #include "GfxContext.h"
 #include "Message.h"
 #include "RenderNode.h"
+#include "TextureLoader.h"
+#include "AssetPack.h"
+#include "GpuPrimitives.h"
 
 #include "mimalloc/mimalloc.h"
 
 LoFi::GfxContext* global_gfx = nullptr;
 
-void GfxInit() {
+void GfxInit(const GfxParamInit& param) {
       mi_version();
       mi_option_set(mi_option_verbose, 1);
       mi_option_set(mi_option_show_stats, 1);
@@ -20,7 +23,7 @@ void GfxInit() {
       //mi_option_set(mi_option_reserve_huge_os_pages, 2);
       if (!global_gfx) {
             global_gfx = new LoFi::GfxContext();
-            global_gfx->Init();
+            global_gfx->Init(param);
       }
 }
 
@@ -43,6 +46,22 @@ GfxHandle GfxCreateTexture2D(GfxEnumFormat format, uint32_t w, uint32_t h, const
 }
 
 GfxHandle GfxCreateTexture2DFromFile(const char* file_path, const GfxParamCreateTexture2D& param) {
+      if (LoFi::Internal::TextureLoader::IsContainerFile(file_path)) {
+            LoFi::Internal::TextureFileData file{};
+            if (!LoFi::Internal::TextureLoader::Load(file_path, file)) {
+                  LoFi::MessageManager::Log(LoFi::MessageType::Error, "GfxCreateTexture2DFromFile Err: Load File failed.");
+                  return GfxHandle{GfxEnumResourceType::INVALID_RESOURCE_TYPE};
+            }
+
+            // pre-compressed containers carry their own mip chain
+            return std::bit_cast<GfxHandle>(global_gfx->CreateTexture2D(file.Format, file.Width, file.Height, {
+                  .pResourceName = param.pResourceName,
+                  .pData = file.Data.data(),
+                  .DataSize = file.Data.size(),
+                  .MipMapCount = file.MipLevels
+            }));
+      }
+
       int w, h, channels;
       unsigned char* data = stbi_load(file_path, &w, &h, &channels, 4);
       if (!data) {
@@ -50,16 +69,11 @@ GfxHandle GfxCreateTexture2DFromFile(const char* file_path, const GfxParamCreate
             return GfxHandle{GfxEnumResourceType::INVALID_RESOURCE_TYPE};
       }
 
-      if (channels != 4) {
-            stbi_image_free(data);
-            LoFi::MessageManager::Log(LoFi::MessageType::Error, "GfxCreateTexture2DFromFile Err: Texture's Channel is not 4.");
-            return GfxHandle{GfxEnumResourceType::INVALID_RESOURCE_TYPE};
-      }
-
+      // stbi expands every source to the 4 requested channels
       auto loaded = GfxCreateTexture2D(GfxEnumFormat::FORMAT_R8G8B8A8_UNORM, w, h, {
             .pResourceName = param.pResourceName,
             .pData = data,
-            .DataSize = (size_t)(w * h * channels),
+            .DataSize = (size_t)w * h * 4,
             .MipMapCount = param.MipMapCount
       });
 
@@ -67,6 +81,10 @@ GfxHandle GfxCreateTexture2DFromFile(const char* file_path, const GfxParamCreate
       return loaded;
 }
 
+GfxHandle GfxCreateTexture2DFromFileAsync(const char* file_path, const GfxParamCreateTexture2D& param) {
+      return std::bit_cast<GfxHandle>(global_gfx->CreateTexture2DFromFileAsync(file_path, param));
+}
+
 GfxHandle GfxCreateBuffer(const GfxParamCreateBuffer& param) {
       return std::bit_cast<GfxHandle>(global_gfx->CreateBuffer(param));
 }
@@ -75,6 +93,10 @@ GfxHandle GfxCreateBuffer3F(const GfxParamCreateBuffer3F& param) {
       return std::bit_cast<GfxHandle>(global_gfx->CreateBuffer3F(param));
 }
 
+GfxInfoConstantBuffer GfxCreateConstantBuffer(const GfxParamCreateConstantBuffer& param) {
+      return global_gfx->CreateConstantBuffer(param);
+}
+
 GfxHandle GfxCreateProgram(const GfxParamCreateProgram& param) {
       return std::bit_cast<GfxHandle>(global_gfx->CreateProgram(param));
 }
@@ -113,6 +135,22 @@ bool GfxFillKernelConstant(GfxHandle kernel, const void* data, size_t size) {
       return global_gfx->FillKernelConstant(std::bit_cast<LoFi::ResourceHandle>(kernel), data, size);
 }
 
+GfxKernelConstantSlot GfxGetKernelConstantSlot(GfxHandle kernel, const char* name) {
+      return global_gfx->GetKernelConstantSlot(std::bit_cast<LoFi::ResourceHandle>(kernel), name);
+}
+
+bool GfxSetKernelConstantBySlot(GfxHandle kernel, GfxKernelConstantSlot slot, const void* data) {
+      return global_gfx->SetKernelConstant(std::bit_cast<LoFi::ResourceHandle>(kernel), slot, data);
+}
+
+bool GfxSetKernelConstants(GfxHandle kernel, const GfxInfoKernelConstant* constants, size_t count) {
+      return global_gfx->SetKernelConstants(std::bit_cast<LoFi::ResourceHandle>(kernel), std::span(constants, count));
+}
+
+bool GfxSetKernelSpecConstants(GfxHandle kernel, const GfxInfoKernelSpecConstant* constants, size_t count) {
+      return global_gfx->SetKernelSpecConstants(std::bit_cast<LoFi::ResourceHandle>(kernel), std::span(constants, count));
+}
+
 bool GfxUploadBuffer(GfxHandle buffer, const void* data, uint64_t size) {
       return global_gfx->SetBuffer(std::bit_cast<LoFi::ResourceHandle>(buffer), data, size);
 }
@@ -125,6 +163,10 @@ bool GfxUploadTexture2D(GfxHandle texture, const void* data, uint64_t size) {
       return global_gfx->SetTexture2D(std::bit_cast<LoFi::ResourceHandle>(texture), data, size);
 }
 
+bool GfxUploadTexture2DRegion(GfxHandle texture, uint32_t x, uint32_t y, uint32_t w, uint32_t h, const void* data, uint64_t size) {
+      return global_gfx->SetTexture2DRegion(std::bit_cast<LoFi::ResourceHandle>(texture), x, y, w, h, data, size);
+}
+
 bool GfxResizeTexture2D(GfxHandle texture, uint32_t w, uint32_t h) {
       return global_gfx->ResizeTexture2D(std::bit_cast<LoFi::ResourceHandle>(texture), w, h);
 }
@@ -134,14 +176,34 @@ GfxRDGNodeCore GfxGetRDGNodeCore(GfxHandle node) {
       return std::bit_cast<GfxRDGNodeCore>(global_gfx->GetRenderGraphNodePtr(std::bit_cast<LoFi::ResourceHandle>(node)));
 }
 
+GfxInfoRenderNodeFilterStats GfxGetRDGNodeFilterStats(GfxRDGNodeCore nodec) {
+      return std::bit_cast<LoFi::RenderNode*>(nodec)->GetFilterStats();
+}
+
+GfxInfoRenderNodeQueryStats GfxGetRDGNodeQueryStats(GfxRDGNodeCore nodec) {
+      return std::bit_cast<LoFi::RenderNode*>(nodec)->GetQueryStats();
+}
+
 GfxInfoKernelLayout GfxGetKernelLayout(GfxHandle kernel) {
       return global_gfx->GetKernelLayout(std::bit_cast<LoFi::ResourceHandle>(kernel));
 }
 
+GfxInfoDeviceFeatures GfxGetDeviceFeatures() {
+      return global_gfx->GetDeviceFeatures();
+}
+
 uint32_t GfxGetTextureBindlessIndex(GfxHandle texture) {
       return global_gfx->GetTextureBindlessIndex(std::bit_cast<LoFi::ResourceHandle>(texture));
 }
 
+bool GfxIsTextureResident(GfxHandle texture) {
+      return global_gfx->IsTextureResident(std::bit_cast<LoFi::ResourceHandle>(texture));
+}
+
+GfxEnumTextureLoadState GfxGetTextureLoadState(GfxHandle texture) {
+      return global_gfx->GetTextureLoadState(std::bit_cast<LoFi::ResourceHandle>(texture));
+}
+
 uint64_t GfxGetBufferBindlessAddress(GfxHandle buffer) {
       return global_gfx->GetBufferBindlessAddress(std::bit_cast<LoFi::ResourceHandle>(buffer));
 }
@@ -150,12 +212,44 @@ void* GfxGetBufferMappedAddress(GfxHandle buffer) {
       return global_gfx->GetBufferMappedAddress(std::bit_cast<LoFi::ResourceHandle>(buffer));
 }
 
+GfxReadbackTicket GfxReadbackTexture(GfxHandle texture, const GfxParamReadback& param) {
+      return global_gfx->ReadbackTexture(std::bit_cast<LoFi::ResourceHandle>(texture), param);
+}
+
+GfxReadbackTicket GfxReadbackBuffer(GfxHandle buffer, uint64_t offset, uint64_t size, const GfxParamReadback& param) {
+      return global_gfx->ReadbackBuffer(std::bit_cast<LoFi::ResourceHandle>(buffer), offset, size, param);
+}
+
+GfxEnumReadbackState GfxQueryReadback(GfxReadbackTicket ticket) {
+      return global_gfx->QueryReadback(ticket);
+}
+
+const void* GfxGetReadbackData(GfxReadbackTicket ticket, uint64_t* size) {
+      return global_gfx->GetReadbackData(ticket, size);
+}
+
+void GfxReleaseReadback(GfxReadbackTicket ticket) {
+      return global_gfx->ReleaseReadback(ticket);
+}
+
 //Command
 
 void GfxGenFrame() {
       return global_gfx->GenFrame();
 }
 
+uint64_t GfxGetCurrentFrameValue() {
+      return global_gfx->GetCurrentFrameValue();
+}
+
+uint64_t GfxGetCompletedFrameValue() {
+      return global_gfx->GetCompletedFrameValue();
+}
+
+bool GfxWaitFrame(uint64_t frame_value, uint64_t timeout_ns) {
+      return global_gfx->WaitFrame(frame_value, timeout_ns);
+}
+
 void GfxCmdBeginComputePass(GfxRDGNodeCore nodec) {
       return std::bit_cast<LoFi::RenderNode*>(nodec)->CmdBeginComputePass();
 }
@@ -168,6 +262,34 @@ void GfxCmdComputeDispatch(GfxRDGNodeCore nodec, uint32_t x, uint32_t y, uint32_
       return std::bit_cast<LoFi::RenderNode*>(nodec)->CmdComputeDispatch(x, y, z);
 }
 
+void GfxCmdComputeDispatchIndirect(GfxRDGNodeCore nodec, GfxHandle indirect_buffer, size_t offset) {
+      return std::bit_cast<LoFi::RenderNode*>(nodec)->CmdComputeDispatchIndirect(std::bit_cast<LoFi::ResourceHandle>(indirect_buffer), offset);
+}
+
+void GfxCmdComputeBarrier(GfxRDGNodeCore nodec) {
+      return std::bit_cast<LoFi::RenderNode*>(nodec)->CmdComputeBarrier();
+}
+
+bool GfxCmdPrimitiveScan(GfxRDGNodeCore nodec, uint64_t src_address, uint64_t dst_address, uint32_t count, bool inclusive) {
+      return global_gfx->GetGpuPrimitives()->CmdScan(std::bit_cast<LoFi::RenderNode*>(nodec), src_address, dst_address, count, inclusive);
+}
+
+bool GfxCmdPrimitiveRadixSort(GfxRDGNodeCore nodec, uint64_t keys_address, uint64_t values_address, uint32_t count, uint32_t key_bits) {
+      return global_gfx->GetGpuPrimitives()->CmdRadixSort(std::bit_cast<LoFi::RenderNode*>(nodec), keys_address, values_address, count, key_bits);
+}
+
+bool GfxCmdPrimitiveSegmentedReduce(GfxRDGNodeCore nodec, uint64_t values_address, uint64_t segment_offsets_address, uint64_t dst_address, uint32_t segment_count, GfxEnumPrimitiveReduceOp op) {
+      return global_gfx->GetGpuPrimitives()->CmdSegmentedReduce(std::bit_cast<LoFi::RenderNode*>(nodec), values_address, segment_offsets_address, dst_address, segment_count, op);
+}
+
+bool GfxCmdPrimitiveCompact(GfxRDGNodeCore nodec, uint64_t src_address, uint64_t flags_address, uint64_t dst_address, uint64_t count_address, uint32_t count) {
+      return global_gfx->GetGpuPrimitives()->CmdCompact(std::bit_cast<LoFi::RenderNode*>(nodec), src_address, flags_address, dst_address, count_address, count);
+}
+
+bool GfxCmdPrimitiveHistogram(GfxRDGNodeCore nodec, uint64_t src_address, uint64_t bins_address, uint32_t count, uint32_t bin_count, uint32_t value_shift) {
+      return global_gfx->GetGpuPrimitives()->CmdHistogram(std::bit_cast<LoFi::RenderNode*>(nodec), src_address, bins_address, count, bin_count, value_shift);
+}
+
 void GfxCmdBeginRenderPass(GfxRDGNodeCore nodec, const GfxParamBeginRenderPass& textures) {
       return std::bit_cast<LoFi::RenderNode*>(nodec)->CmdBeginRenderPass(textures);
 }
@@ -180,6 +302,14 @@ void GfxCmdBindKernel(GfxRDGNodeCore nodec, GfxHandle kernel) {
       return std::bit_cast<LoFi::RenderNode*>(nodec)->CmdBindKernel(std::bit_cast<LoFi::ResourceHandle>(kernel));
 }
 
+void GfxCmdSetBlendOverride(GfxRDGNodeCore nodec, GfxEnumBlendOverride blend) {
+      return std::bit_cast<LoFi::RenderNode*>(nodec)->CmdSetBlendOverride(blend);
+}
+
+void GfxCmdSetCullOverride(GfxRDGNodeCore nodec, GfxEnumCullOverride cull) {
+      return std::bit_cast<LoFi::RenderNode*>(nodec)->CmdSetCullOverride(cull);
+}
+
 void GfxCmdBindVertexBuffer(GfxRDGNodeCore nodec, GfxHandle vertex_buffer, uint32_t first_binding, uint32_t binding_count, size_t offset) {
       return std::bit_cast<LoFi::RenderNode*>(nodec)->CmdBindVertexBuffer(std::bit_cast<LoFi::ResourceHandle>(vertex_buffer), first_binding, binding_count, offset);
 }
@@ -192,6 +322,16 @@ void GfxCmdDrawIndexedIndirect(GfxRDGNodeCore nodec, GfxHandle indirect_bufer, s
       return std::bit_cast<LoFi::RenderNode*>(nodec)->CmdDrawIndexedIndirect(std::bit_cast<LoFi::ResourceHandle>(indirect_bufer), offset, draw_count, stride);
 }
 
+void GfxCmdDrawIndexedIndirectCount(GfxRDGNodeCore nodec, GfxHandle indirect_buffer, size_t offset, GfxHandle count_buffer, size_t count_offset, uint32_t max_draw_count, uint32_t stride) {
+      return std::bit_cast<LoFi::RenderNode*>(nodec)->CmdDrawIndexedIndirectCount(std::bit_cast<LoFi::ResourceHandle>(indirect_buffer), offset,
+            std::bit_cast<LoFi::ResourceHandle>(count_buffer), count_offset, max_draw_count, stride);
+}
+
+void GfxCmdDrawIndirectCount(GfxRDGNodeCore nodec, GfxHandle indirect_buffer, size_t offset, GfxHandle count_buffer, size_t count_offset, uint32_t max_draw_count, uint32_t stride) {
+      return std::bit_cast<LoFi::RenderNode*>(nodec)->CmdDrawIndirectCount(std::bit_cast<LoFi::ResourceHandle>(indirect_buffer), offset,
+            std::bit_cast<LoFi::ResourceHandle>(count_buffer), count_offset, max_draw_count, stride);
+}
+
 void GfxCmdDrawIndex(GfxRDGNodeCore nodec, uint32_t index_count, uint32_t instance_count, uint32_t first_index, int32_t vertex_offset, uint32_t first_instance) {
       return std::bit_cast<LoFi::RenderNode*>(nodec)->CmdDrawIndex(index_count, instance_count, first_index, vertex_offset, first_instance);
 }
@@ -248,67 +388,165 @@ void Gfx2DDestroy(Gfx2DCanvas canvas) {
       return global_gfx->Destroy2DCanvas(canvas);
 }
 
-bool Gfx2DLoadFont(Gfx2DCanvas canvas, const char* font_path) {
-      return std::bit_cast<LoFi::PfxContext*>(canvas)->GenAndLoadFont(font_path);
+Gfx2DCanvas Gfx2DCreateSubCanvas(Gfx2DCanvas canvas, int32_t order) {
+      return std::bit_cast<Gfx2DCanvas>(std::bit_cast<LoFi::PfxRecorder*>(canvas)->GetCanvas()->CreateSubCanvas(order));
+}
+
+bool Gfx2DLoadFont(Gfx2DCanvas canvas, const char* font_path, Gfx2DEnumFontAtlasFormat format, const char* cache_directory) {
+      const VkFormat atlas_format = format == Gfx2DEnumFontAtlasFormat::RGBA16F ? VK_FORMAT_R16G16B16A16_SFLOAT : VK_FORMAT_R8G8B8A8_UNORM;
+      return std::bit_cast<LoFi::PfxRecorder*>(canvas)->GetCanvas()->GenAndLoadFont(font_path, atlas_format, cache_directory);
+}
+
+void Gfx2DPreloadGlyphs(Gfx2DCanvas canvas, const wchar_t* chars) {
+      std::bit_cast<LoFi::PfxRecorder*>(canvas)->GetCanvas()->PreloadGlyphs(chars);
+}
+
+GfxVec2 Gfx2DMeasureText(Gfx2DCanvas canvas, const wchar_t* text, Gfx2DParamText param) {
+      return std::bit_cast<GfxVec2>(std::bit_cast<LoFi::PfxRecorder*>(canvas)->GetCanvas()->MeasureText(text, std::bit_cast<LoFi::PParamText>(param)));
 }
 
 void Gfx2DCmdPushCanvasSize(Gfx2DCanvas canvas, uint16_t w, uint16_t h) {
-      return std::bit_cast<LoFi::PfxContext*>(canvas)->PushCanvasSize({w, h});
+      return std::bit_cast<LoFi::PfxRecorder*>(canvas)->PushCanvasSize({w, h});
 }
 
 void Gfx2DCmdPopCanvasSize(Gfx2DCanvas canvas) {
-      return std::bit_cast<LoFi::PfxContext*>(canvas)->PopCanvasSize();
+      return std::bit_cast<LoFi::PfxRecorder*>(canvas)->PopCanvasSize();
 }
 
 void Gfx2DCmdPushScissor(Gfx2DCanvas canvas, uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
-      return std::bit_cast<LoFi::PfxContext*>(canvas)->PushScissor({x, y, w, h});
+      return std::bit_cast<LoFi::PfxRecorder*>(canvas)->PushScissor({x, y, w, h});
 }
 
 void Gfx2DCmdPopScissor(Gfx2DCanvas canvas) {
-      return std::bit_cast<LoFi::PfxContext*>(canvas)->PopScissor();
+      return std::bit_cast<LoFi::PfxRecorder*>(canvas)->PopScissor();
 }
 
 void Gfx2DReset(Gfx2DCanvas canvas) {
-      return std::bit_cast<LoFi::PfxContext*>(canvas)->Reset();
+      return std::bit_cast<LoFi::PfxRecorder*>(canvas)->GetCanvas()->Reset();
+}
+
+GfxInfo2DCullStats Gfx2DGetCullStats(Gfx2DCanvas canvas) {
+      return std::bit_cast<GfxInfo2DCullStats>(std::bit_cast<LoFi::PfxRecorder*>(canvas)->GetCanvas()->GetCullStats());
+}
+
+Gfx2DDrawList Gfx2DCreateDrawList(Gfx2DCanvas canvas) {
+      return std::bit_cast<Gfx2DDrawList>(std::bit_cast<LoFi::PfxRecorder*>(canvas)->GetCanvas()->CreateDrawList());
+}
+
+void Gfx2DDestroyDrawList(Gfx2DCanvas canvas, Gfx2DDrawList list) {
+      return std::bit_cast<LoFi::PfxRecorder*>(canvas)->GetCanvas()->DestroyDrawList(std::bit_cast<LoFi::PfxDrawList*>(list));
+}
+
+void Gfx2DBeginDrawList(Gfx2DCanvas canvas, Gfx2DDrawList list) {
+      return std::bit_cast<LoFi::PfxRecorder*>(canvas)->BeginDrawList(std::bit_cast<LoFi::PfxDrawList*>(list));
+}
+
+void Gfx2DEndDrawList(Gfx2DCanvas canvas) {
+      return std::bit_cast<LoFi::PfxRecorder*>(canvas)->EndDrawList();
+}
+
+bool Gfx2DIsDrawListDirty(Gfx2DDrawList list) {
+      return std::bit_cast<LoFi::PfxDrawList*>(list)->IsDirty();
+}
+
+void Gfx2DMarkDrawListDirty(Gfx2DDrawList list) {
+      return std::bit_cast<LoFi::PfxDrawList*>(list)->MarkDirty();
+}
+
+void Gfx2DCmdDrawList(Gfx2DCanvas canvas, Gfx2DDrawList list, const Gfx2DParamReplayDrawList& param) {
+      return std::bit_cast<LoFi::PfxRecorder*>(canvas)->DrawList(std::bit_cast<LoFi::PfxDrawList*>(list), std::bit_cast<glm::vec2>(param.Offset),
+      std::bit_cast<glm::vec2>(param.Scale), std::bit_cast<glm::u8vec4>(param.Tint), {param.ClipX, param.ClipY, param.ClipW, param.ClipH});
 }
 
 void Gfx2DEmitDrawCommand(Gfx2DCanvas canvas, GfxRDGNodeCore nodec) {
-      return std::bit_cast<LoFi::PfxContext*>(canvas)->EmitDrawCommand(std::bit_cast<LoFi::RenderNode*>(nodec));
+      return std::bit_cast<LoFi::PfxRecorder*>(canvas)->GetCanvas()->EmitDrawCommand(std::bit_cast<LoFi::RenderNode*>(nodec));
 }
 
 void Gfx2DDispatchGenerateCommands(Gfx2DCanvas canvas) {
-      return std::bit_cast<LoFi::PfxContext*>(canvas)->DispatchGenerateCommands();
+      return std::bit_cast<LoFi::PfxRecorder*>(canvas)->GetCanvas()->DispatchGenerateCommands();
 }
 
 void Gfx2DCmdPushStrock(Gfx2DCanvas canvas, const Gfx2DParamStrockType& strock_parameter) {
-      return std::bit_cast<LoFi::PfxContext*>(canvas)->PushStrock(std::bit_cast<LoFi::StrockTypeParameter>(strock_parameter));
+      return std::bit_cast<LoFi::PfxRecorder*>(canvas)->PushStrock(std::bit_cast<LoFi::StrockTypeParameter>(strock_parameter));
 }
 
 void Gfx2DCmdPopStrock(Gfx2DCanvas canvas) {
-      return std::bit_cast<LoFi::PfxContext*>(canvas)->PopStrock();
+      return std::bit_cast<LoFi::PfxRecorder*>(canvas)->PopStrock();
 }
 
 void Gfx2DCmdDrawBox(Gfx2DCanvas canvas, GfxVec2 start, Gfx2DParamBox param, float rotation, GfxColor color) {
-      return std::bit_cast<LoFi::PfxContext*>(canvas)->DrawBox(std::bit_cast<glm::vec2>(start), std::bit_cast<LoFi::PParamBox>(param), rotation,
+      return std::bit_cast<LoFi::PfxRecorder*>(canvas)->DrawBox(std::bit_cast<glm::vec2>(start), std::bit_cast<LoFi::PParamBox>(param), rotation,
       std::bit_cast<glm::u8vec4>(color));
 }
 
 void Gfx2DCmdDrawRoundBox(Gfx2DCanvas canvas, GfxVec2 start, Gfx2DParamRoundBox param, float rotation, GfxColor color) {
-      return std::bit_cast<LoFi::PfxContext*>(canvas)->DrawRoundBox(std::bit_cast<glm::vec2>(start),
+      return std::bit_cast<LoFi::PfxRecorder*>(canvas)->DrawRoundBox(std::bit_cast<glm::vec2>(start),
       std::bit_cast<LoFi::PParamRoundBox>(param), rotation, std::bit_cast<glm::u8vec4>(color));
 }
 
 void Gfx2DCmdDrawNGon(Gfx2DCanvas canvas, GfxVec2 center, Gfx2DParamRoundNGon param, float rotation, GfxColor color) {
-      return std::bit_cast<LoFi::PfxContext*>(canvas)->DrawNGon(std::bit_cast<glm::vec2>(center), std::bit_cast<LoFi::PParamRoundNGon>(param), rotation,
+      return std::bit_cast<LoFi::PfxRecorder*>(canvas)->DrawNGon(std::bit_cast<glm::vec2>(center), std::bit_cast<LoFi::PParamRoundNGon>(param), rotation,
       std::bit_cast<glm::u8vec4>(color));
 }
 
 void Gfx2DCmdDrawCircle(Gfx2DCanvas canvas, GfxVec2 center, Gfx2DParamCircle param, float rotation, GfxColor color) {
-      return std::bit_cast<LoFi::PfxContext*>(canvas)->DrawCircle(std::bit_cast<glm::vec2>(center), std::bit_cast<LoFi::PParamCircle>(param), rotation,
+      return std::bit_cast<LoFi::PfxRecorder*>(canvas)->DrawCircle(std::bit_cast<glm::vec2>(center), std::bit_cast<LoFi::PParamCircle>(param), rotation,
       std::bit_cast<glm::u8vec4>(color));
 }
 
 void Gfx2DCmdDrawText(Gfx2DCanvas canvas, GfxVec2 start, const wchar_t* text, Gfx2DParamText param, GfxColor color) {
-      return std::bit_cast<LoFi::PfxContext*>(canvas)->DrawText(std::bit_cast<glm::vec2>(start), text, std::bit_cast<LoFi::PParamText>(param),
+      return std::bit_cast<LoFi::PfxRecorder*>(canvas)->DrawText(std::bit_cast<glm::vec2>(start), text, std::bit_cast<LoFi::PParamText>(param),
       std::bit_cast<glm::u8vec4>(color));
 }
+
+GfxAssetPack GfxOpenAssetPack(const char* file_path) {
+      return global_gfx->OpenAssetPack(file_path);
+}
+
+void GfxCloseAssetPack(GfxAssetPack pack) {
+      return global_gfx->CloseAssetPack(pack);
+}
+
+GfxHandle GfxCreateTexture2DFromPack(GfxAssetPack pack, const char* entry_name, const GfxParamCreateTexture2D& param) {
+      return std::bit_cast<GfxHandle>(global_gfx->CreateTexture2DFromPack(pack, entry_name, param));
+}
+
+GfxHandle GfxCreateProgramFromPack(GfxAssetPack pack, const char* entry_name, const char* resource_name) {
+      return std::bit_cast<GfxHandle>(global_gfx->CreateProgramFromPack(pack, entry_name, resource_name));
+}
+
+const void* GfxGetAssetPackData(GfxAssetPack pack, const char* entry_name, size_t* size) {
+      return global_gfx->GetAssetPackData(pack, entry_name, size);
+}
+
+GfxAssetPackWriter GfxCreateAssetPackWriter() {
+      return std::bit_cast<GfxAssetPackWriter>(new LoFi::Internal::AssetPackWriter());
+}
+
+void GfxDestroyAssetPackWriter(GfxAssetPackWriter writer) {
+      delete std::bit_cast<LoFi::Internal::AssetPackWriter*>(writer);
+}
+
+bool GfxAssetPackWriterAddRaw(GfxAssetPackWriter writer, const char* entry_name, const void* data, size_t size) {
+      return std::bit_cast<LoFi::Internal::AssetPackWriter*>(writer)->AddRaw(entry_name, data, size);
+}
+
+bool GfxAssetPackWriterAddTexture2D(GfxAssetPackWriter writer, const char* entry_name, GfxEnumFormat format, uint32_t w, uint32_t h, uint32_t mip_levels, const void* data, size_t size) {
+      return std::bit_cast<LoFi::Internal::AssetPackWriter*>(writer)->AddTexture(entry_name, (VkFormat)format, w, h, mip_levels, data, size);
+}
+
+bool GfxAssetPackWriterAddTexture2DFromFile(GfxAssetPackWriter writer, const char* entry_name, const char* file_path) {
+      return std::bit_cast<LoFi::Internal::AssetPackWriter*>(writer)->AddTextureFromFile(entry_name, file_path);
+}
+
+bool GfxAssetPackWriterAddProgramFromFile(GfxAssetPackWriter writer, const char* entry_name, const GfxParamCreateProgramFromFile& param) {
+      std::vector<std::string_view> files{};
+      for (size_t i = 0; i < param.countSourceCodeFileName; i++) {
+            files.emplace_back(param.pSourceCodeFileNames[i]);
+      }
+      return std::bit_cast<LoFi::Internal::AssetPackWriter*>(writer)->AddProgramFromFile(entry_name, param.pConfig ? param.pConfig : "", files);
+}
+
+bool GfxAssetPackWriterSave(GfxAssetPackWriter writer, const char* file_path) {
+      return std::bit_cast<LoFi::Internal::AssetPackWriter*>(writer)->Save(file_path);
+}
@@ -2,10 +2,7 @@
 // Created by Arzuo on 2024/7/9.
 //
 
-#include <codecvt>
-#include <fstream>
-#include <future>
-#include <sstream>
+#include <algorithm>
 #include <cwctype>
 
 #include "PfxContext.h"
@@ -14,57 +11,155 @@
 #include "../Third/msdfgen/msdfgen.h"
 #include "../Third/msdfgen/msdfgen-ext.h"
 #include "GfxComponents/Buffer.h"
+#include "taskflow/taskflow.hpp"
 
 using namespace LoFi;
 
+PfxFrameStream::~PfxFrameStream() {
+      if (!_gfx) return;
+      for (auto& buffer : _buffers) {
+            _gfx->DestroyHandle(buffer);
+      }
+}
+
+void PfxFrameStream::Init(GfxContext* gfx, const char* name, uint64_t capacity) {
+      _gfx = gfx;
+      for (auto& buffer : _buffers) {
+            buffer = _gfx->CreateBuffer({.pResourceName = name, .DataSize = capacity, .bCpuAccess = true});
+      }
+}
+
+void PfxFrameStream::InitHost(uint64_t capacity) {
+      _hostStorage.resize(capacity);
+      _mapped = _hostStorage.data();
+      _capacity = capacity;
+}
+
+void PfxFrameStream::BeginFrame(uint32_t frame_index) {
+      _frameIndex = frame_index;
+      _head = 0;
+
+      // the slot has retired before the frame is handed out again, writing from the start is safe.
+      // entt may move the component, keep only the mapping between calls
+      const auto ptr = _gfx->ResourceFetch<Component::Gfx::Buffer>(_buffers[_frameIndex]);
+      _mapped = (uint8_t*)ptr->Map();
+      _capacity = _mapped ? ptr->GetCapacity() : 0;
+      _address = ptr->GetBDAAddress();
+}
+
+void PfxFrameStream::Grow(uint64_t required) {
+      if (!_gfx) {
+            _hostStorage.resize(std::max(_capacity * 2, required));
+            _mapped = _hostStorage.data();
+            _capacity = _hostStorage.size();
+            return;
+      }
+
+      const auto ptr = _gfx->ResourceFetch<Component::Gfx::Buffer>(_buffers[_frameIndex]);
+      const uint64_t new_capacity = std::max(_capacity * 2, required);
+
+      // recreate drops the old memory, carry what was already recorded this frame over
+      std::vector<uint8_t> recorded(_mapped, _mapped + _head);
+      if (!ptr->Recreate(new_capacity) || (_mapped = (uint8_t*)ptr->Map()) == nullptr) {
+            const auto err = std::format("[PfxFrameStream::Grow] Can't Grow Stream Buffer To {} Bytes - Name: \"{}\"", new_capacity, ptr->GetResourceName());
+            MessageManager::Log(MessageType::Fatal, err);
+            throw std::runtime_error(err);
+      }
+      memcpy(_mapped, recorded.data(), recorded.size());
+
+      _capacity = ptr->GetCapacity();
+      _address = ptr->GetBDAAddress();
+}
+
+void PfxFrameStream::Flush() const {
+      if (_head == 0 || !_gfx) return;
+      _gfx->ResourceFetch<Component::Gfx::Buffer>(_buffers[_frameIndex])->Flush(0, _head);
+}
+
+PfxDrawList::PfxDrawList(GfxContext* gfx) : _gfx(gfx) {
+      _records.Vertex.InitHost(1024);
+      _records.Index.InitHost(1024);
+      _records.Instance.InitHost(1024);
+      _records.Indirect.InitHost(256);
+      _records.Gradient.InitHost(256);
+
+      _bufferVertex = _gfx->CreateBuffer({.pResourceName = "Pfx DrawList Vertex Buffer", .DataSize = 1024});
+      _bufferIndex = _gfx->CreateBuffer({.pResourceName = "Pfx DrawList Index Buffer", .DataSize = 1024});
+      _bufferInstance = _gfx->CreateBuffer({.pResourceName = "Pfx DrawList Instance Buffer", .DataSize = 1024});
+      _bufferIndirect = _gfx->CreateBuffer({.pResourceName = "Pfx DrawList Indirect Buffer", .DataSize = 256});
+      _bufferGradient = _gfx->CreateBuffer({.pResourceName = "Pfx DrawList Gradient Buffer", .DataSize = 256});
+}
+
+PfxDrawList::~PfxDrawList() {
+      _gfx->DestroyHandle(_bufferVertex);
+      _gfx->DestroyHandle(_bufferIndex);
+      _gfx->DestroyHandle(_bufferInstance);
+      _gfx->DestroyHandle(_bufferIndirect);
+      _gfx->DestroyHandle(_bufferGradient);
+}
+
+bool PfxDrawList::HasText() const {
+      return std::ranges::any_of(_records.Batches, [](const PfxDrawBatch& batch) { return batch.Type == PfxDrawBatchType::Text; });
+}
+
+void PfxDrawList::BeginRecord() {
+      _bPendingGlyphs = false;
+      _records.Vertex.Clear();
+      _records.Index.Clear();
+      _records.Instance.Clear();
+      _records.Indirect.Clear();
+      _records.Gradient.Clear();
+      _records.Batches.clear();
+      _records.SampledImages.clear();
+      _glyphs.clear();
+}
+
+void PfxDrawList::EndRecord() {
+      std::ranges::sort(_glyphs);
+      _glyphs.erase(std::ranges::unique(_glyphs).begin(), _glyphs.end());
+
+      // device buffers, the copy is staged before the next frame's commands run
+      const auto upload = [&](ResourceHandle buffer, const PfxFrameStream& stream) {
+            if (!stream.Empty()) _gfx->SetBuffer(buffer, stream.GetData(), stream.GetUsedBytes());
+      };
+      upload(_bufferVertex, _records.Vertex);
+      upload(_bufferIndex, _records.Index);
+      upload(_bufferInstance, _records.Instance);
+      upload(_bufferIndirect, _records.Indirect);
+      upload(_bufferGradient, _records.Gradient);
+
+      _gradientAddress = _gfx->GetBufferBindlessAddress(_bufferGradient);
+      _bDirty = false;
+}
+
 PfxContext::~PfxContext() {
-      for (int i = 0; i < 3; i++) {
-            _gfx->DestroyHandle(_bufferVertex[i]);
-            _gfx->DestroyHandle(_bufferIndex[i]);
-            _gfx->DestroyHandle(_bufferInstance[i]);
-            _gfx->DestroyHandle(_bufferIndirect[i]);
-            _gfx->DestroyHandle(_bufferGradient[i]);
+      for (auto list : _drawLists) {
+            delete list;
       }
 }
 
-PfxContext::PfxContext() {
+PfxContext::PfxContext() : _recorder(this, &_frameTarget) {
       if (GfxContext::Get() == nullptr) {
             const auto err = "GfxContext Should be Init first before PtxContext";
             MessageManager::Log(MessageType::Error, err);
             throw std::runtime_error(err);
       }
       _gfx = GfxContext::Get();
-      if (_instance != nullptr) {
-            const auto err = "PfxContext Should be Init only once";
-            MessageManager::Log(MessageType::Error, err);
-            throw std::runtime_error(err);
-      }
-      _instance = this;
-
-      _fontDOT.insert(L',');
-      _fontDOT.insert(L'.');
-      _fontDOT.insert(L'_');
-
 
-      for (int i = 0; i < 3; i++) {
-            _bufferVertex[i] = _gfx->CreateBuffer({.pResourceName = "Pfx Vertex Buffer", .DataSize = 8192, .bCpuAccess = true});
-            _bufferIndex[i] = _gfx->CreateBuffer({.pResourceName = "Pfx Index Buffer", .DataSize = 8192, .bCpuAccess = true});
+      _frameTarget.Vertex.Init(_gfx, "Pfx Vertex Buffer", 8192);
+      _frameTarget.Index.Init(_gfx, "Pfx Index Buffer", 8192);
 
-            _bufferInstance[i] = _gfx->CreateBuffer({.pResourceName = "Pfx Instance Buffer", .DataSize = 8192, .bCpuAccess = true});
-            _bufferIndirect[i] = _gfx->CreateBuffer({.pResourceName = "Pfx Indirect Buffer", .DataSize = 8192, .bCpuAccess = true});
+      _frameTarget.Instance.Init(_gfx, "Pfx Instance Buffer", 8192);
+      _frameTarget.Indirect.Init(_gfx, "Pfx Indirect Buffer", 8192);
 
-            _bufferGradient[i] = _gfx->CreateBuffer({.pResourceName = "Pfx Gradient Buffer", .DataSize = 8192, .bCpuAccess = true});
-      }
+      _frameTarget.Gradient.Init(_gfx, "Pfx Gradient Buffer", 8192);
 
-      const auto draw_config = R"(
+      const std::string instance_config = R"(
             #set rt = r8g8b8a8_unorm
             #set color_blend = src_alpha
             #set cull_mode = none
             //#set polygon_mode = line
 
-            #set vs_location = 0 0 r32g32_sfloat 0
-            #set vs_location = 0 1 r32g32_sfloat 8
-
             #set vs_location = 1 2 r32g32_uint 0
             #set vs_location = 1 3 r32_uint 8
             #set vs_location = 1 4 r32_uint 12
@@ -76,10 +171,17 @@ PfxContext::PfxContext() {
             #set vs_location = 1 10 r32g32b32a32_sfloat 40
             #set vs_location = 1 11 r32g32b32a32_sfloat 56
 
-            #set vs_binding = 0 16 vertex
             #set vs_binding = 1 72 instance
       )";
 
+      // text quads carry their own positions and atlas UVs
+      const std::string draw_config = instance_config + R"(
+            #set vs_location = 0 0 r32g32_sfloat 0
+            #set vs_location = 0 1 r32g32_sfloat 8
+
+            #set vs_binding = 0 16 vertex
+      )";
+
       const char* fs = R"(
             #extension GL_EXT_nonuniform_qualifier : enable
             #extension GL_EXT_buffer_reference : enable
@@ -131,6 +233,11 @@ PfxContext::PfxContext() {
 
             layout(push_constant) uniform InfosType {
                 PtrGradientBufferArray gradientArray;
+                vec2 ReplayOffset;
+                vec2 ReplayScale;
+                uint ReplayTint;
+                uint ReplayClipStart;
+                uint ReplayClipSize;
             } Infos;
 
             vec4 UnpackUintToColor(uint packed){
@@ -218,6 +325,14 @@ PfxContext::PfxContext() {
                     discard;
                 }
 
+                //recorded scissors are in list space, the replay clip is in canvas space
+                vec2 replayPos = in_PosAfterTransform * Infos.ReplayScale + Infos.ReplayOffset;
+                vec2 clipStart = UnpackUintToVec2(Infos.ReplayClipStart);
+                vec2 clipSize = UnpackUintToVec2(Infos.ReplayClipSize);
+                if(replayPos.x < clipStart.x || replayPos.x > clipStart.x + clipSize.x || replayPos.y < clipStart.y || replayPos.y > clipStart.y + clipSize.y) {
+                    discard;
+                }
+
                 uint StrockType;
                 uint PrimitiveType;
                 UnpackUintTo16(in_StrockType_PrimitiveType, StrockType, PrimitiveType);
@@ -492,19 +607,18 @@ PfxContext::PfxContext() {
 
                     outColor = finalColor * vec4(1.0f, 1.0f, 1.0f, d2);
                 }
+
+                outColor *= UnpackUintToColor(Infos.ReplayTint);
             }
 
       )";
 
-      const char* vs = R"(
+      const char* vs_common = R"(
             #extension GL_EXT_nonuniform_qualifier : enable
             #extension GL_EXT_buffer_reference : enable
             #extension GL_EXT_scalar_block_layout : enable
             #extension GL_EXT_buffer_reference2 : enable
 
-            layout(location = 0) in vec2 in_Pos;
-            layout(location = 1) in vec2 UV;
-
             layout(location = 2) in uvec2 Scissor;
             layout(location = 3) in uint CanvasSize;
             layout(location = 4) in uint Size;
@@ -559,6 +673,11 @@ PfxContext::PfxContext() {
 
             layout(push_constant) uniform InfosType {
                 PtrGradientBufferArray gradientArray;
+                vec2 ReplayOffset;
+                vec2 ReplayScale;
+                uint ReplayTint;
+                uint ReplayClipStart;
+                uint ReplayClipSize;
             } Infos;
 
             vec2 UnpackUintToVec2(uint packed) {
@@ -582,14 +701,12 @@ PfxContext::PfxContext() {
             }
 
 
-            void VSMain() {
-
-                    vec2 OriginPos = in_Pos;
+            void EmitQuadVertex(vec2 OriginPos, vec2 QuadUV) {
                     vec2 canvasSize = UnpackUintToVec2(CanvasSize);
 
                     //Canvas Size to -1.0 ~ 1.0
                     out_OriginPos = OriginPos;
-                    out_UV = UV;
+                    out_UV = QuadUV;
                     out_GlobalUV = OriginPos / canvasSize;
 
                     float rotate_rad = radians(CenterRotate);
@@ -598,7 +715,10 @@ PfxContext::PfxContext() {
 
                     out_PosAfterTransform = pos_center_rotated;
 
-                    out_NDCPos = (pos_center_rotated / canvasSize) * 2.0f - 1.0f;
+                    //draw list replay transform, identity for immediate draws
+                    vec2 pos_replayed = pos_center_rotated * Infos.ReplayScale + Infos.ReplayOffset;
+
+                    out_NDCPos = (pos_replayed / canvasSize) * 2.0f - 1.0f;
 
                     //rotate at center
 
@@ -622,8 +742,30 @@ PfxContext::PfxContext() {
 
       )";
 
+      const char* vs_text = R"(
+            layout(location = 0) in vec2 in_Pos;
+            layout(location = 1) in vec2 in_UV;
+
+            void VSMain() {
+                    EmitQuadVertex(in_Pos, in_UV);
+            }
+      )";
+
+      // SDF primitives: no vertex buffer, the quad is Center +- Size / 2 of the instance
+      const char* vs_sdf = R"(
+            const vec2 QuadCorners[6] = vec2[6](vec2(0, 1), vec2(1, 1), vec2(0, 0), vec2(0, 0), vec2(1, 1), vec2(1, 0));
+
+            void VSMain() {
+                    vec2 corner = QuadCorners[gl_VertexIndex];
+                    EmitQuadVertex(Center + (corner - 0.5f) * UnpackUintToVec2(Size), corner);
+            }
+      )";
 
-      const char* path[2] = {vs, fs};
+
+      const std::string vs_text_source = std::string(vs_common) + vs_text;
+      const std::string vs_sdf_source = std::string(vs_common) + vs_sdf;
+      const char* path[2] = {vs_text_source.c_str(), fs};
+      const char* path_sdf[2] = {vs_sdf_source.c_str(), fs};
 
       // _programDraw = _gfx->CreateProgramFromFile({
       //       .pResourceName = "PfxContext-Draw-Program",
@@ -633,7 +775,7 @@ PfxContext::PfxContext() {
       // });
       _programDraw = _gfx->CreateProgram({
             .pResourceName = "PfxContext-Draw-Program",
-            .pConfig = draw_config,
+            .pConfig = draw_config.c_str(),
             .pSourceCodes = path,
             .countSourceCode = 2
       });
@@ -644,6 +786,23 @@ PfxContext::PfxContext() {
             MessageManager::Log(MessageType::Error, err);
             throw std::runtime_error(err);
       }
+
+      _programDrawSDF = _gfx->CreateProgram({
+            .pResourceName = "PfxContext-DrawSDF-Program",
+            .pConfig = instance_config.c_str(),
+            .pSourceCodes = path_sdf,
+            .countSourceCode = 2
+      });
+
+      _kernelDrawSDF = _gfx->CreateKernel(_programDrawSDF, {.pResourceName = "PfxContext-DrawSDF-Kernel"});
+      if (_kernelDrawSDF.Type != GfxEnumResourceType::Kernel) {
+            const auto err = "[PfxContext::PfxContext] Can't Create SDF Draw Kernel";
+            MessageManager::Log(MessageType::Error, err);
+            throw std::runtime_error(err);
+      }
+
+      _layoutDraw = _gfx->GetKernelLayout(_kernelDraw);
+      _layoutDrawSDF = _gfx->GetKernelLayout(_kernelDrawSDF);
       Reset();
 }
 
@@ -655,283 +814,463 @@ static float PixelByteToFloat(uint8_t x) {
       return 1.f / 255.f * static_cast<float>(x);
 }
 
-bool PfxContext::GenAndLoadFont(const char* path) {
-      if (msdfgen::FreetypeHandle* ft = msdfgen::initializeFreetype()) {
-            if (msdfgen::FontHandle* font = msdfgen::loadFont(ft, path); font) {
-                  const auto font_dataset_path = "f.txt";
-                  std::locale locale(std::locale::classic(), new std::codecvt_utf8<wchar_t>);
-                  std::wifstream file(font_dataset_path);
-
-                  if (file.is_open()) {
-                        file.imbue(locale);
-                        std::wstringstream fs{};
-                        while (fs << file.rdbuf()) {}
-                        file.close();
-
-                        std::wstring font_table = fs.str();
-
-                        msdfgen::Bitmap<float, 4> bitmap(3200, 3200);
-
-                        constexpr auto split = 250;
-                        uint32_t threads = font_table.size() / split;
-
-                        std::vector<std::future<void>> handles{};
-                        printf("Star Gen %d th", threads);
-
-                        std::vector<msdfgen::Shape> shapes{};
-
-                        double global_size = 99999.0f;
-                        double total_bottom_offset = 99999.0f;
-                        for (int32_t i = 0; i < font_table.size(); i++) {
-                              msdfgen::Shape shape{};
-                              msdfgen::loadGlyph(shape, font, font_table[i], msdfgen::FONT_SCALING_LEGACY);
-                              msdfgen::edgeColoringSimple(shape, 3.0);
-                              shape.normalize();
-                              auto bounds = shape.getBounds();
-
-                              uint32_t x = i % 100;
-                              uint32_t y = i / 100;
-
-                              uint32_t start_pixel_x = x * 32;
-                              uint32_t start_pixel_y = y * 32;
-
-                              //printf("Bound %f %f %f %f\n", bounds.l, bounds.b, bounds.r, bounds.t);
-
-                              float pixel_uvx = (float)start_pixel_x / 3200.0f;
-                              float pixel_uvy = (float)start_pixel_y / 3200.0f;
-                              float pixel_uvw = 32.0f / 3200.0f;
-                              float pixel_uvh = 32.0f / 3200.0f;
-                              if (_fontDOT.contains(font_table[i])) {
-                                    pixel_uvw = 16.0f / 3200.0f;
-                                    pixel_uvh = 16.0f / 3200.0f;
-                              } else if (std::isalpha(font_table[i]) || std::isdigit(font_table[i]) || std::isspace(font_table[i]) || std::ispunct(font_table[i])) {
-                                    pixel_uvw = 16.0f / 3200.0f;
-                              }
-
-                              _fontUVs[font_table[i]] = {pixel_uvx, pixel_uvy, pixel_uvw, pixel_uvh};
-
-
-                              msdfgen::Vector2 frame(32, 32);
-
-                              msdfgen::Range pxRange(4);
-                              frame += 2 * pxRange.lower;
-                              msdfgen::Vector2 dims(bounds.r - bounds.l, bounds.t - bounds.b);
-                              if (bounds.l >= bounds.r || bounds.b >= bounds.t)
-                                    bounds.l = 0, bounds.b = 0, bounds.r = 1, bounds.t = 1;
-
-                              total_bottom_offset = glm::min(total_bottom_offset, bounds.b);
-
-                              if (dims.x * frame.y < dims.y * frame.x) {
-                                    if (frame.y / dims.y >= 0.0001) {
-                                          global_size = glm::min(global_size, frame.y / dims.y);
-                                          printf("Global %lf, Bound %lf %lf %lf %lf, size %lf ;\n", global_size, bounds.l, bounds.b, bounds.r, bounds.t, frame.y / dims.y);
-                                    }
-                              } else {
-                                    if (frame.x / dims.x >= 0.0001) {
-                                          global_size = glm::min(global_size, frame.x / dims.x);
-                                          printf("Global %lf, Bound %lf %lf %lf %lf, size %lf ;\n", global_size, bounds.l, bounds.b, bounds.r, bounds.t, frame.x / dims.x);
-                                    }
-                              }
-                              shapes.emplace_back(std::move(shape));
-                        }
+// a worker's own face over the shared font bytes, and a cell bitmap per glyph class reused by every glyph it generates
+struct LoFi::PfxGlyphScratch {
+      msdfgen::FreetypeHandle* Freetype{};
+      msdfgen::FontHandle* Font{};
+      msdfgen::Bitmap<float, 4> Cells[3]{};
+
+      explicit PfxGlyphScratch(const std::vector<uint8_t>& font_data) {
+            Freetype = msdfgen::initializeFreetype();
+            if (Freetype) Font = msdfgen::loadFontData(Freetype, font_data.data(), (int)font_data.size());
+            for (uint32_t i = 0; i < 3; i++) {
+                  const auto extent = PfxGlyphAtlas::GetCellExtent((PfxGlyphClass)i);
+                  Cells[i] = msdfgen::Bitmap<float, 4>(extent.x, extent.y);
+            }
+      }
 
-                        for (int32_t th = 0; th < threads; th++) {
-                              uint32_t g_start_i = th * split;
-                              uint32_t g_end_i = (th + 1) * split;
-                              handles.emplace_back(std::async([&](uint32_t start_i, uint32_t end_i) {
-                                    msdfgen::Bitmap<float, 4> MTSDF(32, 32);
-                                    msdfgen::Bitmap<float, 4> MTSDF_ASCII(16, 32);
-                                    msdfgen::Bitmap<float, 4> MTSDF_Dot(16, 16);
-                                    for (uint32_t i = start_i; i < end_i; i++) {
-                                          uint32_t x = i % 100;
-                                          uint32_t y = i / 100;
-
-                                          uint32_t start_pixel_x = x * 32;
-                                          uint32_t start_pixel_y = y * 32;
-
-                                          msdfgen::Vector2 frame(0, 0);
-                                          if (_fontDOT.contains(font_table[i])) {
-                                                frame = msdfgen::Vector2(10, 10);
-                                          } else if (std::isalpha(font_table[i]) || std::isdigit(font_table[i]) || std::isspace(font_table[i]) || std::ispunct(font_table[i])) {
-                                                frame = msdfgen::Vector2(16, 32);
-                                          } else {
-                                                frame = msdfgen::Vector2(32, 32);
-                                          }
-
-                                          msdfgen::Shape& shape = shapes[i];
-                                          auto bounds = shape.getBounds();
-                                          msdfgen::Range pxRange(4);
-                                          frame += 2 * pxRange.lower;
-                                          msdfgen::Vector2 translate;
-                                          msdfgen::Vector2 scale;
-                                          msdfgen::Vector2 dims(bounds.r - bounds.l, bounds.t - bounds.b);
-                                          if (bounds.l >= bounds.r || bounds.b >= bounds.t)
-                                                bounds.l = 0, bounds.b = 0, bounds.r = 1, bounds.t = 1;
-
-                                          if (dims.x * frame.y < dims.y * frame.x) {
-                                                translate.set(.5 * (frame.x / frame.y * dims.y - dims.x) - bounds.l, -total_bottom_offset); // -bounds.b
-                                                scale = global_size;
-                                          } else {
-                                                translate.set(-bounds.l, -total_bottom_offset); //5*(frame.y/frame.x*dims.x-dims.y)-bounds.b
-                                                scale = global_size;
-                                          }
-                                          translate -= pxRange.lower / scale;
-                                          msdfgen::Range range = pxRange / glm::min(scale.x, scale.y);
-                                          msdfgen::SDFTransformation ts(msdfgen::Projection(scale, translate), range);
-
-                                          if (_fontDOT.contains(font_table[i])) {
-                                                msdfgen::generateMTSDF(MTSDF_Dot, shape, ts);
-                                                for (int j = 0; j < 16; j++) {
-                                                      for (int k = 0; k < 16; k++) {
-                                                            bitmap((int)(start_pixel_x + j), (int)(start_pixel_y + k))[0] = MTSDF_Dot(j, k)[0];
-                                                            bitmap((int)(start_pixel_x + j), (int)(start_pixel_y + k))[1] = MTSDF_Dot(j, k)[1];
-                                                            bitmap((int)(start_pixel_x + j), (int)(start_pixel_y + k))[2] = MTSDF_Dot(j, k)[2];
-                                                            bitmap((int)(start_pixel_x + j), (int)(start_pixel_y + k))[3] = MTSDF_Dot(j, k)[3];
-                                                      }
-                                                }
-                                          } else if (std::isalpha(font_table[i]) || std::isdigit(font_table[i]) || std::isspace(font_table[i]) || std::ispunct(font_table[i])) {
-                                                msdfgen::generateMTSDF(MTSDF_ASCII, shape, ts);
-                                                for (int j = 0; j < 16; j++) {
-                                                      for (int k = 0; k < 32; k++) {
-                                                            bitmap((int)(start_pixel_x + j), (int)(start_pixel_y + k))[0] = MTSDF_ASCII(j, k)[0];
-                                                            bitmap((int)(start_pixel_x + j), (int)(start_pixel_y + k))[1] = MTSDF_ASCII(j, k)[1];
-                                                            bitmap((int)(start_pixel_x + j), (int)(start_pixel_y + k))[2] = MTSDF_ASCII(j, k)[2];
-                                                            bitmap((int)(start_pixel_x + j), (int)(start_pixel_y + k))[3] = MTSDF_ASCII(j, k)[3];
-                                                      }
-                                                }
-                                          } else {
-                                                msdfgen::generateMTSDF(MTSDF, shape, ts);
-                                                for (int j = 0; j < 32; j++) {
-                                                      for (int k = 0; k < 32; k++) {
-                                                            bitmap((int)(start_pixel_x + j), (int)(start_pixel_y + k))[0] = MTSDF(j, k)[0];
-                                                            bitmap((int)(start_pixel_x + j), (int)(start_pixel_y + k))[1] = MTSDF(j, k)[1];
-                                                            bitmap((int)(start_pixel_x + j), (int)(start_pixel_y + k))[2] = MTSDF(j, k)[2];
-                                                            bitmap((int)(start_pixel_x + j), (int)(start_pixel_y + k))[3] = MTSDF(j, k)[3];
-                                                      }
-                                                }
-                                          }
-                                    }
-                              }, g_start_i, g_end_i));
-                        }
+      ~PfxGlyphScratch() {
+            if (Font) msdfgen::destroyFont(Font);
+            if (Freetype) msdfgen::deinitializeFreetype(Freetype);
+      }
+};
 
-                        {
-                              uint32_t left = font_table.size() % split;
-
-                              msdfgen::Bitmap<float, 4> MTSDF(32, 32);
-                              msdfgen::Bitmap<float, 4> MTSDF_ASCII(16, 32);
-                              msdfgen::Bitmap<float, 4> MTSDF_Dot(16, 16);
-
-                              for (uint32_t i = threads * split; i < threads * split + left; i++) {
-                                    uint32_t x = i % 100;
-                                    uint32_t y = i / 100;
-
-                                    uint32_t start_pixel_x = x * 32;
-                                    uint32_t start_pixel_y = y * 32;
-
-                                    msdfgen::Vector2 frame;
-                                    if (_fontDOT.contains(font_table[i])) {
-                                          frame = msdfgen::Vector2(10, 10);
-                                    } else if (std::isalpha(font_table[i]) || std::isdigit(font_table[i]) || std::isspace(font_table[i]) || std::ispunct(font_table[i])) {
-                                          frame = msdfgen::Vector2(16, 32);
-                                    } else {
-                                          frame = msdfgen::Vector2(32, 32);
-                                    }
-
-                                    msdfgen::Shape& shape = shapes[i];
-                                    auto bounds = shape.getBounds();
-                                    msdfgen::Range pxRange(4);
-                                    frame += 2 * pxRange.lower;
-                                    msdfgen::Vector2 translate;
-                                    msdfgen::Vector2 scale;
-                                    msdfgen::Vector2 dims(bounds.r - bounds.l, bounds.t - bounds.b);
-
-                                    if (dims.x * frame.y < dims.y * frame.x) {
-                                          translate.set(.5 * (frame.x / frame.y * dims.y - dims.x) - bounds.l, -bounds.b);
-                                          scale = global_size; //frame.y/dims.y;
-                                    } else {
-                                          translate.set(-bounds.l, .5 * (frame.y / frame.x * dims.x - dims.y) - bounds.b);
-                                          scale = global_size; //frame.x/dims.x;
-                                    }
-
-                                    translate -= pxRange.lower / scale;
-                                    msdfgen::Range range = pxRange / glm::min(scale.x, scale.y);
-                                    msdfgen::SDFTransformation ts(msdfgen::Projection(scale, translate), range);
-
-                                    if (_fontDOT.contains(font_table[i])) {
-                                          msdfgen::generateMTSDF(MTSDF_Dot, shape, ts);
-                                          for (int j = 0; j < 16; j++) {
-                                                for (int k = 0; k < 16; k++) {
-                                                      bitmap((int)(start_pixel_x + j), (int)(start_pixel_y + k))[0] = MTSDF_Dot(j, k)[0];
-                                                      bitmap((int)(start_pixel_x + j), (int)(start_pixel_y + k))[1] = MTSDF_Dot(j, k)[1];
-                                                      bitmap((int)(start_pixel_x + j), (int)(start_pixel_y + k))[2] = MTSDF_Dot(j, k)[2];
-                                                      bitmap((int)(start_pixel_x + j), (int)(start_pixel_y + k))[3] = MTSDF_Dot(j, k)[3];
-                                                }
-                                          }
-                                    } else if (std::isalpha(font_table[i]) || std::isdigit(font_table[i]) || std::isspace(font_table[i]) || std::ispunct(font_table[i])) {
-                                          msdfgen::generateMTSDF(MTSDF_ASCII, shape, ts);
-                                          for (int j = 0; j < 16; j++) {
-                                                for (int k = 0; k < 32; k++) {
-                                                      bitmap((int)(start_pixel_x + j), (int)(start_pixel_y + k))[0] = MTSDF_ASCII(j, k)[0];
-                                                      bitmap((int)(start_pixel_x + j), (int)(start_pixel_y + k))[1] = MTSDF_ASCII(j, k)[1];
-                                                      bitmap((int)(start_pixel_x + j), (int)(start_pixel_y + k))[2] = MTSDF_ASCII(j, k)[2];
-                                                      bitmap((int)(start_pixel_x + j), (int)(start_pixel_y + k))[3] = MTSDF_ASCII(j, k)[3];
-                                                }
-                                          }
-                                    } else {
-                                          msdfgen::generateMTSDF(MTSDF, shape, ts);
-                                          for (int j = 0; j < 32; j++) {
-                                                for (int k = 0; k < 32; k++) {
-                                                      bitmap((int)(start_pixel_x + j), (int)(start_pixel_y + k))[0] = MTSDF(j, k)[0];
-                                                      bitmap((int)(start_pixel_x + j), (int)(start_pixel_y + k))[1] = MTSDF(j, k)[1];
-                                                      bitmap((int)(start_pixel_x + j), (int)(start_pixel_y + k))[2] = MTSDF(j, k)[2];
-                                                      bitmap((int)(start_pixel_x + j), (int)(start_pixel_y + k))[3] = MTSDF(j, k)[3];
-                                                }
-                                          }
-                                    }
-                              }
-                        }
+PfxGlyphAtlas::~PfxGlyphAtlas() {
+      //jobs still running read the font and push into this atlas
+      for (uint32_t jobs = _pendingJobs->load(); jobs != 0; jobs = _pendingJobs->load()) {
+            _pendingJobs->wait(jobs);
+      }
 
-                        for (auto& handle : handles) {
-                              handle.wait();
-                        }
+      _scratch.clear();
+      if (_font) msdfgen::destroyFont(_font);
+      if (_freetype) msdfgen::deinitializeFreetype(_freetype);
+      if (_gfx && _texture.Type != GfxEnumResourceType::INVALID_RESOURCE_TYPE) _gfx->DestroyHandle(_texture);
+}
+
+bool PfxGlyphAtlas::Init(GfxContext* gfx, const char* font_path, uint32_t page_size, VkFormat format, const std::filesystem::path& cache_directory) {
+      _gfx = gfx;
+      _pageSize = (uint16_t)page_size;
+      _format = format == VK_FORMAT_R16G16B16A16_SFLOAT ? format : VK_FORMAT_R8G8B8A8_UNORM;
+
+      //read once, the bytes feed both the cache key and freetype
+      {
+            std::ifstream file(font_path, std::ios::binary | std::ios::ate);
+            if (!file.is_open()) return false;
+            _fontData.resize((size_t)file.tellg());
+            file.seekg(0);
+            if (!file.read((char*)_fontData.data(), (std::streamsize)_fontData.size())) return false;
+      }
+
+      _freetype = msdfgen::initializeFreetype();
+      if (!_freetype) return false;
+
+      _font = msdfgen::loadFontData(_freetype, _fontData.data(), (int)_fontData.size());
+      if (!_font) return false;
+
+      //every glyph shares one scale, a full cell holds the whole line box inside the distance range margin
+      msdfgen::FontMetrics metrics{};
+      msdfgen::getFontMetrics(metrics, _font, msdfgen::FONT_SCALING_LEGACY);
+      const double line_box = metrics.ascenderY - metrics.descenderY;
+      _scale = line_box > 0.0 ? 28.0 / line_box : 1.0;
+      _baseline = metrics.descenderY;
+
+      const std::string tex_name = std::format("MTSDF Texture for FontAtlas-{}", font_path);
+      _texture = _gfx->CreateTexture2D(_format, page_size, page_size, {
+            .pResourceName = tex_name.c_str()
+      });
+      if (_texture.Type == GfxEnumResourceType::INVALID_RESOURCE_TYPE) return false;
+      _textureBindlessIndex = _gfx->GetTextureBindlessIndex(_texture);
+
+      _scratch.resize(_gfx->GetTaskExecutor()->num_workers());
+
+      //the first cell stays blank, glyphs still being generated sample it
+      const auto blank_extent = GetCellExtent(PfxGlyphClass::Dot);
+      glm::u16vec2 blank_cell{};
+      AllocateCell(blank_extent, blank_cell);
+      const std::vector<uint8_t> blank((size_t)blank_extent.x * blank_extent.y * GetTexelSize(), 0);
+      _gfx->SetTexture2DRegion(_texture, blank_cell.x, blank_cell.y, blank_extent.x, blank_extent.y, blank.data(), blank.size());
+      _blankUV = CellToUV(blank_cell, blank_extent);
+
+      if (!cache_directory.empty()) {
+            //generator constants are covered by PfxGlyphCacheVersion, the metrics follow from the font
+            const uint64_t key = XXH3_64bits_withSeed(_fontData.data(), _fontData.size(), (uint64_t)_format);
+            const auto file_name = std::format("{}-{:016x}.glyphs", std::filesystem::path(font_path).stem().string(), key);
+            OpenCache(cache_directory / file_name, key);
+
+            //every cached glyph is packed up front until the page is full, the rest land when drawn
+            for (const auto& [ch, offset] : _cacheIndex) {
+                  const auto bitmap = ReadCache(ch, offset);
+                  glm::u16vec2 cell{};
+                  if (!AllocateCell(GetCellExtent(bitmap.Class), cell)) break;
+                  Place(bitmap, cell);
+            }
+      }
+
+      return true;
+}
+
+void PfxGlyphAtlas::OpenCache(const std::filesystem::path& path, uint64_t key) {
+      std::error_code ec{};
+      std::filesystem::create_directories(path.parent_path(), ec);
+
+      {
+            std::ifstream file(path, std::ios::binary | std::ios::ate);
+            if (file.is_open()) {
+                  _cacheData.resize((size_t)file.tellg());
+                  file.seekg(0);
+                  if (!file.read((char*)_cacheData.data(), (std::streamsize)_cacheData.size())) _cacheData.clear();
+            }
+      }
+
+      PfxGlyphCacheHeader header{};
+      if (_cacheData.size() >= sizeof(header)) memcpy(&header, _cacheData.data(), sizeof(header));
+
+      size_t valid_size = 0;
+      if (header.Magic == PfxGlyphCacheMagic && header.Version == PfxGlyphCacheVersion && header.Key == key) {
+            valid_size = sizeof(header);
+            while (valid_size + sizeof(PfxGlyphCacheRecord) <= _cacheData.size()) {
+                  PfxGlyphCacheRecord record{};
+                  memcpy(&record, _cacheData.data() + valid_size, sizeof(record));
+                  if (record.Class > (uint32_t)PfxGlyphClass::Full) break;
+
+                  const auto extent = GetCellExtent((PfxGlyphClass)record.Class);
+                  const size_t record_size = sizeof(record) + (size_t)extent.x * extent.y * GetTexelSize();
+                  if (valid_size + record_size > _cacheData.size()) break; // torn by an interrupted run
+
+                  _cacheIndex[(wchar_t)record.Char] = valid_size;
+                  valid_size += record_size;
+            }
+      }
+
+      //a stale or damaged file is written again from what survived
+      const bool intact = valid_size != 0 && valid_size == _cacheData.size();
+      if (valid_size == 0) {
+            header = {PfxGlyphCacheMagic, PfxGlyphCacheVersion, key};
+            _cacheData.resize(sizeof(header));
+            memcpy(_cacheData.data(), &header, sizeof(header));
+      } else {
+            _cacheData.resize(valid_size);
+      }
+
+      _cacheFile.open(path, std::ios::binary | (intact ? std::ios::app : std::ios::trunc));
+      if (_cacheFile.is_open() && !intact) {
+            _cacheFile.write((const char*)_cacheData.data(), (std::streamsize)_cacheData.size());
+      }
+      if (!_cacheFile) {
+            const auto str = std::format("PfxGlyphAtlas::OpenCache - Can't write glyph cache \"{}\", generated glyphs won't be kept", path.string());
+            MessageManager::Log(MessageType::Warning, str);
+            _cacheFile.close();
+      }
+}
+
+void PfxGlyphAtlas::AppendCache(const PfxGlyphBitmap& bitmap) {
+      if (!_cacheFile.is_open() || _cacheIndex.contains(bitmap.Char)) return;
+
+      const PfxGlyphCacheRecord record{(uint32_t)bitmap.Char, (uint32_t)bitmap.Class};
+      const size_t offset = _cacheData.size();
+      _cacheData.resize(offset + sizeof(record) + bitmap.Texels.size());
+      memcpy(_cacheData.data() + offset, &record, sizeof(record));
+      memcpy(_cacheData.data() + offset + sizeof(record), bitmap.Texels.data(), bitmap.Texels.size());
+
+      _cacheFile.write((const char*)_cacheData.data() + offset, (std::streamsize)(sizeof(record) + bitmap.Texels.size()));
+      _cacheIndex[bitmap.Char] = offset;
+}
+
+PfxGlyphBitmap PfxGlyphAtlas::ReadCache(wchar_t ch, size_t offset) const {
+      PfxGlyphCacheRecord record{};
+      memcpy(&record, _cacheData.data() + offset, sizeof(record));
+
+      const auto glyph_class = (PfxGlyphClass)record.Class;
+      const auto extent = GetCellExtent(glyph_class);
+      const uint8_t* texels = _cacheData.data() + offset + sizeof(record);
+      return {ch, glyph_class, std::vector<uint8_t>(texels, texels + (size_t)extent.x * extent.y * GetTexelSize()), true};
+}
+
+PfxGlyphClass PfxGlyphAtlas::Classify(wchar_t ch) {
+      return PfxClassifyGlyph(ch);
+}
+
+const PfxGlyphMetrics& PfxGlyphAtlas::GetMetrics(PfxGlyphClass glyph_class) {
+      static const PfxGlyphMetrics metrics[3] = {
+            {{0.5f, 0.5f}, 0.5f}, // Dot
+            {{0.5f, 1.0f}, 0.5f}, // Narrow
+            {{1.0f, 1.0f}, 1.0f}, // Full
+      };
+      return metrics[(uint32_t)glyph_class];
+}
+
+void PfxGlyphAtlas::BuildLayout(std::wstring_view text, float size, float space, const FontUV* uvs, PfxTextLayout& layout) {
+      layout.Text = text;
+      layout.Size = size;
+      layout.Space = space;
+      layout.Vertices.resize(text.size() * 4);
+
+      GenDrawVertexData* vertex = layout.Vertices.data();
+      float pen = 0.0f;
+      for (size_t i = 0; i < text.size(); i++) {
+            const auto& metrics = GetMetrics(Classify(text[i]));
+            const glm::vec2 quad = metrics.Quad * size;
+            const FontUV& fuv = uvs[i];
+            *vertex++ = GenDrawVertexData(glm::vec2(pen, quad.y), glm::vec2(fuv.x, fuv.y + fuv.h));
+            *vertex++ = GenDrawVertexData(glm::vec2(pen + quad.x, quad.y), glm::vec2(fuv.x + fuv.w, fuv.y + fuv.h));
+            *vertex++ = GenDrawVertexData(glm::vec2(pen, 0), glm::vec2(fuv.x, fuv.y));
+            *vertex++ = GenDrawVertexData(glm::vec2(pen + quad.x, 0), glm::vec2(fuv.x + fuv.w, fuv.y));
+            pen += metrics.Advance * size + space;
+      }
+      layout.Advance = pen;
+}
+
+glm::u16vec2 PfxGlyphAtlas::GetCellExtent(PfxGlyphClass glyph_class) {
+      return PfxGetGlyphCellExtent(glyph_class);
+}
+
+FontUV PfxGlyphAtlas::CellToUV(glm::u16vec2 cell, glm::u16vec2 extent) const {
+      const float page = (float)_pageSize;
+      return {(float)cell.x / page, (float)cell.y / page, (float)extent.x / page, (float)extent.y / page};
+}
+
+std::shared_ptr<const PfxTextLayout> PfxGlyphAtlas::Layout(std::wstring_view text, float size, float space) {
+      const uint64_t frame = _gfx->GetCurrentFrameValue();
+      const float params[2] = {size, space};
+      const uint64_t key = XXH3_64bits_withSeed(text.data(), text.size() * sizeof(wchar_t), XXH3_64bits(params, sizeof(params)));
+
+      std::lock_guard lock(_mutex);
+      auto& cached = _layouts[key];
+      cached.LastUsedFrame = frame;
+      if (const auto& layout = cached.Layout; layout && cached.Evictions == _evictions && (layout->bResident || cached.Landings == _landings)
+          && layout->Size == size && layout->Space == space && layout->Text == text) {
+            return layout;
+      }
+
+      std::vector<FontUV> uvs(text.size());
+      auto layout = std::make_shared<PfxTextLayout>();
+      layout->bResident = Resolve(text, uvs.data(), frame);
+      BuildLayout(text, size, space, uvs.data(), *layout);
+
+      cached.Layout = std::move(layout);
+      cached.Evictions = _evictions;
+      cached.Landings = _landings;
+      return cached.Layout;
+}
+
+bool PfxGlyphAtlas::Resolve(std::wstring_view text, FontUV* out_uvs, uint64_t frame) {
+      bool resident = true;
+      for (size_t i = 0; i < text.size(); i++) {
+            auto [it, inserted] = _glyphs.try_emplace(text[i], Glyph{.UV = _blankUV, .Class = Classify(text[i])});
+            auto& glyph = it->second;
+            glyph.LastUsedFrame = frame;
+            out_uvs[i] = glyph.UV;
+            resident &= glyph.bResident;
+
+            if (inserted) Request(text[i]);
+      }
+      return resident;
+}
+
+void PfxGlyphAtlas::Touch(std::span<const wchar_t> chars, uint64_t frame) {
+      std::lock_guard lock(_mutex);
+      for (const wchar_t ch : chars) {
+            if (const auto glyph = _glyphs.find(ch); glyph != _glyphs.end()) {
+                  glyph->second.LastUsedFrame = glm::max(glyph->second.LastUsedFrame, frame);
+            }
+      }
+}
+
+void PfxGlyphAtlas::Preload(std::wstring_view chars) {
+      std::lock_guard lock(_mutex);
+      for (const wchar_t ch : chars) {
+            if (_glyphs.try_emplace(ch, Glyph{.UV = _blankUV, .Class = Classify(ch)}).second) Request(ch);
+      }
+}
+
+void PfxGlyphAtlas::Request(wchar_t ch) {
+      //cached glyphs skip the generator, they land on the next update all the same
+      if (const auto cached = _cacheIndex.find(ch); cached != _cacheIndex.end()) {
+            _queueGenerated.enqueue(ReadCache(cached->first, cached->second));
+            return;
+      }
+
+      //one task per glyph, idle workers steal from busy ones so a large charset spreads evenly
+      //the task holds its own reference to the counter and touches nothing of the atlas once it reached zero
+      _pendingJobs->fetch_add(1);
+      _gfx->GetTaskExecutor()->silent_async([this, ch, pending = _pendingJobs]() {
+            _queueGenerated.enqueue(Generate(ch));
+            if (pending->fetch_sub(1) == 1) pending->notify_all();
+      });
+}
+
+PfxGlyphScratch& PfxGlyphAtlas::GetScratch() const {
+      auto& scratch = _scratch.at(_gfx->GetTaskExecutor()->this_worker_id());
+      if (!scratch) scratch = std::make_unique<PfxGlyphScratch>(_fontData);
+      return *scratch;
+}
+
+PfxGlyphBitmap PfxGlyphAtlas::Generate(wchar_t ch) const {
+      const auto glyph_class = Classify(ch);
+      const auto extent = GetCellExtent(glyph_class);
+      PfxGlyphBitmap result{ch, glyph_class, std::vector<uint8_t>((size_t)extent.x * extent.y * GetTexelSize(), 0), false};
+
+      //quantized on the worker, straight into the atlas format
+      auto& scratch = GetScratch();
+      auto& mtsdf = scratch.Cells[(uint32_t)glyph_class];
+      if (PfxRasterizeGlyph(scratch.Font, ch, glyph_class, _scale, _baseline, (float*)mtsdf)) {
+            PfxQuantizeGlyph((const float*)mtsdf, (size_t)extent.x * extent.y * 4, _format == VK_FORMAT_R16G16B16A16_SFLOAT, result.Texels.data());
+      }
+      return result;
+}
+
+bool PfxGlyphAtlas::AllocateCell(glm::u16vec2 extent, glm::u16vec2& cell) {
+      for (auto& shelf : _shelves) {
+            if (shelf.Height == extent.y && shelf.Head + extent.x <= _pageSize) {
+                  cell = {shelf.Head, shelf.Y};
+                  shelf.Head += extent.x;
+                  return true;
+            }
+      }
+
+      if (_shelfTop + extent.y > _pageSize) return false;
+      _shelves.push_back({.Y = _shelfTop, .Height = extent.y, .Head = extent.x});
+      cell = {0, _shelfTop};
+      _shelfTop += extent.y;
+      return true;
+}
+
+bool PfxGlyphAtlas::EvictCell(PfxGlyphClass glyph_class, uint64_t completed_frame, glm::u16vec2& cell) {
+      auto victim = _glyphs.end();
+      for (auto it = _glyphs.begin(); it != _glyphs.end(); ++it) {
+            const auto& glyph = it->second;
+            if (!glyph.bResident || glyph.Class != glyph_class || glyph.LastUsedFrame > completed_frame) continue;
+            if (victim == _glyphs.end() || glyph.LastUsedFrame < victim->second.LastUsedFrame) victim = it;
+      }
+      if (victim == _glyphs.end()) return false;
+
+      cell = victim->second.Cell;
+      _glyphs.erase(victim);
+      return true;
+}
+
+PfxGlyphAtlasChanges PfxGlyphAtlas::Update() {
+      PfxGlyphAtlasChanges changes{};
+      const uint64_t completed_frame = _gfx->GetCompletedFrameValue();
+
+      std::lock_guard lock(_mutex);
 
-                        printf("Generate Done");
-                        msdfgen::BitmapConstRef<float, 4> ref = bitmap;
-                        stbi_write_hdr("D:\\out.hdr", ref.width, ref.height, 4, ref.pixels);
-                        printf("Start Uploading Font Altas %d Bytes\n", ref.width * ref.height * 3 * 4);
-                        std::string tex_name = std::format("MTSDF Texture for FontAtlas-{}", path);
-                        _fontAtlas = _gfx->CreateTexture2D(VK_FORMAT_R32G32B32A32_SFLOAT, ref.width, ref.height, {
-                              .pResourceName = tex_name.c_str()
-                        });
-                        if (!_gfx->SetTexture2D(_fontAtlas, ref.pixels, ref.width * ref.height * 4 * 4)) {
-                              const auto str = std::format("PfxContext::LoadFont - Can't Upload Font {}", path);
-                              MessageManager::Log(MessageType::Error, str);
-                              throw std::runtime_error(str);
+      //layout hits skip the glyph lookups, their glyphs count as drawn before anything is evicted
+      const uint64_t frame = _gfx->GetCurrentFrameValue();
+      std::vector<uint64_t> expired{};
+      for (const auto& [key, cached] : _layouts) {
+            if (cached.LastUsedFrame >= _lastUpdateFrame) {
+                  for (const wchar_t ch : cached.Layout->Text) {
+                        if (const auto glyph = _glyphs.find(ch); glyph != _glyphs.end()) {
+                              glyph->second.LastUsedFrame = glm::max(glyph->second.LastUsedFrame, cached.LastUsedFrame);
                         }
-                        _fontAtlasTextureBindlessIndex = _gfx->GetTextureBindlessIndex(_fontAtlas);
+                  }
+            } else if (cached.LastUsedFrame + PfxTextLayoutLifetime < frame) {
+                  expired.push_back(key);
+            }
+      }
+      for (const auto key : expired) {
+            _layouts.erase(key);
+      }
+      _lastUpdateFrame = frame;
+
+      PfxGlyphBitmap bitmap{};
+      bool appended = false;
+      while (_queueGenerated.try_dequeue(bitmap)) {
+            if (!bitmap.bCached) {
+                  AppendCache(bitmap);
+                  appended = true;
+            }
 
-                        _fontAtlasSize = VkExtent2D{(uint32_t)ref.width, (uint32_t)ref.height};
+            const auto it = _glyphs.find(bitmap.Char);
+            if (it == _glyphs.end()) continue;
+
+            const auto extent = GetCellExtent(bitmap.Class);
+            glm::u16vec2 cell{};
+            if (!AllocateCell(extent, cell)) {
+                  if (!EvictCell(bitmap.Class, completed_frame, cell)) {
+                        //every cell of this size is still sampled in flight, the next draw asks again
+                        _glyphs.erase(it);
+                        continue;
                   }
-                  msdfgen::destroyFont(font);
-            } else {
-                  const auto str = std::format("PfxContext::LoadFont - Can't Load Font {}", path);
-                  MessageManager::Log(MessageType::Error, str);
-                  return false;
+                  changes.bEvicted = true;
             }
-            msdfgen::deinitializeFreetype(ft);
+
+            Place(bitmap, cell);
+            changes.bLanded = true;
+      }
+
+      if (appended && _cacheFile.is_open()) _cacheFile.flush();
+
+      //evictions stale every layout, landings only those still waiting on glyphs
+      if (changes.bEvicted) _evictions++;
+      if (changes.bLanded) _landings++;
+      return changes;
+}
+
+void PfxGlyphAtlas::Place(const PfxGlyphBitmap& bitmap, glm::u16vec2 cell) {
+      const auto extent = GetCellExtent(bitmap.Class);
+      _gfx->SetTexture2DRegion(_texture, cell.x, cell.y, extent.x, extent.y, bitmap.Texels.data(), bitmap.Texels.size());
+
+      //looked up again, an eviction may have moved the entry
+      auto& glyph = _glyphs[bitmap.Char];
+      glyph.UV = CellToUV(cell, extent);
+      glyph.Cell = cell;
+      glyph.Class = bitmap.Class;
+      glyph.bResident = true;
+}
+
+void PfxContext::PreloadGlyphs(const wchar_t* chars) {
+      if (_glyphAtlas && chars) _glyphAtlas->Preload(chars);
+}
+
+glm::vec2 PfxContext::MeasureText(const wchar_t* text, PParamText param) {
+      const std::wstring_view wstr = text ? std::wstring_view(text) : std::wstring_view{};
+      if (wstr.empty()) return {0, 0};
+
+      //shares the layout DrawText will use, measuring then drawing a string resolves it once
+      float advance = 0.0f;
+      if (_glyphAtlas) {
+            advance = _glyphAtlas->Layout(wstr, param.Size, param.Space)->Advance;
+      } else {
+            for (const wchar_t ch : wstr) advance += PfxGlyphAtlas::GetMetrics(PfxGlyphAtlas::Classify(ch)).Advance * param.Size + param.Space;
       }
 
+      //the trailing spacing isn't part of the ink
+      return {advance - param.Space, param.Size};
+}
+
+bool PfxContext::GenAndLoadFont(const char* path, VkFormat atlas_format, const char* cache_directory) {
+      std::filesystem::path cache_path{};
+      if (cache_directory) {
+            cache_path = cache_directory;
+      } else {
+            std::error_code ec{};
+            if (const auto temp = std::filesystem::temp_directory_path(ec); !ec) cache_path = temp / "LoFiGfx" / "FontCache";
+      }
+
+      auto atlas = std::make_unique<PfxGlyphAtlas>();
+      if (!atlas->Init(_gfx, path, 2048, atlas_format, cache_path)) {
+            const auto str = std::format("PfxContext::LoadFont - Can't Load Font {}", path);
+            MessageManager::Log(MessageType::Error, str);
+            return false;
+      }
+      _glyphAtlas = std::move(atlas);
+
+      for (auto list : _drawLists) {
+            if (list->HasText()) list->MarkDirty();
+      }
       return true;
 }
 
-void PfxContext::PushCanvasSize(glm::u16vec2 size) {
+void PfxRecorder::PushCanvasSize(glm::u16vec2 size) {
       _canvasSizeStack.emplace_back(size);
       _currentCanvasSize = size;
 }
 
-void PfxContext::PopCanvasSize() {
+void PfxRecorder::PopCanvasSize() {
       if (_canvasSizeStack.size() <= 1) {
-            const auto warning = "PfxContext::PopCanvasSize - Can't Pop Root CanvasSize";
+            const auto warning = "PfxRecorder::PopCanvasSize - Can't Pop Root CanvasSize";
             MessageManager::Log(MessageType::Warning, warning);
             return;
       }
@@ -939,14 +1278,14 @@ void PfxContext::PopCanvasSize() {
       _currentCanvasSize = _canvasSizeStack.back();
 }
 
-void PfxContext::PushScissor(glm::u16vec4 xywh) {
+void PfxRecorder::PushScissor(glm::u16vec4 xywh) {
       _scissorStack.emplace_back(xywh);
       _currentScissor = xywh;
 }
 
-void PfxContext::PopScissor() {
+void PfxRecorder::PopScissor() {
       if (_scissorStack.size() <= 1) {
-            const auto warning = "PfxContext::PopScissor - Can't Pop Root Scissor";
+            const auto warning = "PfxRecorder::PopScissor - Can't Pop Root Scissor";
             MessageManager::Log(MessageType::Warning, warning);
             return;
       }
@@ -954,24 +1293,24 @@ void PfxContext::PopScissor() {
       _currentScissor = _scissorStack.back();
 }
 
-void PfxContext::PushShadow(const ShadowParameter& shadow_parameter) {
+void PfxRecorder::PushShadow(const ShadowParameter& shadow_parameter) {
       _shadowStack.push_back(shadow_parameter);
 }
 
-void PfxContext::PopShadow() {
+void PfxRecorder::PopShadow() {
       if (!_shadowStack.empty()) {
             _shadowStack.pop_back();
       }
 }
 
-void PfxContext::PushStrock(const StrockTypeParameter& strock_parameter) {
+void PfxRecorder::PushStrock(const StrockTypeParameter& strock_parameter) {
       _strockStack.emplace_back(strock_parameter);
       _currentStrock = _strockStack.back();
 }
 
-void PfxContext::PopStrock() {
+void PfxRecorder::PopStrock() {
       if (_strockStack.size() <= 1) {
-            const auto warning = "PfxContext::PopStrock - Can't Pop Root Strock";
+            const auto warning = "PfxRecorder::PopStrock - Can't Pop Root Strock";
             MessageManager::Log(MessageType::Warning, warning);
             return;
       }
@@ -979,37 +1318,12 @@ void PfxContext::PopStrock() {
       _currentStrock = _strockStack.back();
 }
 
-void PfxContext::DrawBox(glm::vec2 start, PParamBox param, float rotation, glm::u8vec4 color) {
-      uint32_t voffset = _vertexData.size();
-      uint32_t ioffset = _indexData.size();
-      uint32_t indirect_offset = _indirectData.size();
-
-      _vertexData.reserve(voffset + 4);
-      _indexData.reserve(ioffset + 6);
-
+void PfxRecorder::DrawBox(glm::vec2 start, PParamBox param, float rotation, glm::u8vec4 color) {
       const glm::vec2 size = param.Size;
-      const glm::vec2 ex_size = size + glm::vec2(_pixelExpand * 2);
-
-      _vertexData.emplace_back(start + glm::vec2(0, ex_size.y), glm::vec2(0, 1));
-      _vertexData.emplace_back(start + ex_size, glm::vec2(1, 1));
-      _vertexData.emplace_back(start, glm::vec2(0, 0));
-      _vertexData.emplace_back(start + glm::vec2(ex_size.x, 0), glm::vec2(1, 0));
-
-      _indexData.emplace_back(voffset + 0);
-      _indexData.emplace_back(voffset + 1);
-      _indexData.emplace_back(voffset + 2);
-      _indexData.emplace_back(voffset + 2);
-      _indexData.emplace_back(voffset + 1);
-      _indexData.emplace_back(voffset + 3);
-
-      _indirectData.emplace_back(
-      6,
-      1,
-      ioffset,
-      0,
-      indirect_offset);
+      const glm::vec2 ex_size = size + glm::vec2(_canvas->_pixelExpand * 2);
+      if (IsCulled(start + ex_size / 2.0f, ex_size, rotation, false)) return;
 
-      auto& ref = NewDrawInstanceData();
+      auto& ref = NewSDFInstanceData();
       ref.Color = color;
       ref.CenterRotate = rotation;
       ref.Size = ex_size;
@@ -1018,37 +1332,12 @@ void PfxContext::DrawBox(glm::vec2 start, PParamBox param, float rotation, glm::
       ref.PrimitiveParameter.Box = param;
 }
 
-void PfxContext::DrawRoundBox(glm::vec2 start, PParamRoundBox param, float rotation, glm::u8vec4 color) {
-      uint32_t voffset = _vertexData.size();
-      uint32_t ioffset = _indexData.size();
-      uint32_t indirect_offset = _indirectData.size();
-
-      _vertexData.reserve(voffset + 4);
-      _indexData.reserve(ioffset + 6);
-
+void PfxRecorder::DrawRoundBox(glm::vec2 start, PParamRoundBox param, float rotation, glm::u8vec4 color) {
       const glm::vec2 size = param.Size;
-      const glm::vec2 ex_size = size + glm::vec2(_pixelExpand * 2);
-
-      _vertexData.emplace_back(start + glm::vec2(0, ex_size.y), glm::vec2(0, 1));
-      _vertexData.emplace_back(start + ex_size, glm::vec2(1, 1));
-      _vertexData.emplace_back(start, glm::vec2(0, 0));
-      _vertexData.emplace_back(start + glm::vec2(ex_size.x, 0), glm::vec2(1, 0));
-
-      _indexData.emplace_back(voffset + 0);
-      _indexData.emplace_back(voffset + 1);
-      _indexData.emplace_back(voffset + 2);
-      _indexData.emplace_back(voffset + 2);
-      _indexData.emplace_back(voffset + 1);
-      _indexData.emplace_back(voffset + 3);
-
-      _indirectData.emplace_back(
-      6,
-      1,
-      ioffset,
-      0,
-      indirect_offset);
+      const glm::vec2 ex_size = size + glm::vec2(_canvas->_pixelExpand * 2);
+      if (IsCulled(start + ex_size / 2.0f, ex_size, rotation, false)) return;
 
-      auto& ref = NewDrawInstanceData();
+      auto& ref = NewSDFInstanceData();
       ref.Color = color;
       ref.CenterRotate = rotation;
       ref.Size = ex_size;
@@ -1057,80 +1346,29 @@ void PfxContext::DrawRoundBox(glm::vec2 start, PParamRoundBox param, float rotat
       ref.PrimitiveParameter.RoundRect = param;
 }
 
-void PfxContext::DrawNGon(glm::vec2 center, PParamRoundNGon param, float rotation, glm::u8vec4 color) {
-      uint32_t voffset = _vertexData.size();
-      uint32_t ioffset = _indexData.size();
-      uint32_t indirect_offset = _indirectData.size();
-
-      _vertexData.reserve(voffset + 4);
-      _indexData.reserve(ioffset + 6);
-
+void PfxRecorder::DrawNGon(glm::vec2 center, PParamRoundNGon param, float rotation, glm::u8vec4 color) {
       const float r = param.Radius;
 
       float an = 6.2831853f / (param.SegmentCount) / 2;
       float he = r / cos(an);
-      const float ex_size = he + _pixelExpand;
-
-      _vertexData.emplace_back(center + glm::vec2(-ex_size, ex_size), glm::vec2(0, 1));
-      _vertexData.emplace_back(center + ex_size, glm::vec2(1, 1));
-      _vertexData.emplace_back(center + glm::vec2(-ex_size, -ex_size), glm::vec2(0, 0));
-      _vertexData.emplace_back(center + glm::vec2(ex_size, -ex_size), glm::vec2(1, 0));
-
-      _indexData.emplace_back(voffset + 0);
-      _indexData.emplace_back(voffset + 1);
-      _indexData.emplace_back(voffset + 2);
-      _indexData.emplace_back(voffset + 2);
-      _indexData.emplace_back(voffset + 1);
-      _indexData.emplace_back(voffset + 3);
-
-      _indirectData.emplace_back(
-      6,
-      1,
-      ioffset,
-      0,
-      indirect_offset);
+      const float ex_size = he + _canvas->_pixelExpand;
+      if (IsCulled(center, glm::vec2(ex_size, ex_size) * 2.0f, rotation, false)) return;
 
-      auto& ref = NewDrawInstanceData();
+      auto& ref = NewSDFInstanceData();
       ref.Color = color;
       ref.CenterRotate = rotation;
-      ref.CenterRotate = rotation;
       ref.Size = glm::vec2(ex_size, ex_size) * 2.0f;
       ref.Center = center;
       ref.PrimitiveType = DrawPrimitveType::RoundNGon;
       ref.PrimitiveParameter.RoundNGon = param;
 }
 
-void PfxContext::DrawCircle(glm::vec2 center, PParamCircle param, float rotation, glm::u8vec4 color) {
-      uint32_t voffset = _vertexData.size();
-      uint32_t ioffset = _indexData.size();
-      uint32_t indirect_offset = _indirectData.size();
-
-      _vertexData.reserve(voffset + 4);
-      _indexData.reserve(ioffset + 6);
-
+void PfxRecorder::DrawCircle(glm::vec2 center, PParamCircle param, float rotation, glm::u8vec4 color) {
       const float r = param.Radius;
-      const float ex_size = r + _pixelExpand;
-
-      _vertexData.emplace_back(center + glm::vec2(-ex_size, ex_size), glm::vec2(0, 1));
-      _vertexData.emplace_back(center + glm::vec2(ex_size, ex_size), glm::vec2(1, 1));
-      _vertexData.emplace_back(center + glm::vec2(-ex_size, -ex_size), glm::vec2(0, 0));
-      _vertexData.emplace_back(center + glm::vec2(ex_size, -ex_size), glm::vec2(1, 0));
-
-      _indexData.emplace_back(voffset + 0);
-      _indexData.emplace_back(voffset + 1);
-      _indexData.emplace_back(voffset + 2);
-      _indexData.emplace_back(voffset + 2);
-      _indexData.emplace_back(voffset + 1);
-      _indexData.emplace_back(voffset + 3);
-
-      _indirectData.emplace_back(
-      6,
-      1,
-      ioffset,
-      0,
-      indirect_offset);
+      const float ex_size = r + _canvas->_pixelExpand;
+      if (IsCulled(center, glm::vec2(ex_size, ex_size) * 2.0f, rotation, false)) return;
 
-      auto& ref = NewDrawInstanceData();
+      auto& ref = NewSDFInstanceData();
       ref.Color = color;
       ref.CenterRotate = rotation;
       ref.Size = glm::vec2(ex_size, ex_size) * 2.0f;
@@ -1139,70 +1377,92 @@ void PfxContext::DrawCircle(glm::vec2 center, PParamCircle param, float rotation
       ref.PrimitiveParameter.Circle = param;
 }
 
-void PfxContext::DrawText(glm::vec2 start, const wchar_t* text, PParamText param, glm::u8vec4 color) {
-      std::wstring_view wstr(text);
-      if (wstr.empty()) return;
-
-      uint32_t voffset = _vertexData.size();
-      uint32_t ioffset = _indexData.size();
-      uint32_t indirect_offset = _indirectData.size();
-
-      _vertexData.reserve(voffset + 4 * wstr.size());
-      _indexData.reserve(ioffset + 6 * wstr.size());
-
-      float size = param.Size;
+bool PfxRecorder::IsCulled(glm::vec2 center, glm::vec2 size, float rotation, bool text) {
+      //bounds of the quad rotated around its center, size already carries the SDF margin
+      const float rad = glm::radians(rotation);
+      const float c = glm::abs(glm::cos(rad));
+      const float s = glm::abs(glm::sin(rad));
+      const glm::vec2 half = glm::vec2(c * size.x + s * size.y, s * size.x + c * size.y) * 0.5f;
+      const glm::vec2 lo = center - half;
+      const glm::vec2 hi = center + half;
+
+      const glm::vec2 scissor_lo(_currentScissor.x, _currentScissor.y);
+      const glm::vec2 scissor_hi = scissor_lo + glm::vec2(_currentScissor.z, _currentScissor.w);
+      bool culled = hi.x < scissor_lo.x || hi.y < scissor_lo.y || lo.x > scissor_hi.x || lo.y > scissor_hi.y;
+
+      //a draw list lands wherever it is replayed, only its recorded scissors are known here
+      if (!culled && _target == _records) {
+            culled = hi.x < 0 || hi.y < 0 || lo.x > _currentCanvasSize.x || lo.y > _currentCanvasSize.y;
+      }
 
-      uint32_t dy_voffset = voffset;
+      if (text) {
+            culled ? _stats.CulledTextRuns++ : _stats.EmittedTextRuns++;
+      } else {
+            culled ? _stats.CulledPrimitives++ : _stats.EmittedPrimitives++;
+      }
+      return culled;
+}
 
-      glm::vec2 start_offset = start;
-      for (wchar_t i : wstr) {
-            FontUV fuv{};
-            if (_fontUVs.find(i) == _fontUVs.end()) {
-                  fuv = _fontUVs[L'#'];
-            } else {
-                  fuv = _fontUVs[i];
-            }
+void PfxRecorder::DrawText(glm::vec2 start, const wchar_t* text, PParamText param, glm::u8vec4 color) {
+      std::wstring_view wstr(text);
+      if (wstr.empty()) return;
 
-            if (_fontDOT.contains(i)) {
-                  float half_size = size / 2.0f;
-                  _vertexData.emplace_back(start_offset + glm::vec2(0, half_size), glm::vec2(fuv.x, fuv.y + fuv.h));
-                  _vertexData.emplace_back(start_offset + glm::vec2(half_size, half_size), glm::vec2(fuv.x + fuv.w, fuv.y + fuv.h));
-                  _vertexData.emplace_back(start_offset, glm::vec2(fuv.x, fuv.y));
-                  _vertexData.emplace_back(start_offset + glm::vec2(half_size, 0), glm::vec2(fuv.x + fuv.w, fuv.y));
-                  start_offset.x += half_size + param.Space;
-            } else if (std::isalpha(i) || std::isdigit(i) || std::isspace(i) || std::ispunct(i)) {
-                  float half_size = size / 2.0f;
-                  _vertexData.emplace_back(start_offset + glm::vec2(0, size), glm::vec2(fuv.x, fuv.y + fuv.h));
-                  _vertexData.emplace_back(start_offset + glm::vec2(half_size, size), glm::vec2(fuv.x + fuv.w, fuv.y + fuv.h));
-                  _vertexData.emplace_back(start_offset, glm::vec2(fuv.x, fuv.y));
-                  _vertexData.emplace_back(start_offset + glm::vec2(half_size, 0), glm::vec2(fuv.x + fuv.w, fuv.y));
-                  start_offset.x += half_size + param.Space;
-            } else {
-                  _vertexData.emplace_back(start_offset + glm::vec2(0, size), glm::vec2(fuv.x, fuv.y + fuv.h));
-                  _vertexData.emplace_back(start_offset + size, glm::vec2(fuv.x + fuv.w, fuv.y + fuv.h));
-                  _vertexData.emplace_back(start_offset, glm::vec2(fuv.x, fuv.y));
-                  _vertexData.emplace_back(start_offset + glm::vec2(size, 0), glm::vec2(fuv.x + fuv.w, fuv.y));
-                  start_offset.x += size + param.Space;
+      //no glyph advances more than a full-width one, the run can't end past that,
+      //a spacing that walks glyphs back past the start is left alone
+      const float max_width = (float)wstr.size() * (param.Size + glm::max(param.Space, 0.0f));
+      if (param.Size * 0.5f + param.Space >= 0 && IsCulled(start + glm::vec2(max_width, param.Size) / 2.0f, glm::vec2(max_width, param.Size), 0, true)) return;
+
+      uint32_t voffset = _target->Vertex.Count<GenDrawVertexData>();
+      uint32_t ioffset = _target->Index.Count<uint32_t>();
+      uint32_t indirect_offset = _target->Indirect.Count<VkDrawIndexedIndirectCommand>();
+
+      GenDrawVertexData* vertex = _target->Vertex.Allocate<GenDrawVertexData>((uint32_t)(4 * wstr.size()));
+      uint32_t* index = _target->Index.Allocate<uint32_t>((uint32_t)(6 * wstr.size()));
+
+      //the layout is cached by the atlas, a repeated string skips the glyph lookups,
+      //glyphs still being generated draw empty
+      const auto atlas = _canvas->_glyphAtlas.get();
+      std::shared_ptr<const PfxTextLayout> layout{};
+      if (atlas) {
+            layout = atlas->Layout(wstr, param.Size, param.Space);
+            if (_recordingList) {
+                  if (!layout->bResident) _recordingList->_bPendingGlyphs = true;
+                  _recordingList->_glyphs.insert(_recordingList->_glyphs.end(), wstr.begin(), wstr.end());
             }
-            _indexData.emplace_back(dy_voffset + 0);
-            _indexData.emplace_back(dy_voffset + 1);
-            _indexData.emplace_back(dy_voffset + 2);
-            _indexData.emplace_back(dy_voffset + 2);
-            _indexData.emplace_back(dy_voffset + 1);
-            _indexData.emplace_back(dy_voffset + 3);
+            _target->SampledImages.insert(atlas->GetTexture());
+      } else {
+            _glyphScratch.assign(wstr.size(), FontUV{});
+            auto unresolved = std::make_shared<PfxTextLayout>();
+            PfxGlyphAtlas::BuildLayout(wstr, param.Size, param.Space, _glyphScratch.data(), *unresolved);
+            layout = std::move(unresolved);
+      }
 
+      for (const auto& v : layout->Vertices) {
+            *vertex++ = GenDrawVertexData(v.Pos + start, v.UV);
+      }
 
+      uint32_t dy_voffset = voffset;
+      for (size_t c = 0; c < wstr.size(); c++) {
+            *index++ = dy_voffset + 0;
+            *index++ = dy_voffset + 1;
+            *index++ = dy_voffset + 2;
+            *index++ = dy_voffset + 2;
+            *index++ = dy_voffset + 1;
+            *index++ = dy_voffset + 3;
             dy_voffset += 4;
       }
 
-      _indirectData.emplace_back(
-      6 * wstr.size(),
-      1,
-      ioffset,
-      0,
-      indirect_offset);
+      AppendDrawBatch(PfxDrawBatchType::Text, indirect_offset);
+      *_target->Indirect.Allocate<VkDrawIndexedIndirectCommand>() = {
+            .indexCount = (uint32_t)(6 * wstr.size()),
+            .instanceCount = 1,
+            .firstIndex = ioffset,
+            .vertexOffset = 0,
+            .firstInstance = _target->Instance.Count<GenInstanceData>()
+      };
 
-      auto total_size = glm::vec2(start_offset.x, size);
+      //same extent MeasureText reports, the trailing spacing isn't part of the run
+      auto total_size = glm::vec2(layout->Advance - param.Space, param.Size);
       auto& ref = NewDrawInstanceData();
       ref.Color = color;
       ref.CenterRotate = 0;
@@ -1210,34 +1470,207 @@ void PfxContext::DrawText(glm::vec2 start, const wchar_t* text, PParamText param
       ref.Center = start + total_size / 2.0f;
       ref.PrimitiveType = DrawPrimitveType::Text;
       ref.PrimitiveParameter.Text = param;
-      ref.TextureBindlessIndex_or_GradientDataOffset = _fontAtlasTextureBindlessIndex;
+      ref.TextureBindlessIndex_or_GradientDataOffset = atlas ? atlas->GetTextureBindlessIndex() : 0;
 }
 
 void PfxContext::EmitDrawCommand(RenderNode* node) {
-      if (_vertexData.empty()) return;
+      if (_frameTarget.Batches.empty()) return;
 
-      auto current_index = _gfx->GetCurrentFrameIndex();
-      for (auto i : _sampledImageReference[current_index]) {
+      for (auto i : _frameTarget.SampledImages) {
             node->CmdAsSampledTexure(i, GfxEnumKernelType::GRAPHICS);
       }
+      for (const auto& replay : _frameTarget.Replays) {
+            if (replay.List) node->CmdAsReadBuffer(replay.List->_bufferGradient, GfxEnumKernelType::GRAPHICS);
+      }
 
-      node->CmdBindKernel(_kernelDraw);
-      node->CmdBindVertexBuffer(_bufferVertex[current_index], 0);
-      node->CmdBindVertexBuffer(_bufferInstance[current_index], 1);
-      node->CmdBindIndexBuffer(_bufferIndex[current_index], 0);
-      node->CmdDrawIndexedIndirect(_bufferIndirect[current_index], 0, _indirectData.size(), sizeof(VkDrawIndexedIndirectCommand));
+      const PfxDrawBuffers frame_buffers{_frameTarget.Vertex.GetBuffer(), _frameTarget.Index.GetBuffer(), _frameTarget.Instance.GetBuffer(), _frameTarget.Indirect.GetBuffer()};
+      const PfxDrawConstant frame_constant{
+            .GradientAddress = _frameTarget.Gradient.GetAddress(),
+            .ReplayOffset = {0, 0},
+            .ReplayScale = {1, 1},
+            .ReplayTint = {255, 255, 255, 255},
+            .ReplayClipStart = {0, 0},
+            .ReplayClipSize = {UINT16_MAX, UINT16_MAX}
+      };
+
+      // batches keep the painter's order, the node filters the repeated binds
+      for (const auto& batch : _frameTarget.Batches) {
+            if (batch.Type == PfxDrawBatchType::DrawList) {
+                  const auto& replay = _frameTarget.Replays[batch.First];
+                  if (!replay.List) continue;
+                  const auto buffers = replay.List->GetDrawBuffers();
+                  for (const auto& list_batch : replay.List->_records.Batches) {
+                        EmitBatch(node, buffers, list_batch, replay.Constant);
+                  }
+            } else {
+                  EmitBatch(node, frame_buffers, batch, frame_constant);
+            }
+      }
+}
+
+void PfxContext::EmitBatch(RenderNode* node, const PfxDrawBuffers& buffers, const PfxDrawBatch& batch, const PfxDrawConstant& constant) const {
+      if (batch.Type == PfxDrawBatchType::Text) {
+            node->CmdBindKernel(_kernelDraw);
+            node->CmdPushConstant(_layoutDraw, &constant, sizeof(PfxDrawConstant));
+            node->CmdBindVertexBuffer(buffers.Vertex, 0);
+            node->CmdBindVertexBuffer(buffers.Instance, 1);
+            node->CmdBindIndexBuffer(buffers.Index, 0);
+            node->CmdDrawIndexedIndirect(buffers.Indirect, batch.First * sizeof(VkDrawIndexedIndirectCommand), batch.Count, sizeof(VkDrawIndexedIndirectCommand));
+      } else if (batch.Type == PfxDrawBatchType::SDF) {
+            node->CmdBindKernel(_kernelDrawSDF);
+            node->CmdPushConstant(_layoutDrawSDF, &constant, sizeof(PfxDrawConstant));
+            node->CmdBindVertexBuffer(buffers.Instance, 1);
+            node->CmdDraw(6, batch.Count, 0, batch.First);
+      }
+}
+
+PfxRecorder* PfxContext::CreateSubCanvas(int32_t order) {
+      return _subCanvases.emplace_back(std::make_unique<PfxRecorder>(this, order)).get();
+}
+
+void PfxContext::DestroySubCanvas(PfxRecorder* sub_canvas) {
+      std::erase_if(_subCanvases, [&](const std::unique_ptr<PfxRecorder>& ptr) { return ptr.get() == sub_canvas; });
+}
+
+PfxDrawList* PfxContext::CreateDrawList() {
+      const auto list = new PfxDrawList(_gfx);
+      _drawLists.insert(list);
+      return list;
+}
+
+void PfxContext::DestroyDrawList(PfxDrawList* list) {
+      if (!_drawLists.contains(list)) return;
+
+      //replays already queued this frame are dropped, the batch indices stay valid
+      const auto drop = [&](PfxRecorder& recorder) {
+            if (recorder._recordingList == list) recorder.EndDrawList();
+            for (auto& replay : recorder._records->Replays) {
+                  if (replay.List == list) replay.List = nullptr;
+            }
+      };
+      drop(_recorder);
+      for (auto& sub_canvas : _subCanvases) {
+            drop(*sub_canvas);
+      }
+
+      _drawLists.erase(list);
+      delete list;
+}
+
+void PfxRecorder::BeginDrawList(PfxDrawList* list) {
+      if (_recordingList != nullptr) {
+            const auto warning = "PfxRecorder::BeginDrawList - Already Recording a Draw List, End it First";
+            MessageManager::Log(MessageType::Warning, warning);
+            return;
+      }
+      if (!_canvas->_drawLists.contains(list)) {
+            const auto warning = "PfxRecorder::BeginDrawList - Invalid Draw List";
+            MessageManager::Log(MessageType::Warning, warning);
+            return;
+      }
+
+      list->BeginRecord();
+      _recordingList = list;
+      _target = &list->_records;
+}
+
+void PfxRecorder::EndDrawList() {
+      if (_recordingList == nullptr) {
+            const auto warning = "PfxRecorder::EndDrawList - Not Recording a Draw List";
+            MessageManager::Log(MessageType::Warning, warning);
+            return;
+      }
+
+      _recordingList->EndRecord();
+      _recordingList = nullptr;
+      _target = _records;
+}
+
+void PfxRecorder::DrawList(PfxDrawList* list, glm::vec2 offset, glm::vec2 scale, glm::u8vec4 tint, glm::u16vec4 clip) {
+      if (_recordingList != nullptr) {
+            const auto warning = "PfxRecorder::DrawList - Can't Replay a Draw List While Recording One";
+            MessageManager::Log(MessageType::Warning, warning);
+            return;
+      }
+      if (!_canvas->_drawLists.contains(list) || list->IsEmpty()) return;
+
+      list->_lastReplayFrame.store(_canvas->_gfx->GetCurrentFrameValue(), std::memory_order_relaxed);
+      for (auto i : list->_records.SampledImages) {
+            _records->SampledImages.insert(i);
+      }
+
+      _records->Batches.emplace_back(PfxDrawBatchType::DrawList, (uint32_t)_records->Replays.size(), 1);
+      _records->Replays.emplace_back(list, PfxDrawConstant{
+            .GradientAddress = list->_gradientAddress,
+            .ReplayOffset = offset,
+            .ReplayScale = scale,
+            .ReplayTint = tint,
+            .ReplayClipStart = {clip.x, clip.y},
+            .ReplayClipSize = {clip.z, clip.w}
+      });
 }
 
 void PfxContext::Reset() {
+      //glyphs land before anything records, text recorded into lists from now on sees them
+      if (_glyphAtlas) {
+            //replayed lists reuse their vertices, their glyphs must count as drawn or they become the first eviction victims
+            for (auto list : _drawLists) {
+                  const uint64_t replayed = list->_lastReplayFrame.load(std::memory_order_relaxed);
+                  if (replayed == list->_touchedFrame || list->_glyphs.empty()) continue;
+                  _glyphAtlas->Touch(list->_glyphs, replayed);
+                  list->_touchedFrame = replayed;
+            }
+
+            const auto changes = _glyphAtlas->Update();
+            for (auto list : _drawLists) {
+                  if ((changes.bEvicted && list->HasText()) || (changes.bLanded && list->_bPendingGlyphs)) list->MarkDirty();
+            }
+      }
+
       //rendering op clear
-      _vertexData.clear();
-      _indexData.clear();
+      const auto frame_index = _gfx->GetCurrentFrameIndex();
+      _frameTarget.Vertex.BeginFrame(frame_index);
+      _frameTarget.Index.BeginFrame(frame_index);
+
+      _frameTarget.Instance.BeginFrame(frame_index);
+      _frameTarget.Indirect.BeginFrame(frame_index);
+      _frameTarget.Gradient.BeginFrame(frame_index);
+
+      _recorder.Reset();
+      for (auto& sub_canvas : _subCanvases) {
+            sub_canvas->Reset();
+      }
+      _bSubCanvasesMerged = false;
+}
+
+PfxRecorder::PfxRecorder(PfxContext* canvas, PfxRecordTarget* records) : _canvas(canvas), _records(records), _target(records) {}
+
+PfxRecorder::PfxRecorder(PfxContext* canvas, int32_t order) : _canvas(canvas), _order(order) {
+      _ownedRecords = std::make_unique<PfxRecordTarget>();
+      _ownedRecords->Vertex.InitHost(1024);
+      _ownedRecords->Index.InitHost(1024);
+      _ownedRecords->Instance.InitHost(4096);
+      _ownedRecords->Indirect.InitHost(256);
+      _ownedRecords->Gradient.InitHost(256);
+      _records = _target = _ownedRecords.get();
+      Reset();
+}
 
-      _instanceData.clear();
-      _indirectData.clear();
-      _gradientData.clear();
+void PfxRecorder::Reset() {
+      if (_recordingList != nullptr) EndDrawList();
 
-      _sampledImageReference[_gfx->GetCurrentFrameIndex()].clear();
+      //the canvas' own records live in the frame streams, it begins them itself
+      if (_ownedRecords) {
+            _records->Vertex.Clear();
+            _records->Index.Clear();
+            _records->Instance.Clear();
+            _records->Indirect.Clear();
+            _records->Gradient.Clear();
+      }
+      _records->Batches.clear();
+      _records->Replays.clear();
+      _records->SampledImages.clear();
+      _stats = {};
 
       //init state
       _currentScissor = {0, 0, 3840, 2160};
@@ -1257,8 +1690,23 @@ void PfxContext::Reset() {
       _shadowStack.clear();
 }
 
-GenInstanceData& PfxContext::NewDrawInstanceData() {
-      auto& current_instance_data = _instanceData.emplace_back();
+void PfxRecorder::AppendDrawBatch(PfxDrawBatchType type, uint32_t first) {
+      auto& batches = _target->Batches;
+      if (!batches.empty() && batches.back().Type == type) {
+            batches.back().Count++;
+      } else {
+            batches.emplace_back(type, first, 1);
+      }
+}
+
+GenInstanceData& PfxRecorder::NewSDFInstanceData() {
+      AppendDrawBatch(PfxDrawBatchType::SDF, _target->Instance.Count<GenInstanceData>());
+      return NewDrawInstanceData();
+}
+
+GenInstanceData& PfxRecorder::NewDrawInstanceData() {
+      auto& current_instance_data = *_target->Instance.Allocate<GenInstanceData>();
+      current_instance_data = {};
 
       current_instance_data.Scissor = _currentScissor;
       current_instance_data.CanvasSize = _currentCanvasSize;
@@ -1269,16 +1717,16 @@ GenInstanceData& PfxContext::NewDrawInstanceData() {
                   current_instance_data.Color = _currentStrock.Solid.SoildColor;
                   break;
             case StrockFillType::Texture:
-                  current_instance_data.TextureBindlessIndex_or_GradientDataOffset = _gfx->GetTextureBindlessIndex(std::bit_cast<ResourceHandle>(_currentStrock.Texture.ImageHandle));
-                  _sampledImageReference[_gfx->GetCurrentFrameIndex()].insert(std::bit_cast<ResourceHandle>(_currentStrock.Texture.ImageHandle));
+                  current_instance_data.TextureBindlessIndex_or_GradientDataOffset = _canvas->_gfx->GetTextureBindlessIndex(std::bit_cast<ResourceHandle>(_currentStrock.Texture.ImageHandle));
+                  _target->SampledImages.insert(std::bit_cast<ResourceHandle>(_currentStrock.Texture.ImageHandle));
                   break;
             case StrockFillType::Linear2:
             case StrockFillType::Linear3:
             case StrockFillType::Linear4:
             case StrockFillType::Linear5:
             case StrockFillType::Linear6:
-                  current_instance_data.TextureBindlessIndex_or_GradientDataOffset = _gradientData.size();
-                  _gradientData.emplace_back(
+                  current_instance_data.TextureBindlessIndex_or_GradientDataOffset = _target->Gradient.Count<GradientData>();
+                  *_target->Gradient.Allocate<GradientData>() = GradientData(
                   glm::vec2(0, 0),
                   _currentStrock.Linear.DirectionAngle,
                   _currentStrock.Linear.Pos1,
@@ -1300,8 +1748,8 @@ GenInstanceData& PfxContext::NewDrawInstanceData() {
             case StrockFillType::Radial4:
             case StrockFillType::Radial5:
             case StrockFillType::Radial6:
-                  current_instance_data.TextureBindlessIndex_or_GradientDataOffset = _gradientData.size();
-                  _gradientData.emplace_back(
+                  current_instance_data.TextureBindlessIndex_or_GradientDataOffset = _target->Gradient.Count<GradientData>();
+                  *_target->Gradient.Allocate<GradientData>() = GradientData(
                   glm::vec2(_currentStrock.Radial.OffsetX, _currentStrock.Radial.OffsetY),
                   0,
                   _currentStrock.Radial.Pos1,
@@ -1323,25 +1771,87 @@ GenInstanceData& PfxContext::NewDrawInstanceData() {
       return current_instance_data;
 }
 
-void PfxContext::DispatchGenerateCommands() const {
-      if (_vertexData.empty()) return;
+PfxCullStats PfxContext::GetCullStats() const {
+      PfxCullStats stats = _recorder.GetCullStats();
+      for (const auto& sub_canvas : _subCanvases) {
+            const auto& sub = sub_canvas->GetCullStats();
+            stats.EmittedPrimitives += sub.EmittedPrimitives;
+            stats.CulledPrimitives += sub.CulledPrimitives;
+            stats.EmittedTextRuns += sub.EmittedTextRuns;
+            stats.CulledTextRuns += sub.CulledTextRuns;
+      }
+      return stats;
+}
 
-      auto ptr_vbuf = _gfx->ResourceFetch<Component::Gfx::Buffer>(_bufferVertex[_gfx->GetCurrentFrameIndex()]);
-      auto ptr_ibuf = _gfx->ResourceFetch<Component::Gfx::Buffer>(_bufferIndex[_gfx->GetCurrentFrameIndex()]);
-      auto ptr_instancebuf = _gfx->ResourceFetch<Component::Gfx::Buffer>(_bufferInstance[_gfx->GetCurrentFrameIndex()]);
-      auto ptr_indirectbuf = _gfx->ResourceFetch<Component::Gfx::Buffer>(_bufferIndirect[_gfx->GetCurrentFrameIndex()]);
+void PfxContext::MergeRecords(const PfxRecordTarget& src, std::vector<PfxDrawBatch>& batches) {
+      auto& dst = _frameTarget;
+      const uint32_t vertex_base = dst.Vertex.Count<GenDrawVertexData>();
+      const uint32_t index_base = dst.Index.Count<uint32_t>();
+      const uint32_t instance_base = dst.Instance.Count<GenInstanceData>();
+      const uint32_t indirect_base = dst.Indirect.Count<VkDrawIndexedIndirectCommand>();
+      const uint32_t gradient_base = dst.Gradient.Count<GradientData>();
+      const uint32_t replay_base = (uint32_t)dst.Replays.size();
+
+      //indices stay relative to the sub canvas, the indirect commands carry the vertex base
+      dst.Vertex.Append<GenDrawVertexData>(src.Vertex);
+      dst.Index.Append<uint32_t>(src.Index);
+      dst.Gradient.Append<GradientData>(src.Gradient);
+
+      auto instances = dst.Instance.Append<GenInstanceData>(src.Instance);
+      for (uint32_t i = 0; i < src.Instance.Count<GenInstanceData>(); i++) {
+            auto& instance = instances[i];
+            if (instance.PrimitiveType != DrawPrimitveType::Text && instance.StrockType >= StrockFillType::Linear2) {
+                  instance.TextureBindlessIndex_or_GradientDataOffset += gradient_base;
+            }
+      }
 
-      auto ptr_gradientbuf = _gfx->ResourceFetch<Component::Gfx::Buffer>(_bufferGradient[_gfx->GetCurrentFrameIndex()]);
+      auto commands = dst.Indirect.Append<VkDrawIndexedIndirectCommand>(src.Indirect);
+      for (uint32_t i = 0; i < src.Indirect.Count<VkDrawIndexedIndirectCommand>(); i++) {
+            commands[i].firstIndex += index_base;
+            commands[i].vertexOffset += (int32_t)vertex_base;
+            commands[i].firstInstance += instance_base;
+      }
 
-      ptr_vbuf->SetData(_vertexData.data(), _vertexData.size() * sizeof(GenDrawVertexData));
-      ptr_ibuf->SetData(_indexData.data(), _indexData.size() * sizeof(uint32_t));
+      dst.Replays.insert(dst.Replays.end(), src.Replays.begin(), src.Replays.end());
+      for (auto i : src.SampledImages) {
+            dst.SampledImages.insert(i);
+      }
 
-      ptr_instancebuf->SetData(_instanceData.data(), _instanceData.size() * sizeof(GenInstanceData));
-      ptr_indirectbuf->SetData(_indirectData.data(), _indirectData.size() * sizeof(VkDrawIndexedIndirectCommand));
+      for (auto batch : src.Batches) {
+            switch (batch.Type) {
+                  case PfxDrawBatchType::SDF: batch.First += instance_base; break;
+                  case PfxDrawBatchType::Text: batch.First += indirect_base; break;
+                  case PfxDrawBatchType::DrawList: batch.First += replay_base; break;
+            }
+            batches.push_back(batch);
+      }
+}
 
-      if (!_gradientData.empty()) {
-            ptr_gradientbuf->SetData(_gradientData.data(), _gradientData.size() * sizeof(GradientData));
-            uint64_t address = ptr_gradientbuf->GetBDAAddress();
-            _gfx->FillKernelConstant(_kernelDraw, &address, sizeof(address));
+void PfxContext::DispatchGenerateCommands() {
+      if (!_subCanvases.empty() && !_bSubCanvasesMerged) {
+            //deterministic: by order then creation, whichever thread finished first
+            std::vector<PfxRecorder*> sorted{};
+            sorted.reserve(_subCanvases.size());
+            for (auto& sub_canvas : _subCanvases) sorted.push_back(sub_canvas.get());
+            std::ranges::stable_sort(sorted, {}, &PfxRecorder::GetOrder);
+
+            std::vector<PfxDrawBatch> batches{};
+            auto it = sorted.begin();
+            for (; it != sorted.end() && (*it)->GetOrder() < 0; ++it) {
+                  MergeRecords((*it)->GetRecords(), batches);
+            }
+            batches.insert(batches.end(), _frameTarget.Batches.begin(), _frameTarget.Batches.end());
+            for (; it != sorted.end(); ++it) {
+                  MergeRecords((*it)->GetRecords(), batches);
+            }
+            _frameTarget.Batches = std::move(batches);
+            _bSubCanvasesMerged = true;
       }
+
+      //everything was recorded in place, only non-coherent memory needs the ranges flushed
+      _frameTarget.Instance.Flush();
+      _frameTarget.Vertex.Flush();
+      _frameTarget.Index.Flush();
+      _frameTarget.Indirect.Flush();
+      _frameTarget.Gradient.Flush();
 }
@@ -1,5 +1,14 @@
 #pragma once
+#include <filesystem>
+#include <fstream>
+
 #include "GfxContext.h"
+#include "PfxGlyphRaster.h"
+
+namespace msdfgen {
+      class FreetypeHandle;
+      class FontHandle;
+}
 
 namespace LoFi {
       struct FontUV {
@@ -171,28 +180,404 @@ namespace LoFi {
             PrimitiveParameter PrimitiveParameter;
       };
 
+      enum class PfxDrawBatchType : uint8_t {
+            SDF,
+            Text,
+            DrawList,
+      };
+
+      // run of consecutive draws taking the same path, SDF runs are a single instanced quad draw
+      struct PfxDrawBatch {
+            PfxDrawBatchType Type;
+            uint32_t First; // first instance for SDF, first indirect command for text, replay index for draw lists
+            uint32_t Count;
+      };
+
+      // push constant shared by both draw kernels, the replay fields are identity for immediate draws
+      struct PfxDrawConstant {
+            uint64_t GradientAddress;
+            glm::vec2 ReplayOffset;
+            glm::vec2 ReplayScale;
+            glm::u8vec4 ReplayTint;
+            glm::u16vec2 ReplayClipStart;
+            glm::u16vec2 ReplayClipSize;
+      };
+
+      struct PfxDrawBuffers {
+            ResourceHandle Vertex;
+            ResourceHandle Index;
+            ResourceHandle Instance;
+            ResourceHandle Indirect;
+      };
+
+      // per-frame upload stream, the canvas writes straight into the mapped host buffer of the current frame slot.
+      // one bump pointer per stream, the buffer grows geometrically and is reused frame after frame.
+      class PfxFrameStream {
+      public:
+            NO_COPY_MOVE_CONS(PfxFrameStream);
+
+            PfxFrameStream() = default;
+
+            ~PfxFrameStream();
+
+            void Init(GfxContext* gfx, const char* name, uint64_t capacity);
+
+            // records stay in host memory only, draw lists upload them once recording ends
+            void InitHost(uint64_t capacity);
+
+            void BeginFrame(uint32_t frame_index);
+
+            void Clear() { _head = 0; }
+
+            template<class T>
+            T* Allocate(uint32_t count = 1) {
+                  const uint64_t required = _head + sizeof(T) * count;
+                  if (required > _capacity) Grow(required);
+                  T* ptr = reinterpret_cast<T*>(_mapped + _head);
+                  _head = required;
+                  return ptr;
+            }
+
+            // copies everything other recorded this frame, returns where it landed
+            template<class T>
+            T* Append(const PfxFrameStream& other) {
+                  T* ptr = Allocate<T>(other.Count<T>());
+                  if (!other.Empty()) memcpy(ptr, other.GetData(), other.GetUsedBytes());
+                  return ptr;
+            }
+
+            template<class T>
+            [[nodiscard]] uint32_t Count() const { return (uint32_t)(_head / sizeof(T)); }
+
+            [[nodiscard]] bool Empty() const { return _head == 0; }
+
+            [[nodiscard]] uint64_t GetUsedBytes() const { return _head; }
+
+            [[nodiscard]] const void* GetData() const { return _mapped; }
+
+            [[nodiscard]] ResourceHandle GetBuffer() const { return _buffers[_frameIndex]; }
+
+            [[nodiscard]] VkDeviceAddress GetAddress() const { return _address; }
+
+            void Flush() const;
+
+      private:
+            void Grow(uint64_t required);
+
+      private:
+            GfxContext* _gfx{};
+
+            ResourceHandle _buffers[3]{};
+
+            uint32_t _frameIndex{};
+
+            uint8_t* _mapped{};
+
+            uint64_t _capacity{};
+
+            uint64_t _head{};
+
+            VkDeviceAddress _address{};
+
+            std::vector<uint8_t> _hostStorage{};
+      };
+
+      class PfxDrawList;
+
+      struct PfxDrawListReplay {
+            PfxDrawList* List;
+            PfxDrawConstant Constant;
+      };
+
+      // where the Draw* calls write, the canvas' own frame streams or a draw list being recorded
+      struct PfxRecordTarget {
+            PfxFrameStream Vertex{};
+            PfxFrameStream Index{};
+            PfxFrameStream Instance{};
+            PfxFrameStream Indirect{};
+            PfxFrameStream Gradient{};
+
+            std::vector<PfxDrawBatch> Batches{};
+
+            std::vector<PfxDrawListReplay> Replays{};
+
+            entt::dense_set<ResourceHandle, Internal::HashResourceHandle, Internal::EqualResourceHandle> SampledImages{};
+      };
+
+      // retained primitives: recorded once into device buffers it owns, replayed any number of times per frame.
+      // a list stays as recorded until it is marked dirty and recorded again
+      class PfxDrawList {
+      public:
+            NO_COPY_MOVE_CONS(PfxDrawList);
+
+            explicit PfxDrawList(GfxContext* gfx);
+
+            ~PfxDrawList();
+
+            [[nodiscard]] bool IsDirty() const { return _bDirty; }
+
+            void MarkDirty() { _bDirty = true; }
+
+            [[nodiscard]] bool IsEmpty() const { return _records.Batches.empty(); }
+
+            [[nodiscard]] bool HasText() const;
+
+      private:
+            friend class PfxContext;
+            friend class PfxRecorder;
+
+            void BeginRecord();
+
+            void EndRecord();
+
+            [[nodiscard]] PfxDrawBuffers GetDrawBuffers() const { return {_bufferVertex, _bufferIndex, _bufferInstance, _bufferIndirect}; }
+
+      private:
+            GfxContext* _gfx{};
+
+            PfxRecordTarget _records{};
+
+            ResourceHandle _bufferVertex{};
+            ResourceHandle _bufferIndex{};
+            ResourceHandle _bufferInstance{};
+            ResourceHandle _bufferIndirect{};
+            ResourceHandle _bufferGradient{};
+
+            VkDeviceAddress _gradientAddress{};
+
+            bool _bDirty = true;
+
+            bool _bPendingGlyphs = false; // recorded text that was still being generated
+
+            std::vector<wchar_t> _glyphs{}; // every char of the recorded text, sorted and unique after EndRecord
+
+            std::atomic<uint64_t> _lastReplayFrame{}; // set by every recorder that replays the list
+
+            uint64_t _touchedFrame{}; // last replay frame whose glyphs the atlas has stamped
+      };
+
       //painter library
 
-      class PfxFontLibrary {
+      struct PfxGlyphBitmap {
+            wchar_t Char;
+            PfxGlyphClass Class;
+            std::vector<uint8_t> Texels; // MTSDF of the whole cell, already in the atlas format
+            bool bCached;
+      };
+
+      // glyph cache file: the header, then records appended as glyphs are generated, each followed by its cell texels.
+      // the key hashes the font file and every generation parameter, a mismatching file is started over
+      struct PfxGlyphCacheHeader {
+            uint32_t Magic;
+            uint32_t Version;
+            uint64_t Key;
+      };
+
+      struct PfxGlyphCacheRecord {
+            uint32_t Char;
+            uint32_t Class;
+      };
+
+      constexpr uint32_t PfxGlyphCacheMagic = 0x48504C47; // "GLPH"
+      constexpr uint32_t PfxGlyphCacheVersion = 1;
+
+      struct PfxGlyphAtlasChanges {
+            bool bLanded;
+            bool bEvicted;
+      };
+
+      // quad and pen advance of a glyph class, in units of the font size
+      struct PfxGlyphMetrics {
+            glm::vec2 Quad;
+            float Advance;
+      };
+
+      // a text run laid out from its start, four vertices per glyph as DrawText writes them
+      struct PfxTextLayout {
+            std::wstring Text;
+            float Size;
+            float Space;
+            float Advance; // pen position after the last glyph, its spacing included
+            bool bResident; // false while any glyph is still being generated
+            std::vector<GenDrawVertexData> Vertices;
+      };
+
+      constexpr uint64_t PfxTextLayoutLifetime = 240; // frames a cached layout survives without being drawn
+
+      struct PfxGlyphScratch;
+
+      // font atlas filled on demand. a glyph is rasterized on the gfx task executor the first time it is drawn,
+      // shelf packed by cell size and uploaded as a single region. once the page is full the least recently drawn
+      // glyph of the same cell size that no frame in flight samples anymore gives its cell away.
+      // generated glyphs are kept in an on-disk cache, a later run packs them all at load instead of rasterizing again
+      class PfxGlyphAtlas {
       public:
-            entt::dense_map<wchar_t, FontUV> _fontUVs{};
+            NO_COPY_MOVE_CONS(PfxGlyphAtlas);
+
+            ~PfxGlyphAtlas();
+
+            explicit PfxGlyphAtlas() = default;
+
+            // format is VK_FORMAT_R8G8B8A8_UNORM or VK_FORMAT_R16G16B16A16_SFLOAT, an empty cache directory disables the cache
+            bool Init(GfxContext* gfx, const char* font_path, uint32_t page_size, VkFormat format, const std::filesystem::path& cache_directory);
+
+            // cached by (text, size, space) and rebuilt when its glyphs land or move, missing glyphs are queued
+            // and draw empty until they land. safe from every recording thread
+            std::shared_ptr<const PfxTextLayout> Layout(std::wstring_view text, float size, float space);
+
+            // queues every missing glyph of the set without drawing it, a charset can be warmed while the app starts
+            void Preload(std::wstring_view chars);
+
+            // marks the glyphs as drawn in that frame, retained draw lists replay them without asking for a layout
+            void Touch(std::span<const wchar_t> chars, uint64_t frame);
+
+            // packs and uploads the glyphs generated since the last call
+            PfxGlyphAtlasChanges Update();
+
+            [[nodiscard]] ResourceHandle GetTexture() const { return _texture; }
+
+            [[nodiscard]] uint32_t GetTextureBindlessIndex() const { return _textureBindlessIndex; }
+
+            static PfxGlyphClass Classify(wchar_t ch);
+
+            static glm::u16vec2 GetCellExtent(PfxGlyphClass glyph_class);
+
+            static const PfxGlyphMetrics& GetMetrics(PfxGlyphClass glyph_class);
+
+            static void BuildLayout(std::wstring_view text, float size, float space, const FontUV* uvs, PfxTextLayout& layout);
+
+      private:
+            struct Glyph {
+                  FontUV UV;
+                  glm::u16vec2 Cell;
+                  PfxGlyphClass Class;
+                  bool bResident;
+                  uint64_t LastUsedFrame;
+            };
+
+            struct Shelf {
+                  uint16_t Y;
+                  uint16_t Height;
+                  uint16_t Head;
+            };
+
+            struct CachedLayout {
+                  std::shared_ptr<const PfxTextLayout> Layout;
+                  uint64_t Evictions;
+                  uint64_t Landings;
+                  uint64_t LastUsedFrame;
+            };
+
+            // one uv per character, returns false if any of them is missing. _mutex is held
+            bool Resolve(std::wstring_view text, FontUV* out_uvs, uint64_t frame);
+
+            // a new entry of _glyphs, _mutex is held
+            void Request(wchar_t ch);
+
+            PfxGlyphBitmap Generate(wchar_t ch) const;
+
+            [[nodiscard]] PfxGlyphScratch& GetScratch() const;
+
+            void OpenCache(const std::filesystem::path& path, uint64_t key);
+
+            void AppendCache(const PfxGlyphBitmap& bitmap);
+
+            [[nodiscard]] PfxGlyphBitmap ReadCache(wchar_t ch, size_t offset) const;
+
+            void Place(const PfxGlyphBitmap& bitmap, glm::u16vec2 cell);
+
+            bool AllocateCell(glm::u16vec2 extent, glm::u16vec2& cell);
+
+            bool EvictCell(PfxGlyphClass glyph_class, uint64_t completed_frame, glm::u16vec2& cell);
+
+            [[nodiscard]] FontUV CellToUV(glm::u16vec2 cell, glm::u16vec2 extent) const;
+
+            [[nodiscard]] uint32_t GetTexelSize() const { return _format == VK_FORMAT_R16G16B16A16_SFLOAT ? 8 : 4; }
+
+      private:
+            GfxContext* _gfx{};
+
+            msdfgen::FreetypeHandle* _freetype{};
+
+            msdfgen::FontHandle* _font{};
+
+            std::vector<uint8_t> _fontData{}; // freetype reads the face from here
+
+            // one per executor worker and only touched by it: freetype faces can't load glyphs concurrently
+            mutable std::vector<std::unique_ptr<PfxGlyphScratch>> _scratch{};
+
+            double _scale = 1.0;
+
+            double _baseline{};
 
+            ResourceHandle _texture{};
+
+            VkFormat _format = VK_FORMAT_R8G8B8A8_UNORM;
+
+            uint32_t _textureBindlessIndex{};
+
+            uint16_t _pageSize{};
+
+            FontUV _blankUV{};
+
+            std::mutex _mutex{};
+
+            entt::dense_map<wchar_t, Glyph> _glyphs{};
+
+            entt::dense_map<uint64_t, CachedLayout> _layouts{};
+
+            uint64_t _evictions{};
+
+            uint64_t _landings{};
+
+            uint64_t _lastUpdateFrame{};
+
+            std::vector<Shelf> _shelves{};
+
+            uint16_t _shelfTop{};
+
+            moodycamel::ConcurrentQueue<PfxGlyphBitmap> _queueGenerated{};
+
+            // shared with the generation tasks, the last one may still notify after the destructor saw zero and freed the atlas
+            std::shared_ptr<std::atomic<uint32_t>> _pendingJobs = std::make_shared<std::atomic<uint32_t>>();
+
+            // the whole cache file plus what was appended since, records are located by char
+            std::vector<uint8_t> _cacheData{};
+
+            entt::dense_map<wchar_t, size_t> _cacheIndex{};
+
+            std::ofstream _cacheFile{};
       };
 
-      class PfxContext {
-            static inline PfxContext* _instance;
+      // record time culling of the current frame, draw list recordings included
+      struct PfxCullStats {
+            uint32_t EmittedPrimitives;
+            uint32_t CulledPrimitives;
+            uint32_t EmittedTextRuns;
+            uint32_t CulledTextRuns;
+      };
 
+      class PfxContext;
+
+      // records primitives for a canvas. the canvas owns one for its immediate draws, every sub canvas owns
+      // another with host-side records so it can be filled from its own thread; they only share the canvas' font data
+      class PfxRecorder {
       public:
+            NO_COPY_MOVE_CONS(PfxRecorder);
 
-            NO_COPY_MOVE_CONS(PfxContext);
+            PfxRecorder(PfxContext* canvas, PfxRecordTarget* records);
 
-            ~PfxContext();
+            PfxRecorder(PfxContext* canvas, int32_t order);
 
-            explicit PfxContext();
+            [[nodiscard]] PfxContext* GetCanvas() const { return _canvas; }
+
+            [[nodiscard]] int32_t GetOrder() const { return _order; }
+
+            [[nodiscard]] const PfxRecordTarget& GetRecords() const { return *_records; }
 
-            bool GenAndLoadFont(const char* path);
+            [[nodiscard]] const PfxCullStats& GetCullStats() const { return _stats; }
 
-            [[nodiscard]] ResourceHandle GetAtlas() const { return _fontAtlas; }
+            void Reset();
 
             void PushCanvasSize(glm::u16vec2 size);
 
@@ -223,60 +608,125 @@ namespace LoFi {
 
             void DrawText(glm::vec2 start, const wchar_t* text, PParamText param, glm::u8vec4 color); //CPU
 
+            void BeginDrawList(PfxDrawList* list); // Draw* record into the list until EndDrawList
+
+            void EndDrawList();
+
+            void DrawList(PfxDrawList* list, glm::vec2 offset = {0, 0}, glm::vec2 scale = {1, 1}, glm::u8vec4 tint = {255, 255, 255, 255},
+                  glm::u16vec4 clip = {0, 0, UINT16_MAX, UINT16_MAX});
+
             //特殊 规则
 
             //void DrawPoints(); // CS  CPoint
 
+      private:
+            friend class PfxContext;
 
-            void Reset();
+            GenInstanceData& NewDrawInstanceData();
 
-            void EmitDrawCommand(RenderNode* node);
+            GenInstanceData& NewSDFInstanceData();
 
-            void DispatchGenerateCommands() const;
+            void AppendDrawBatch(PfxDrawBatchType type, uint32_t first);
 
-            ResourceHandle _fontAtlas {};
+            // conservative, drops what lies fully outside the current scissor or canvas
+            bool IsCulled(glm::vec2 center, glm::vec2 size, float rotation, bool text);
 
-            uint32_t _fontAtlasTextureBindlessIndex {};
       private:
-            GenInstanceData& NewDrawInstanceData();
+            PfxContext* _canvas {};
 
-      private:
-            GfxContext* _gfx {};
+            std::unique_ptr<PfxRecordTarget> _ownedRecords{};
+
+            PfxRecordTarget* _records {}; // frame records of this recorder
+
+            PfxRecordTarget* _target {}; // _records, or the draw list being recorded
 
-            VkExtent2D _fontAtlasSize {};
+            PfxDrawList* _recordingList {};
 
-            entt::dense_map<wchar_t, FontUV> _fontUVs{};
+            int32_t _order {};
+
+            PfxCullStats _stats {};
+
+            std::vector<FontUV> _glyphScratch{};
 
             glm::u16vec4 _currentScissor{};
             glm::u16vec2 _currentCanvasSize{};
             StrockTypeParameter _currentStrock{};
 
-      private:
             std::vector<glm::u16vec4> _scissorStack{};
             std::vector<glm::u16vec2> _canvasSizeStack{};
             std::vector<StrockTypeParameter> _strockStack{};
             std::vector<ShadowParameter> _shadowStack{};
+      };
+
+      class PfxContext {
+      public:
+
+            NO_COPY_MOVE_CONS(PfxContext);
+
+            ~PfxContext();
+
+            explicit PfxContext();
 
+            bool GenAndLoadFont(const char* path, VkFormat atlas_format = VK_FORMAT_R8G8B8A8_UNORM, const char* cache_directory = nullptr);
 
-            std::vector<GenDrawVertexData> _vertexData{};
-            std::vector<uint32_t> _indexData{};
+            [[nodiscard]] ResourceHandle GetAtlas() const { return _glyphAtlas ? _glyphAtlas->GetTexture() : ResourceHandle{}; }
 
-            std::vector<GradientData> _gradientData{};
+            void PreloadGlyphs(const wchar_t* chars);
 
-            std::vector<GenInstanceData> _instanceData{};
-            std::vector<VkDrawIndexedIndirectCommand> _indirectData{};
+            // width and height DrawText would cover, the spacing after the last glyph excluded
+            [[nodiscard]] glm::vec2 MeasureText(const wchar_t* text, PParamText param);
 
-            ResourceHandle _bufferVertex[3] {};
-            ResourceHandle _bufferIndex[3] {};
-            ResourceHandle _bufferInstance[3] {};
-            ResourceHandle _bufferIndirect[3] {};
-            ResourceHandle _bufferGradient[3] {};
+            [[nodiscard]] PfxRecorder* GetRecorder() { return &_recorder; }
 
-            entt::dense_set<ResourceHandle, Internal::HashResourceHandle, Internal::EqualResourceHandle> _sampledImageReference[3]{};
+            // sub canvases are merged after the canvas' own draws ordered by (order, creation), negative orders go below them
+            PfxRecorder* CreateSubCanvas(int32_t order);
+
+            void DestroySubCanvas(PfxRecorder* sub_canvas);
+
+            PfxDrawList* CreateDrawList();
+
+            void DestroyDrawList(PfxDrawList* list);
+
+            [[nodiscard]] PfxCullStats GetCullStats() const; // summed over the canvas and its sub canvases
+
+            void Reset();
+
+            void EmitDrawCommand(RenderNode* node);
+
+            // merges the sub canvases into the frame streams, every recording thread must be done by now
+            void DispatchGenerateCommands();
+
+      private:
+            friend class PfxRecorder;
+
+            void MergeRecords(const PfxRecordTarget& src, std::vector<PfxDrawBatch>& batches);
+
+            void EmitBatch(RenderNode* node, const PfxDrawBuffers& buffers, const PfxDrawBatch& batch, const PfxDrawConstant& constant) const;
+
+      private:
+            GfxContext* _gfx {};
+
+            std::unique_ptr<PfxGlyphAtlas> _glyphAtlas{};
+
+      private:
+            PfxRecordTarget _frameTarget{};
+
+            PfxRecorder _recorder;
+
+            std::vector<std::unique_ptr<PfxRecorder>> _subCanvases{};
+
+            bool _bSubCanvasesMerged = false;
+
+            entt::dense_set<PfxDrawList*> _drawLists{};
 
       private:
             ResourceHandle _programDraw {};
             ResourceHandle _kernelDraw {};
+            ResourceHandle _programDrawSDF {};
+            ResourceHandle _kernelDrawSDF {};
+
+            GfxInfoKernelLayout _layoutDraw {};
+            GfxInfoKernelLayout _layoutDrawSDF {};
 
             ResourceHandle _renderNodeResource {};
 
@@ -285,7 +735,5 @@ namespace LoFi {
             //tf::Taskflow _taskFlowDispatch{};
 
             const float _pixelExpand = 20;
-
-            entt::dense_set<wchar_t> _fontDOT{};
       };
 };
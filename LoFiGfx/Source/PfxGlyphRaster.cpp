@@ -0,0 +1,92 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#include "PfxGlyphRaster.h"
+
+#include <array>
+#include <cctype>
+
+#include "../Third/msdfgen/msdfgen.h"
+#include "../Third/msdfgen/msdfgen-ext.h"
+#include "glm/gtc/packing.hpp"
+
+using namespace LoFi;
+
+PfxGlyphClass LoFi::PfxClassifyGlyph(wchar_t ch) {
+      //ascii is classified once, not with four ctype calls per character
+      static const auto ascii = [] {
+            std::array<PfxGlyphClass, 0x80> table{};
+            for (int c = 0; c < 0x80; c++) {
+                  if (c == ',' || c == '.' || c == '_') {
+                        table[c] = PfxGlyphClass::Dot;
+                  } else if (std::isalpha(c) || std::isdigit(c) || std::isspace(c) || std::ispunct(c)) {
+                        table[c] = PfxGlyphClass::Narrow;
+                  } else {
+                        table[c] = PfxGlyphClass::Full;
+                  }
+            }
+            return table;
+      }();
+      return (uint32_t)ch < 0x80 ? ascii[(uint32_t)ch] : PfxGlyphClass::Full;
+}
+
+glm::u16vec2 LoFi::PfxGetGlyphCellExtent(PfxGlyphClass glyph_class) {
+      switch (glyph_class) {
+            case PfxGlyphClass::Dot: return {16, 16};
+            case PfxGlyphClass::Narrow: return {16, 32};
+            default: return {32, 32};
+      }
+}
+
+bool LoFi::PfxRasterizeGlyph(msdfgen::FontHandle* font, wchar_t ch, PfxGlyphClass glyph_class, double scale, double baseline, float* mtsdf) {
+      msdfgen::Shape shape{};
+      if (!font || !msdfgen::loadGlyph(shape, font, ch, msdfgen::FONT_SCALING_LEGACY)) return false;
+      if (shape.contours.empty()) return false; // whitespace, the cell stays blank
+
+      msdfgen::edgeColoringSimple(shape, 3.0);
+      shape.normalize();
+      const auto bounds = shape.getBounds();
+
+      msdfgen::Vector2 frame{};
+      if (glyph_class == PfxGlyphClass::Dot) {
+            frame = msdfgen::Vector2(10, 10);
+      } else if (glyph_class == PfxGlyphClass::Narrow) {
+            frame = msdfgen::Vector2(16, 32);
+      } else {
+            frame = msdfgen::Vector2(32, 32);
+      }
+
+      msdfgen::Range pxRange(4);
+      frame += 2 * pxRange.lower;
+      msdfgen::Vector2 translate;
+      const msdfgen::Vector2 s(scale);
+      const msdfgen::Vector2 dims(bounds.r - bounds.l, bounds.t - bounds.b);
+
+      if (dims.x * frame.y < dims.y * frame.x) {
+            translate.set(.5 * (frame.x / frame.y * dims.y - dims.x) - bounds.l, -baseline);
+      } else {
+            translate.set(-bounds.l, -baseline);
+      }
+      translate -= pxRange.lower / s;
+      const msdfgen::Range range = pxRange / glm::min(s.x, s.y);
+      const msdfgen::SDFTransformation ts(msdfgen::Projection(s, translate), range);
+
+      const auto extent = PfxGetGlyphCellExtent(glyph_class);
+      msdfgen::generateMTSDF(msdfgen::BitmapRef<float, 4>(mtsdf, extent.x, extent.y), shape, ts);
+      return true;
+}
+
+void LoFi::PfxQuantizeGlyph(const float* mtsdf, size_t channels, bool half, uint8_t* texels) {
+      //the distances only matter around the 0.5 edge so clamping to [0, 1] loses nothing
+      if (half) {
+            auto out = reinterpret_cast<uint16_t*>(texels);
+            for (size_t i = 0; i < channels; i++) {
+                  out[i] = glm::packHalf1x16(glm::clamp(mtsdf[i], 0.0f, 1.0f));
+            }
+      } else {
+            for (size_t i = 0; i < channels; i++) {
+                  texels[i] = (uint8_t)(glm::clamp(mtsdf[i], 0.0f, 1.0f) * 255.0f + 0.5f);
+            }
+      }
+}
@@ -0,0 +1,35 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "glm/glm.hpp"
+
+namespace msdfgen {
+      class FontHandle;
+}
+
+// glyph rasterization of the font atlas, kept free of the gfx context so tools can measure the exact atlas output
+namespace LoFi {
+
+      // cell a glyph is rasterized into: 16x16, 16x32 or 32x32
+      enum class PfxGlyphClass : uint8_t {
+            Dot,
+            Narrow,
+            Full
+      };
+
+      PfxGlyphClass PfxClassifyGlyph(wchar_t ch);
+
+      glm::u16vec2 PfxGetGlyphCellExtent(PfxGlyphClass glyph_class);
+
+      // MTSDF of ch over the whole cell of its class, mtsdf holds extent.x * extent.y * 4 floats.
+      // false for a missing glyph or whitespace, mtsdf is left untouched then
+      bool PfxRasterizeGlyph(msdfgen::FontHandle* font, wchar_t ch, PfxGlyphClass glyph_class, double scale, double baseline, float* mtsdf);
+
+      // into the atlas texels, 8 bytes a texel for RGBA16F, 4 for RGBA8
+      void PfxQuantizeGlyph(const float* mtsdf, size_t channels, bool half, uint8_t* texels);
+}
@@ -32,7 +32,22 @@ PhysicalDevice::PhysicalDevice(VkPhysicalDevice physicalDevice) {
       _descriptorIndexingFeatures.pNext = &_vulkan11Features;
 
       _vulkan11Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES;
-      _vulkan11Features.pNext = &_dynamicRenderingFeatures;
+      _vulkan11Features.pNext = &_vulkan12Features;
+
+      _vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+      _vulkan12Features.pNext = &_shaderFloat16Int8Features;
+
+      _shaderFloat16Int8Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_FLOAT16_INT8_FEATURES;
+      _shaderFloat16Int8Features.pNext = &_storage8BitFeatures;
+
+      _storage8BitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_8BIT_STORAGE_FEATURES;
+      _storage8BitFeatures.pNext = &_shaderAtomicInt64Features;
+
+      _shaderAtomicInt64Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_ATOMIC_INT64_FEATURES;
+      _shaderAtomicInt64Features.pNext = &_subgroupExtendedTypesFeatures;
+
+      _subgroupExtendedTypesFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_SUBGROUP_EXTENDED_TYPES_FEATURES;
+      _subgroupExtendedTypesFeatures.pNext = &_dynamicRenderingFeatures;
 
       _dynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
       _dynamicRenderingFeatures.pNext = &_synchronization2Features;
@@ -53,6 +68,11 @@ PhysicalDevice::PhysicalDevice(VkPhysicalDevice physicalDevice) {
       _bufferDeviceAddressFeatures.pNext = nullptr;
       _descriptorIndexingFeatures.pNext = nullptr;
       _vulkan11Features.pNext = nullptr;
+      _vulkan12Features.pNext = nullptr;
+      _shaderFloat16Int8Features.pNext = nullptr;
+      _storage8BitFeatures.pNext = nullptr;
+      _shaderAtomicInt64Features.pNext = nullptr;
+      _subgroupExtendedTypesFeatures.pNext = nullptr;
       _dynamicRenderingFeatures.pNext = nullptr;
       _synchronization2Features.pNext = nullptr;
       _meshShaderFeatures.pNext = nullptr;
@@ -73,7 +93,10 @@ PhysicalDevice::PhysicalDevice(VkPhysicalDevice physicalDevice) {
       _descriptorIndexingProperties.pNext = &_vulkan11Properties;
 
       _vulkan11Properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_PROPERTIES;
-      _vulkan11Properties.pNext = &_meshShaderProperties;
+      _vulkan11Properties.pNext = &_subgroupSizeControlProperties;
+
+      _subgroupSizeControlProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_SIZE_CONTROL_PROPERTIES;
+      _subgroupSizeControlProperties.pNext = &_meshShaderProperties;
 
       _meshShaderProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_PROPERTIES_EXT;
       _meshShaderProperties.pNext = &_fragmentShadingRateProperties;
@@ -84,6 +107,14 @@ PhysicalDevice::PhysicalDevice(VkPhysicalDevice physicalDevice) {
 
       vkGetPhysicalDeviceProperties2(physicalDevice, &_properties2);
 
+      _properties2.pNext = nullptr;
+      _rayTracingPipelineProperties.pNext = nullptr;
+      _accelerationStructureProperties.pNext = nullptr;
+      _descriptorIndexingProperties.pNext = nullptr;
+      _vulkan11Properties.pNext = nullptr;
+      _subgroupSizeControlProperties.pNext = nullptr;
+      _meshShaderProperties.pNext = nullptr;
+
       vkGetPhysicalDeviceMemoryProperties2(physicalDevice, &_memoryProperties2);
 }
 
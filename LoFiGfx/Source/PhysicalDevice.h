@@ -42,6 +42,18 @@ public:
 
       VkPhysicalDeviceVulkan11Properties _vulkan11Properties{};
 
+      VkPhysicalDeviceVulkan12Features _vulkan12Features{};
+
+      VkPhysicalDeviceShaderFloat16Int8Features _shaderFloat16Int8Features{};
+
+      VkPhysicalDevice8BitStorageFeatures _storage8BitFeatures{};
+
+      VkPhysicalDeviceShaderAtomicInt64Features _shaderAtomicInt64Features{};
+
+      VkPhysicalDeviceShaderSubgroupExtendedTypesFeatures _subgroupExtendedTypesFeatures{};
+
+      VkPhysicalDeviceSubgroupSizeControlProperties _subgroupSizeControlProperties{};
+
       VkPhysicalDeviceDynamicRenderingFeaturesKHR _dynamicRenderingFeatures{};
 
       VkPhysicalDeviceSynchronization2FeaturesKHR _synchronization2Features{};
@@ -16,6 +16,18 @@
 using namespace LoFi;
 using namespace LoFi::Internal;
 
+// result order follows the bit order, see RenderNodeQueryFrame::StatisticsCount
+static constexpr VkQueryPipelineStatisticFlags RenderNodeStatisticsFlags =
+VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT |
+VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT |
+VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT |
+VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+
+static constexpr uint32_t RenderNodeQueryInitialCapacity = 16;
+
 RenderNodeFrameCommand::RenderNodeFrameCommand(const std::string& name) {
       _nodeName = name;
       VkCommandPoolCreateInfo command_pool_ci{};
@@ -125,6 +137,9 @@ RenderNode::RenderNode(entt::entity id, const std::string& name) : _id(id), _nod
 }
 
 RenderNode::~RenderNode() {
+      for (auto& frame : _queryFrames) {
+            DestroyQueryPools(frame);
+      }
       _frameCommand[0].reset();
       _frameCommand[1].reset();
       _frameCommand[2].reset();
@@ -147,6 +162,7 @@ void RenderNode::CmdBeginComputePass() {
       }
       _currentPassType = GfxEnumKernelType::COMPUTE;
       BeginSecondaryCommandBuffer();
+      BeginPassQueries(false);
 }
 
 void RenderNode::CmdEndComputePass() {
@@ -158,8 +174,10 @@ void RenderNode::CmdEndComputePass() {
       }
 
       _currentKernel = {};
+      _currentPipeline = VK_NULL_HANDLE;
       _currentPassType = GfxEnumKernelType::OUT_OF_KERNEL;
-     EndSecondaryCommandBuffer();
+      EndPassQueries();
+      EndSecondaryCommandBuffer();
 }
 
 void RenderNode::CmdComputeDispatch(uint32_t x, uint32_t y, uint32_t z) const {
@@ -173,6 +191,47 @@ void RenderNode::CmdComputeDispatch(uint32_t x, uint32_t y, uint32_t z) const {
 }
 
 
+void RenderNode::CmdComputeDispatchIndirect(ResourceHandle indirect_buffer, size_t offset) {
+      if (_currentPassType != GfxEnumKernelType::COMPUTE) {
+            std::string err = "[RenderNode::CmdComputeDispatchIndirect] Not in a compute pass, dispatch failed.";
+            err += std::format(" - Node: \"{}\"", _nodeName);
+            MessageManager::Log(MessageType::Error, err);
+            return;
+      }
+
+      auto* buf = FetchBufferObject(indirect_buffer, "CmdComputeDispatchIndirect");
+      if (!buf) return;
+
+      BarrierBuffer(buf, GfxEnumKernelType::COMPUTE, GfxEnumResourceUsage::INDIRECT_BUFFER);
+      vkCmdDispatchIndirect(_current, buf->GetBuffer(), offset);
+}
+
+void RenderNode::CmdComputeBarrier(bool full) const {
+      if (_currentPassType != GfxEnumKernelType::COMPUTE) {
+            std::string err = "[RenderNode::CmdComputeBarrier] Not in a compute pass, barrier failed.";
+            err += std::format(" - Node: \"{}\"", _nodeName);
+            MessageManager::Log(MessageType::Error, err);
+            return;
+      }
+
+      const VkMemoryBarrier2 barrier{
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+            .srcStageMask = full ? VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT : VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+            .srcAccessMask = full ? VK_ACCESS_2_MEMORY_WRITE_BIT : VK_ACCESS_2_SHADER_WRITE_BIT,
+            .dstStageMask = full ? VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT : VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT,
+            .dstAccessMask = full ? VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT
+                  : VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT | VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT
+      };
+
+      const VkDependencyInfo dependency{
+            .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+            .memoryBarrierCount = 1,
+            .pMemoryBarriers = &barrier
+      };
+
+      vkCmdPipelineBarrier2(_current, &dependency);
+}
+
 void RenderNode::CmdBeginRenderPass(const GfxParamBeginRenderPass& param) {
       if (_currentPassType != GfxEnumKernelType::OUT_OF_KERNEL) {
             std::string err = "[RenderNode::CmdBeginRenderPass] Already in a pass, Please end it first, Begin Render Pass Failed.";
@@ -208,6 +267,8 @@ void RenderNode::CmdBeginRenderPass(const GfxParamBeginRenderPass& param) {
       VkRenderingAttachmentInfo _frameRenderingDepthAttachment{};
 
       _frameRenderingRenderArea = {};
+      _passRenderState = {};
+      _cullOverride = GfxEnumCullOverride::PROGRAM;
 
       _currentPassType = GfxEnumKernelType::GRAPHICS;
       BeginSecondaryCommandBuffer();
@@ -218,7 +279,7 @@ void RenderNode::CmdBeginRenderPass(const GfxParamBeginRenderPass& param) {
             Component::Gfx::Texture* texture;
             if (info.TextureHandle.Type == GfxEnumResourceType::Texture2D ) {
                   texture = GfxContext::Get()->ResourceFetch<Component::Gfx::Texture>(std::bit_cast<ResourceHandle>(info.TextureHandle));
-                  if (!texture) {
+                  if (!texture || !texture->IsResident()) {
                         auto err = std::format("[RenderNode::CmdBeginRenderPass] Invalid Texture2D handle, index at {}.", i);
                         err += std::format(" - Node: \"{}\"", _nodeName);
                         MessageManager::Log(MessageType::Error, err);
@@ -269,6 +330,10 @@ void RenderNode::CmdBeginRenderPass(const GfxParamBeginRenderPass& param) {
                   };
 
                   _frameRenderingColorAttachments.push_back(render_attachment_info);
+                  if (_passRenderState.ColorCount < Component::Gfx::KernelRenderState::MaxColorAttachments) {
+                        _passRenderState.ColorFormats[_passRenderState.ColorCount++] = texture->GetFormat();
+                  }
+                  _passRenderState.Samples = texture->GetSampleCount();
                   render_info.colorAttachmentCount = _frameRenderingColorAttachments.size();
                   render_info.pColorAttachments = _frameRenderingColorAttachments.data();
             } else if (texture->IsTextureFormatDepthOnly()) {
@@ -285,6 +350,9 @@ void RenderNode::CmdBeginRenderPass(const GfxParamBeginRenderPass& param) {
 
                   render_info.pDepthAttachment = &_frameRenderingDepthAttachment;
                   render_info.pStencilAttachment = nullptr;
+                  _passRenderState.DepthFormat = texture->GetFormat();
+                  _passRenderState.StencilFormat = VK_FORMAT_UNDEFINED;
+                  _passRenderState.Samples = texture->GetSampleCount();
             } else if (texture->IsTextureFormatDepthStencilOnly()) {
                   //Depth Stencil
                   BarrierTexture(texture, GfxEnumKernelType::GRAPHICS, GfxEnumResourceUsage::DEPTH_STENCIL);
@@ -299,6 +367,9 @@ void RenderNode::CmdBeginRenderPass(const GfxParamBeginRenderPass& param) {
 
                   render_info.pDepthAttachment = &_frameRenderingDepthStencilAttachment;
                   render_info.pStencilAttachment = &_frameRenderingDepthStencilAttachment;
+                  _passRenderState.DepthFormat = texture->GetFormat();
+                  _passRenderState.StencilFormat = texture->GetFormat();
+                  _passRenderState.Samples = texture->GetSampleCount();
             } else {
                   auto err = std::format("[RenderNode::CmdBeginRenderPass] Invalid texture format, format = {}, create render pass failed, index at {}.", ToStringVkFormat(texture->GetFormat()), i);
                   err += std::format(" - Node: \"{}\"", _nodeName);
@@ -308,6 +379,7 @@ void RenderNode::CmdBeginRenderPass(const GfxParamBeginRenderPass& param) {
       }
 
       render_info.renderArea = _frameRenderingRenderArea;
+      BeginPassQueries(true);
       vkCmdBeginRenderingKHR(_current, &render_info);
 }
 
@@ -319,14 +391,14 @@ void RenderNode::CmdEndRenderPass() {
             return;
       }
       vkCmdEndRendering(_current);
+      EndPassQueries();
       EndSecondaryCommandBuffer();
       _currentKernel = {};
+      _currentPipeline = VK_NULL_HANDLE;
       _currentPassType = GfxEnumKernelType::OUT_OF_KERNEL;
 }
 
 void RenderNode::CmdBindKernel(ResourceHandle kernel) {
-      if (_currentKernel.RHandle == kernel.RHandle) return;
-
       if (kernel.Type != GfxEnumResourceType::Kernel) {
             auto err = std::format("[RenderNode::CmdBindKernel] Invalid Resource Type, Need a Kernel, but got {}.", ToStringResourceType(kernel.Type));
             err += std::format(" - Node: \"{}\"", _nodeName);
@@ -349,10 +421,16 @@ void RenderNode::CmdBindKernel(ResourceHandle kernel) {
                   MessageManager::Log(MessageType::Error, err);
                   return;
             }
-            vkCmdBindPipeline(_current, VK_PIPELINE_BIND_POINT_COMPUTE, kernel_ptr->GetPipeline());
-            vkCmdBindDescriptorSets(_current, VK_PIPELINE_BIND_POINT_COMPUTE, kernel_ptr->GetPipelineLayout(),
-            0, 1, &GfxContext::Get()->_bindlessDescriptorSet, 0, nullptr);
-            kernel_ptr->CmdPushConstants(_current);
+
+            //same kernel with the same specialization variant
+            const VkPipeline pipeline = kernel_ptr->GetPipeline();
+            if (_currentKernel.RHandle == kernel.RHandle && _currentPipeline == pipeline) return;
+
+            vkCmdBindPipeline(_current, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+            BindBindlessDescriptorSet(VK_PIPELINE_BIND_POINT_COMPUTE, kernel_ptr->GetPipelineLayout(), kernel_ptr->GetPushConstantRange());
+            const auto push_data = kernel_ptr->GetDefaultPushConstantData();
+            PushConstantFiltered(kernel_ptr->GetPipelineLayout(), kernel_ptr->GetPushConstantRange(), 0, push_data.size(), push_data.data());
+            _currentPipeline = pipeline;
       } else if (kernel_ptr->IsGraphicsKernel()) {
             if (_currentPassType != GfxEnumKernelType::GRAPHICS) {
                   std::string err = "[RenderNode::CmdBindKernel] Graphics kernel must be used in Render Pass.";
@@ -360,13 +438,27 @@ void RenderNode::CmdBindKernel(ResourceHandle kernel) {
                   MessageManager::Log(MessageType::Error, err);
                   return;
             }
-            vkCmdBindPipeline(_current, VK_PIPELINE_BIND_POINT_GRAPHICS, kernel_ptr->GetPipeline());
-            vkCmdBindDescriptorSets(_current, VK_PIPELINE_BIND_POINT_GRAPHICS, kernel_ptr->GetPipelineLayout(), 0, 1, &GfxContext::Get()->_bindlessDescriptorSet, 0, nullptr);
-            const auto viewport = VkViewport{0, (float)_frameRenderingRenderArea.extent.height, (float)_frameRenderingRenderArea.extent.width, -(float)_frameRenderingRenderArea.extent.height, 0, 1};
-            vkCmdSetViewport(_current, 0, 1, &viewport);
-            const auto scissor = VkRect2D{0, 0, _frameRenderingRenderArea.extent.width, _frameRenderingRenderArea.extent.height};
-            vkCmdSetScissor(_current, 0, 1, &scissor);
-            kernel_ptr->CmdPushConstants(_current);
+
+            //variant for the current attachments, blend override and specialization
+            const VkPipeline pipeline = kernel_ptr->FetchPipeline(_passRenderState);
+            if (!pipeline) {
+                  std::string err = "[RenderNode::CmdBindKernel] Failed to create pipeline variant for the current render pass.";
+                  err += std::format(" - Node: \"{}\"", _nodeName);
+                  MessageManager::Log(MessageType::Error, err);
+                  return;
+            }
+            if (_currentKernel.RHandle == kernel.RHandle && _currentPipeline == pipeline) return;
+
+            vkCmdBindPipeline(_current, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+            BindBindlessDescriptorSet(VK_PIPELINE_BIND_POINT_GRAPHICS, kernel_ptr->GetPipelineLayout(), kernel_ptr->GetPushConstantRange());
+            CmdSetViewportAuto(true);
+            CmdSetScissorAuto();
+            _currentKernelCullMode = kernel_ptr->GetDefaultCullMode();
+            _currentKernelFrontFace = kernel_ptr->GetDefaultFrontFace();
+            SetRasterState();
+            const auto push_data = kernel_ptr->GetDefaultPushConstantData();
+            PushConstantFiltered(kernel_ptr->GetPipelineLayout(), kernel_ptr->GetPushConstantRange(), 0, push_data.size(), push_data.data());
+            _currentPipeline = pipeline;
       } else {
             std::string err = "[RenderNode::CmdBindKernel] this kernel is not a graphics kernel or compute kernel.";
             err += std::format(" - Node: \"{}\"", _nodeName);
@@ -377,6 +469,61 @@ void RenderNode::CmdBindKernel(ResourceHandle kernel) {
       _currentKernel = kernel;
 }
 
+void RenderNode::CmdSetBlendOverride(GfxEnumBlendOverride blend) {
+      if (_currentPassType != GfxEnumKernelType::GRAPHICS) {
+            std::string err = "[RenderNode::CmdSetBlendOverride] Not in a RenderPass, please use CmdBeginRenderPass first.";
+            err += std::format(" - Node: \"{}\"", _nodeName);
+            MessageManager::Log(MessageType::Error, err);
+            return;
+      }
+
+      if (_passRenderState.Blend == blend) return;
+      _passRenderState.Blend = blend;
+
+      //rebind the current kernel with the matching variant
+      if (_currentKernel.RHandle != entt::null) {
+            const auto kernel = _currentKernel;
+            _currentKernel = {};
+            CmdBindKernel(kernel);
+      }
+}
+
+void RenderNode::CmdSetCullOverride(GfxEnumCullOverride cull) {
+      if (_currentPassType != GfxEnumKernelType::GRAPHICS) {
+            std::string err = "[RenderNode::CmdSetCullOverride] Not in a RenderPass, please use CmdBeginRenderPass first.";
+            err += std::format(" - Node: \"{}\"", _nodeName);
+            MessageManager::Log(MessageType::Error, err);
+            return;
+      }
+
+      _cullOverride = cull;
+      if (_currentKernel.RHandle != entt::null) SetRasterState();
+}
+
+void RenderNode::SetRasterState() {
+      VkCullModeFlags cull_mode = _currentKernelCullMode;
+      switch (_cullOverride) {
+            case GfxEnumCullOverride::NONE: cull_mode = VK_CULL_MODE_NONE;
+                  break;
+            case GfxEnumCullOverride::FRONT: cull_mode = VK_CULL_MODE_FRONT_BIT;
+                  break;
+            case GfxEnumCullOverride::BACK: cull_mode = VK_CULL_MODE_BACK_BIT;
+                  break;
+            default: break;
+      }
+
+      if (!_commandState.RasterValid || _commandState.CullMode != cull_mode) {
+            vkCmdSetCullMode(_current, cull_mode);
+      }
+      if (!_commandState.RasterValid || _commandState.FrontFace != _currentKernelFrontFace) {
+            vkCmdSetFrontFace(_current, _currentKernelFrontFace);
+      }
+
+      _commandState.RasterValid = true;
+      _commandState.CullMode = cull_mode;
+      _commandState.FrontFace = _currentKernelFrontFace;
+}
+
 void RenderNode::CmdBindVertexBuffer(ResourceHandle vertex_bufer, uint32_t first_binding, uint32_t binding_count, size_t offset) {
       if (vertex_bufer.Type == GfxEnumResourceType::Buffer) {
             auto* buf = GfxContext::Get()->ResourceFetch<Component::Gfx::Buffer>(vertex_bufer);
@@ -387,8 +534,17 @@ void RenderNode::CmdBindVertexBuffer(ResourceHandle vertex_bufer, uint32_t first
                   return;
 
             }
+            if (binding_count == 1 && first_binding < RenderNodeCommandState::MaxVertexBindings
+                  && _commandState.VertexBuffers[first_binding] == buf->GetBuffer() && _commandState.VertexOffsets[first_binding] == offset) {
+                  _filterStats.FilteredVertexBufferBinds++;
+                  return;
+            }
             BarrierBuffer(buf, GfxEnumKernelType::GRAPHICS, GfxEnumResourceUsage::VERTEX_BUFFER);
             vkCmdBindVertexBuffers(_current, first_binding, binding_count, buf->GetBufferPtr(), &offset);
+            if (binding_count == 1 && first_binding < RenderNodeCommandState::MaxVertexBindings) {
+                  _commandState.VertexBuffers[first_binding] = buf->GetBuffer();
+                  _commandState.VertexOffsets[first_binding] = offset;
+            }
       } else if (vertex_bufer.Type == GfxEnumResourceType::Buffer3F) {
             auto* buf = GfxContext::Get()->ResourceFetch<Component::Gfx::Buffer3F>(vertex_bufer);
             if (!buf) {
@@ -397,8 +553,17 @@ void RenderNode::CmdBindVertexBuffer(ResourceHandle vertex_bufer, uint32_t first
                   MessageManager::Log(MessageType::Error, err);
                   return;
             }
+            if (binding_count == 1 && first_binding < RenderNodeCommandState::MaxVertexBindings
+                  && _commandState.VertexBuffers[first_binding] == buf->GetBuffer() && _commandState.VertexOffsets[first_binding] == offset) {
+                  _filterStats.FilteredVertexBufferBinds++;
+                  return;
+            }
             BarrierBuffer(buf->GetBufferObject(), GfxEnumKernelType::GRAPHICS, GfxEnumResourceUsage::VERTEX_BUFFER);
             vkCmdBindVertexBuffers(_current, first_binding, binding_count, buf->GetBufferPtr(), &offset);
+            if (binding_count == 1 && first_binding < RenderNodeCommandState::MaxVertexBindings) {
+                  _commandState.VertexBuffers[first_binding] = buf->GetBuffer();
+                  _commandState.VertexOffsets[first_binding] = offset;
+            }
       } else {
             auto err = std::format("[FrameGraph::BindVertexBuffer] Invalid Resource Type, Need a Buffer or Buffer3F, but got {}.", ToStringResourceType(vertex_bufer.Type));
             err += std::format(" - Node: \"{}\"", _nodeName);
@@ -416,8 +581,14 @@ void RenderNode::CmdBindIndexBuffer(ResourceHandle index_buffer, size_t offset)
                   MessageManager::Log(MessageType::Error, err);
                   return;
             }
+            if (_commandState.IndexBuffer == buf->GetBuffer() && _commandState.IndexOffset == offset) {
+                  _filterStats.FilteredIndexBufferBinds++;
+                  return;
+            }
             BarrierBuffer(buf, GfxEnumKernelType::GRAPHICS, GfxEnumResourceUsage::INDEX_BUFFER);
             vkCmdBindIndexBuffer(_current, buf->GetBuffer(), offset, VK_INDEX_TYPE_UINT32);
+            _commandState.IndexBuffer = buf->GetBuffer();
+            _commandState.IndexOffset = offset;
       } else if (index_buffer.Type == GfxEnumResourceType::Buffer3F) {
             const auto* buf = GfxContext::Get()->ResourceFetch<Component::Gfx::Buffer3F>(index_buffer);
             if (!buf) {
@@ -426,8 +597,14 @@ void RenderNode::CmdBindIndexBuffer(ResourceHandle index_buffer, size_t offset)
                   MessageManager::Log(MessageType::Error, err);
                   return;
             }
+            if (_commandState.IndexBuffer == buf->GetBuffer() && _commandState.IndexOffset == offset) {
+                  _filterStats.FilteredIndexBufferBinds++;
+                  return;
+            }
             BarrierBuffer(buf->GetBufferObject(), GfxEnumKernelType::GRAPHICS, GfxEnumResourceUsage::INDEX_BUFFER);
             vkCmdBindIndexBuffer(_current, buf->GetBuffer(), offset, VK_INDEX_TYPE_UINT32);
+            _commandState.IndexBuffer = buf->GetBuffer();
+            _commandState.IndexOffset = offset;
       } else {
             auto err = std::format("[RenderNode::CmdBindIndexBuffer] Invalid Resource Type, Need a Buffer or Buffer3F, but got {}.", ToStringResourceType(index_buffer.Type));
             err += std::format(" - Node: \"{}\"", _nodeName);
@@ -465,6 +642,46 @@ void RenderNode::CmdDrawIndexedIndirect(ResourceHandle indirect_buffer, size_t o
       }
 }
 
+bool RenderNode::CheckIndirectCountDraw(const char* command) const {
+      if (_currentPassType != GfxEnumKernelType::GRAPHICS) {
+            auto err = std::format("[RenderNode::{}] Not in a RenderPass, please use CmdBeginRenderPass first.", command);
+            err += std::format(" - Node: \"{}\"", _nodeName);
+            MessageManager::Log(MessageType::Error, err);
+            return false;
+      }
+      if (!GfxContext::Get()->GetDeviceFeatures().bDrawIndirectCount) {
+            auto err = std::format("[RenderNode::{}] drawIndirectCount is not enabled on this device.", command);
+            err += std::format(" - Node: \"{}\"", _nodeName);
+            MessageManager::Log(MessageType::Error, err);
+            return false;
+      }
+      return true;
+}
+
+void RenderNode::CmdDrawIndexedIndirectCount(ResourceHandle indirect_buffer, size_t offset, ResourceHandle count_buffer, size_t count_offset, uint32_t max_draw_count, uint32_t stride) {
+      if (!CheckIndirectCountDraw("CmdDrawIndexedIndirectCount")) return;
+
+      auto* buf = FetchBufferObject(indirect_buffer, "CmdDrawIndexedIndirectCount");
+      auto* count_buf = FetchBufferObject(count_buffer, "CmdDrawIndexedIndirectCount");
+      if (!buf || !count_buf) return;
+
+      BarrierBuffer(buf, GfxEnumKernelType::GRAPHICS, GfxEnumResourceUsage::INDIRECT_BUFFER);
+      if (count_buf != buf) BarrierBuffer(count_buf, GfxEnumKernelType::GRAPHICS, GfxEnumResourceUsage::INDIRECT_BUFFER);
+      vkCmdDrawIndexedIndirectCount(_current, buf->GetBuffer(), offset, count_buf->GetBuffer(), count_offset, max_draw_count, stride);
+}
+
+void RenderNode::CmdDrawIndirectCount(ResourceHandle indirect_buffer, size_t offset, ResourceHandle count_buffer, size_t count_offset, uint32_t max_draw_count, uint32_t stride) {
+      if (!CheckIndirectCountDraw("CmdDrawIndirectCount")) return;
+
+      auto* buf = FetchBufferObject(indirect_buffer, "CmdDrawIndirectCount");
+      auto* count_buf = FetchBufferObject(count_buffer, "CmdDrawIndirectCount");
+      if (!buf || !count_buf) return;
+
+      BarrierBuffer(buf, GfxEnumKernelType::GRAPHICS, GfxEnumResourceUsage::INDIRECT_BUFFER);
+      if (count_buf != buf) BarrierBuffer(count_buf, GfxEnumKernelType::GRAPHICS, GfxEnumResourceUsage::INDIRECT_BUFFER);
+      vkCmdDrawIndirectCount(_current, buf->GetBuffer(), offset, count_buf->GetBuffer(), count_offset, max_draw_count, stride);
+}
+
 void RenderNode::CmdDrawIndex(uint32_t index_count, uint32_t instance_count, uint32_t first_index, int32_t vertex_offset, uint32_t first_instance) const {
       vkCmdDrawIndexed(_current, index_count, instance_count, first_index, vertex_offset, first_instance);
 }
@@ -474,30 +691,39 @@ void RenderNode::CmdDraw(uint32_t vertex_count, uint32_t instance_count, uint32_
       vkCmdDraw(_current, vertex_count, instance_count, first_vertex, first_instance);
 }
 
-void RenderNode::CmdSetViewport(const VkViewport& viewport) const {
+void RenderNode::CmdSetViewport(const VkViewport& viewport) {
+      if (_commandState.ViewportValid && std::memcmp(&_commandState.Viewport, &viewport, sizeof(VkViewport)) == 0) {
+            _filterStats.FilteredViewports++;
+            return;
+      }
       vkCmdSetViewport(_current, 0, 1, &viewport);
+      _commandState.Viewport = viewport;
+      _commandState.ViewportValid = true;
 }
 
-void RenderNode::CmdSetScissor(VkRect2D scissor) const {
+void RenderNode::CmdSetScissor(VkRect2D scissor) {
+      if (_commandState.ScissorValid && std::memcmp(&_commandState.Scissor, &scissor, sizeof(VkRect2D)) == 0) {
+            _filterStats.FilteredScissors++;
+            return;
+      }
       vkCmdSetScissor(_current, 0, 1, &scissor);
+      _commandState.Scissor = scissor;
+      _commandState.ScissorValid = true;
 }
 
-void RenderNode::CmdSetViewportAuto(bool invert_y) const {
+void RenderNode::CmdSetViewportAuto(bool invert_y) {
       if (invert_y) {
-            const auto viewport = VkViewport{0, (float)_frameRenderingRenderArea.extent.height, (float)_frameRenderingRenderArea.extent.width, -(float)_frameRenderingRenderArea.extent.height, 0, 1};
-            vkCmdSetViewport(_current, 0, 1, &viewport);
+            CmdSetViewport(VkViewport{0, (float)_frameRenderingRenderArea.extent.height, (float)_frameRenderingRenderArea.extent.width, -(float)_frameRenderingRenderArea.extent.height, 0, 1});
       } else {
-            const auto viewport = VkViewport{0, 0, (float)_frameRenderingRenderArea.extent.width, (float)_frameRenderingRenderArea.extent.height, 0, 1};
-            vkCmdSetViewport(_current, 0, 1, &viewport);
+            CmdSetViewport(VkViewport{0, 0, (float)_frameRenderingRenderArea.extent.width, (float)_frameRenderingRenderArea.extent.height, 0, 1});
       }
 }
 
-void RenderNode::CmdSetScissorAuto() const {
-      const auto scissor = VkRect2D{0, 0, _frameRenderingRenderArea.extent.width, _frameRenderingRenderArea.extent.height};
-      vkCmdSetScissor(_current, 0, 1, &scissor);
+void RenderNode::CmdSetScissorAuto() {
+      CmdSetScissor(VkRect2D{0, 0, _frameRenderingRenderArea.extent.width, _frameRenderingRenderArea.extent.height});
 }
 
-void RenderNode::CmdPushConstant(GfxInfoKernelLayout kernel_layout, const void* data, size_t data_size) const {
+void RenderNode::CmdPushConstant(GfxInfoKernelLayout kernel_layout, const void* data, size_t data_size) {
      if(kernel_layout.Layout == 0) {
            auto err = std::format("[RenderNode::CmdPushConstant] Invalid Kernel Layout.");
            err += std::format(" - Node: \"{}\"", _nodeName);
@@ -505,7 +731,8 @@ void RenderNode::CmdPushConstant(GfxInfoKernelLayout kernel_layout, const void*
            return;
      } else {
            uint32_t size = std::min((size_t)kernel_layout.Size, data_size);
-           vkCmdPushConstants(_current, std::bit_cast<VkPipelineLayout>(kernel_layout.Layout), VkShaderStageFlagBits::VK_SHADER_STAGE_ALL, kernel_layout.Offset, size, data);
+           const VkPushConstantRange range{VK_SHADER_STAGE_ALL, kernel_layout.Offset, kernel_layout.Size};
+           PushConstantFiltered(std::bit_cast<VkPipelineLayout>(kernel_layout.Layout), range, kernel_layout.Offset, size, data);
      }
 }
 
@@ -518,6 +745,9 @@ void RenderNode::CmdAsSampledTexure(ResourceHandle texture, GfxEnumKernelType wh
                   MessageManager::Log(MessageType::Error, err);
                   return;
             }
+            if(!ptr->IsResident()) { // still loading, read the placeholder instead
+                  ptr = GfxContext::Get()->GetPlaceholderTexture();
+            }
             if(which_kernel_use == GfxEnumKernelType::OUT_OF_KERNEL) { // Auto
                   if(_currentPassType == GfxEnumKernelType::OUT_OF_KERNEL) {
                         auto err = std::format("[RenderNode::CmdAsSampledTexure] Not in Any pass, Can't auto detect kernel type, Please use in a pass.");
@@ -568,6 +798,9 @@ void RenderNode::CmdAsReadTexure(ResourceHandle texture, GfxEnumKernelType which
                   MessageManager::Log(MessageType::Error, err);
                   return;
             }
+            if(!ptr->IsResident()) { // still loading, read the placeholder instead
+                  ptr = GfxContext::Get()->GetPlaceholderTexture();
+            }
             if(which_kernel_use == GfxEnumKernelType::OUT_OF_KERNEL) { // Auto
                   if(_currentPassType == GfxEnumKernelType::OUT_OF_KERNEL) {
                         auto err = std::format("[RenderNode::CmdAsReadTexure] Not in Any pass, Can't auto detect kernel type, Please use in a pass.");
@@ -618,6 +851,12 @@ void RenderNode::CmdAsWriteTexture(ResourceHandle texture, GfxEnumKernelType whi
                   MessageManager::Log(MessageType::Error, err);
                   return;
             }
+            if(!ptr->IsResident()) {
+                  auto err = std::format("[RenderNode::CmdAsWriteTexture] Texture is still loading, can't be written.");
+                  err += std::format(" - Node: \"{}\", Texture: {}", _nodeName, ptr->GetResourceName());
+                  MessageManager::Log(MessageType::Error, err);
+                  return;
+            }
             if(which_kernel_use == GfxEnumKernelType::OUT_OF_KERNEL) { // Auto
                   if(_currentPassType == GfxEnumKernelType::OUT_OF_KERNEL) {
                         auto err = std::format("[RenderNode::CmdAsWriteTexture] Not in Any pass, Can't auto detect kernel type, Please use in a pass.");
@@ -759,9 +998,10 @@ void RenderNode::CmdAsReadBuffer(ResourceHandle buffer, GfxEnumKernelType which_
       }
 }
 
-void RenderNode::EmitCommands(VkCommandBuffer primary_cmdbuf) const {
+void RenderNode::EmitCommands(VkCommandBuffer primary_cmdbuf) {
       auto& cmds = GetCurrentFrameCommand()->GetSecondaryCommandBuffers();
       if(cmds.empty()) { return; }
+      ResetPassQueries(primary_cmdbuf);
       vkCmdExecuteCommands(primary_cmdbuf, cmds.size(), cmds.data());
 }
 
@@ -789,6 +1029,7 @@ void RenderNode::BarrierBuffer(Component::Gfx::Buffer* buffer, GfxEnumKernelType
                   CmdBarrierBuffer(_prev, buffer, find->second.kernel_type, find->second.usage, new_kernel_type, new_usage, _nodeName);
                   find->second.kernel_type = new_kernel_type;
                   find->second.usage = new_usage;
+                  _commandState.InvalidateBuffers();
             }
       } else {
             _beginBarrierBuffer.emplace_back(buffer, new_kernel_type, new_usage);
@@ -798,6 +1039,9 @@ void RenderNode::BarrierBuffer(Component::Gfx::Buffer* buffer, GfxEnumKernelType
 
 void RenderNode::PrepareFrame() {
       GetCurrentFrameCommand()->Reset();
+      ReadbackQueries();
+      _filterStatsLast = _filterStats;
+      _filterStats = {};
       _beginBarrierTexture.clear();
       _beginBarrierBuffer.clear();
       _barrierTableTexture.clear();
@@ -1046,6 +1290,9 @@ void RenderNode::CmdBarrierBuffer(VkCommandBuffer buf, Component::Gfx::Buffer* b
                   case GfxEnumResourceUsage::READ_WRITE_BUFFER:
                         barrier.dstAccessMask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
                         break;
+                  case GfxEnumResourceUsage::INDIRECT_BUFFER:
+                        barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+                        break;
                   default:
                         {
                               auto err = std::format("[RenderNode::CmdBarrierBuffer] The Barrier in Buffer, In Compute kernel, New Usage can't be \"{}\".", ToStringResourceUsage(new_usage));
@@ -1054,7 +1301,7 @@ void RenderNode::CmdBarrierBuffer(VkCommandBuffer buf, Component::Gfx::Buffer* b
                               return;
                         }
             }
-            barrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+            barrier.dstStageMask = new_usage == GfxEnumResourceUsage::INDIRECT_BUFFER ? VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT : VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
       } else if (new_kernel_type == GfxEnumKernelType::GRAPHICS) {
             switch (new_usage) {
                   case GfxEnumResourceUsage::READ_BUFFER:
@@ -1124,6 +1371,10 @@ void RenderNode::CmdBarrierBuffer(VkCommandBuffer buf, Component::Gfx::Buffer* b
                         barrier.srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
                         barrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
                         break;
+                  case GfxEnumResourceUsage::INDIRECT_BUFFER:
+                        barrier.srcAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+                        barrier.srcStageMask = VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT;
+                        break;
                   default:
                         {
                               auto err = std::format("[RenderNode::CmdBarrierBuffer] The Barrier in Buffer, In Compute kernel, Old Usage can't be \"{}\".", ToStringResourceUsage(new_usage));
@@ -1199,7 +1450,74 @@ void RenderNode::CmdBarrierBuffer(VkCommandBuffer buf, Component::Gfx::Buffer* b
       vkCmdPipelineBarrier2(buf, &info);
 }
 
+Component::Gfx::Buffer* RenderNode::FetchBufferObject(ResourceHandle buffer, std::string_view cmd_name) const {
+      if (buffer.Type == GfxEnumResourceType::Buffer) {
+            if (auto* buf = GfxContext::Get()->ResourceFetch<Component::Gfx::Buffer>(buffer)) return buf;
+      } else if (buffer.Type == GfxEnumResourceType::Buffer3F) {
+            if (auto* buf = GfxContext::Get()->ResourceFetch<Component::Gfx::Buffer3F>(buffer)) return buf->GetBufferObject();
+      } else {
+            auto err = std::format("[RenderNode::{}] Invalid Resource Type, Need a Buffer or Buffer3F, but got {}.", cmd_name, ToStringResourceType(buffer.Type));
+            err += std::format(" - Node: \"{}\"", _nodeName);
+            MessageManager::Log(MessageType::Error, err);
+            return nullptr;
+      }
+
+      auto err = std::format("[RenderNode::{}] Invalid Buffer handle.", cmd_name);
+      err += std::format(" - Node: \"{}\"", _nodeName);
+      MessageManager::Log(MessageType::Error, err);
+      return nullptr;
+}
+
+void RenderNode::BindBindlessDescriptorSet(VkPipelineBindPoint bind_point, VkPipelineLayout layout, const VkPushConstantRange& range) {
+      const uint32_t index = bind_point == VK_PIPELINE_BIND_POINT_COMPUTE ? 0 : 1;
+      const auto& bound_range = _commandState.DescriptorRange[index];
+
+      // layouts share the bindless set layout, they stay compatible for set 0 while the push constant range is identical
+      if (_commandState.DescriptorBound[index] && bound_range.offset == range.offset && bound_range.size == range.size) {
+            _filterStats.FilteredDescriptorSetBinds++;
+            return;
+      }
+
+      vkCmdBindDescriptorSets(_current, bind_point, layout, 0, 1, &GfxContext::Get()->_bindlessDescriptorSet, 0, nullptr);
+      _commandState.DescriptorBound[index] = true;
+      _commandState.DescriptorRange[index] = range;
+}
+
+void RenderNode::PushConstantFiltered(VkPipelineLayout layout, const VkPushConstantRange& range, uint32_t offset, uint32_t size, const void* data) {
+      if (size == 0 || !data) return;
+
+      auto& state = _commandState;
+      const bool same_range = state.PushRange.offset == range.offset && state.PushRange.size == range.size;
+      const uint32_t end = offset + size;
+      const bool trackable = end <= RenderNodeCommandState::MaxPushConstantSize;
+
+      if (same_range && trackable && offset >= state.PushValidBegin && end <= state.PushValidEnd
+            && std::memcmp(state.PushData + offset, data, size) == 0) {
+            _filterStats.FilteredPushConstants++;
+            return;
+      }
+
+      vkCmdPushConstants(_current, layout, VK_SHADER_STAGE_ALL, offset, size, data);
+
+      if (!trackable) {
+            state.PushRange = {};
+            state.PushValidBegin = state.PushValidEnd = 0;
+            return;
+      }
+
+      std::memcpy(state.PushData + offset, data, size);
+      if (!same_range || state.PushValidBegin == state.PushValidEnd || end < state.PushValidBegin || offset > state.PushValidEnd) {
+            state.PushRange = range;
+            state.PushValidBegin = offset;
+            state.PushValidEnd = end;
+      } else {
+            state.PushValidBegin = std::min(state.PushValidBegin, offset);
+            state.PushValidEnd = std::max(state.PushValidEnd, end);
+      }
+}
+
 void RenderNode::BeginSecondaryCommandBuffer() {
+      _commandState = {};
       GetCurrentFrameCommand()->BeginSecondaryCommandBuffer();
       _prev = GetCurrentFrameCommand()->GetCommandBufferPrev();
       _current = GetCurrentFrameCommand()->GetCommandBufferCurr();
@@ -1209,4 +1527,190 @@ void RenderNode::EndSecondaryCommandBuffer() {
       _prev = nullptr;
       _current = nullptr;
       GetCurrentFrameCommand()->EndSecondaryCommandBuffer();
-}
\ No newline at end of file
+}
+
+void RenderNode::EnableQueries(bool pipeline_statistics, bool occlusion) {
+      if (pipeline_statistics && !GfxContext::Get()->GetDeviceFeatures().bPipelineStatisticsQuery) {
+            std::string err = "[RenderNode::EnableQueries] Device does not support pipelineStatisticsQuery, pipeline statistics disabled.";
+            err += std::format(" - Node: \"{}\"", _nodeName);
+            MessageManager::Log(MessageType::Warning, err);
+            pipeline_statistics = false;
+      }
+
+      _enableStatistics = pipeline_statistics;
+      _enableOcclusion = occlusion;
+      _queryStatsLast = {};
+
+      for (auto& frame : _queryFrames) {
+            DestroyQueryPools(frame);
+            frame = {};
+            if (_enableStatistics || _enableOcclusion) {
+                  CreateQueryPools(frame, RenderNodeQueryInitialCapacity);
+            }
+      }
+}
+
+void RenderNode::BeginPassQueries(bool render_pass) {
+      auto& frame = _queryFrames[_frameIndex];
+      frame.PassCount++;
+      if (render_pass) frame.RenderPassCount++;
+
+      const bool statistics = _enableStatistics && frame.Statistics;
+      const bool occlusion = render_pass && _enableOcclusion && frame.Occlusion;
+      if (!statistics && !occlusion) return;
+
+      if (frame.StatisticsUsed >= frame.Capacity || frame.OcclusionUsed >= frame.Capacity) {
+            frame.Dropped++;
+            return;
+      }
+
+      if (statistics) {
+            vkCmdBeginQuery(_current, frame.Statistics, frame.StatisticsUsed, 0);
+            _activeStatisticsQuery = frame.StatisticsUsed++;
+      }
+
+      if (occlusion) {
+            // without occlusionQueryPrecise the count is only guaranteed to be non-zero when samples passed
+            const VkQueryControlFlags flags = GfxContext::Get()->GetDeviceFeatures().bOcclusionQueryPrecise ? VK_QUERY_CONTROL_PRECISE_BIT : 0;
+            vkCmdBeginQuery(_current, frame.Occlusion, frame.OcclusionUsed, flags);
+            _activeOcclusionQuery = frame.OcclusionUsed++;
+            frame.RenderAreaPixels += (uint64_t)_frameRenderingRenderArea.extent.width * _frameRenderingRenderArea.extent.height;
+      }
+}
+
+void RenderNode::EndPassQueries() {
+      const auto& frame = _queryFrames[_frameIndex];
+      if (_activeOcclusionQuery != UINT32_MAX) {
+            vkCmdEndQuery(_current, frame.Occlusion, _activeOcclusionQuery);
+            _activeOcclusionQuery = UINT32_MAX;
+      }
+      if (_activeStatisticsQuery != UINT32_MAX) {
+            vkCmdEndQuery(_current, frame.Statistics, _activeStatisticsQuery);
+            _activeStatisticsQuery = UINT32_MAX;
+      }
+}
+
+void RenderNode::ResetPassQueries(VkCommandBuffer primary_cmdbuf) {
+      auto& frame = _queryFrames[_frameIndex];
+      if (frame.StatisticsUsed > 0) {
+            vkCmdResetQueryPool(primary_cmdbuf, frame.Statistics, 0, frame.StatisticsUsed);
+      }
+      if (frame.OcclusionUsed > 0) {
+            vkCmdResetQueryPool(primary_cmdbuf, frame.Occlusion, 0, frame.OcclusionUsed);
+      }
+      if (frame.StatisticsUsed > 0 || frame.OcclusionUsed > 0) {
+            frame.SubmitValue = GfxContext::Get()->GetCurrentFrameValue();
+      }
+}
+
+void RenderNode::ReadbackQueries() {
+      if (!_enableStatistics && !_enableOcclusion) return;
+
+      auto& frame = _queryFrames[_frameIndex];
+
+      // results exist only when the slot's commands were emitted into a frame that has retired, a node that recorded
+      // passes without being in the graph (or one prepared mid-frame by FrameGraph::AddNode) has queries that were never reset
+      if (frame.SubmitValue != 0 && frame.SubmitValue <= GfxContext::Get()->GetCompletedFrameValue()) {
+            ReadbackQueryResults(frame);
+      }
+
+      const uint32_t capacity = frame.Dropped > 0 ? frame.Capacity * 2 : frame.Capacity;
+      if (capacity != frame.Capacity) {
+            DestroyQueryPools(frame);
+            CreateQueryPools(frame, capacity);
+      }
+
+      frame.PassCount = 0;
+      frame.RenderPassCount = 0;
+      frame.StatisticsUsed = 0;
+      frame.OcclusionUsed = 0;
+      frame.Dropped = 0;
+      frame.RenderAreaPixels = 0;
+      frame.SubmitValue = 0;
+}
+
+void RenderNode::ReadbackQueryResults(const RenderNodeQueryFrame& frame) {
+      GfxInfoRenderNodeQueryStats stats{
+            .bValid = true,
+            .PassCount = frame.PassCount,
+            .RenderPassCount = frame.RenderPassCount,
+            .DroppedPassCount = frame.Dropped,
+            .RenderAreaPixels = frame.RenderAreaPixels
+      };
+
+      if (frame.StatisticsUsed > 0) {
+            constexpr uint32_t stride = RenderNodeQueryFrame::StatisticsCount * sizeof(uint64_t);
+            std::vector<uint64_t> results(frame.StatisticsUsed * RenderNodeQueryFrame::StatisticsCount);
+            if (vkGetQueryPoolResults(volkGetLoadedDevice(), frame.Statistics, 0, frame.StatisticsUsed, results.size() * sizeof(uint64_t), results.data(), stride,
+                  VK_QUERY_RESULT_64_BIT) == VK_SUCCESS) {
+                  for (uint32_t i = 0; i < frame.StatisticsUsed; i++) {
+                        const uint64_t* r = results.data() + i * RenderNodeQueryFrame::StatisticsCount;
+                        stats.InputAssemblyVertices += r[0];
+                        stats.InputAssemblyPrimitives += r[1];
+                        stats.VertexShaderInvocations += r[2];
+                        stats.ClippingInvocations += r[3];
+                        stats.ClippingPrimitives += r[4];
+                        stats.FragmentShaderInvocations += r[5];
+                        stats.ComputeShaderInvocations += r[6];
+                  }
+            } else {
+                  stats.bValid = false;
+            }
+      }
+
+      if (frame.OcclusionUsed > 0) {
+            std::vector<uint64_t> results(frame.OcclusionUsed);
+            if (vkGetQueryPoolResults(volkGetLoadedDevice(), frame.Occlusion, 0, frame.OcclusionUsed, results.size() * sizeof(uint64_t), results.data(), sizeof(uint64_t),
+                  VK_QUERY_RESULT_64_BIT) == VK_SUCCESS) {
+                  for (const auto samples : results) stats.SamplesPassed += samples;
+            } else {
+                  stats.bValid = false;
+            }
+      }
+
+      _queryStatsLast = stats;
+}
+
+void RenderNode::CreateQueryPools(RenderNodeQueryFrame& frame, uint32_t capacity) const {
+      frame.Capacity = capacity;
+
+      if (_enableStatistics) {
+            const VkQueryPoolCreateInfo statistics_ci{
+                  .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+                  .queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS,
+                  .queryCount = capacity,
+                  .pipelineStatistics = RenderNodeStatisticsFlags
+            };
+            if (const auto res = vkCreateQueryPool(volkGetLoadedDevice(), &statistics_ci, nullptr, &frame.Statistics); res != VK_SUCCESS) {
+                  auto err = std::format("[RenderNode::CreateQueryPools] vkCreateQueryPool for pipeline statistics failed, return {}.", ToStringVkResult(res));
+                  err += std::format(" - Node: \"{}\"", _nodeName);
+                  MessageManager::Log(MessageType::Error, err);
+                  frame.Statistics = VK_NULL_HANDLE;
+            }
+      }
+
+      if (_enableOcclusion) {
+            const VkQueryPoolCreateInfo occlusion_ci{
+                  .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+                  .queryType = VK_QUERY_TYPE_OCCLUSION,
+                  .queryCount = capacity,
+            };
+            if (const auto res = vkCreateQueryPool(volkGetLoadedDevice(), &occlusion_ci, nullptr, &frame.Occlusion); res != VK_SUCCESS) {
+                  auto err = std::format("[RenderNode::CreateQueryPools] vkCreateQueryPool for occlusion failed, return {}.", ToStringVkResult(res));
+                  err += std::format(" - Node: \"{}\"", _nodeName);
+                  MessageManager::Log(MessageType::Error, err);
+                  frame.Occlusion = VK_NULL_HANDLE;
+            }
+      }
+}
+
+void RenderNode::DestroyQueryPools(RenderNodeQueryFrame& frame) const {
+      if (frame.Statistics) {
+            vkDestroyQueryPool(volkGetLoadedDevice(), frame.Statistics, nullptr);
+            frame.Statistics = VK_NULL_HANDLE;
+      }
+      if (frame.Occlusion) {
+            vkDestroyQueryPool(volkGetLoadedDevice(), frame.Occlusion, nullptr);
+            frame.Occlusion = VK_NULL_HANDLE;
+      }
+}
@@ -5,6 +5,7 @@
 #pragma once
 #include "Helper.h"
 #include "GfxComponents/Buffer.h"
+#include "GfxComponents/Defines.h"
 
 namespace LoFi {
 
@@ -71,6 +72,59 @@ namespace LoFi {
             GfxEnumResourceUsage usage;
       };
 
+      // Shadow of the state recorded into the current secondary command buffer
+      struct RenderNodeCommandState {
+            static constexpr uint32_t MaxVertexBindings = 8;
+            static constexpr uint32_t MaxPushConstantSize = 256;
+
+            VkBuffer VertexBuffers[MaxVertexBindings]{};
+            VkDeviceSize VertexOffsets[MaxVertexBindings]{};
+
+            VkBuffer IndexBuffer{};
+            VkDeviceSize IndexOffset = 0;
+
+            // bindless set per bind point (compute, graphics), valid while the push constant range matches
+            bool DescriptorBound[2]{};
+            VkPushConstantRange DescriptorRange[2]{};
+
+            bool ViewportValid = false;
+            VkViewport Viewport{};
+
+            bool ScissorValid = false;
+            VkRect2D Scissor{};
+
+            // dynamic cull mode / front face, core in Vulkan 1.3
+            bool RasterValid = false;
+            VkCullModeFlags CullMode{};
+            VkFrontFace FrontFace{};
+
+            VkPushConstantRange PushRange{};
+            uint32_t PushValidBegin = 0;
+            uint32_t PushValidEnd = 0;
+            uint8_t PushData[MaxPushConstantSize]{};
+
+            void InvalidateBuffers() {
+                  std::fill(std::begin(VertexBuffers), std::end(VertexBuffers), VkBuffer{});
+                  IndexBuffer = {};
+            }
+      };
+
+      // Query pools of one frame slot, reset in the primary command buffer before the node's commands
+      struct RenderNodeQueryFrame {
+            static constexpr uint32_t StatisticsCount = 7;
+
+            VkQueryPool Statistics{};
+            VkQueryPool Occlusion{};
+            uint32_t Capacity = 0;
+            uint32_t PassCount = 0;
+            uint32_t RenderPassCount = 0;
+            uint32_t StatisticsUsed = 0;
+            uint32_t OcclusionUsed = 0;
+            uint32_t Dropped = 0;
+            uint64_t RenderAreaPixels = 0;
+            uint64_t SubmitValue = 0; // frame value whose primary command buffer reset and wrote the queries, 0 if the node was not emitted
+      };
+
       class RenderNode {
       public:
 
@@ -86,6 +140,13 @@ namespace LoFi {
 
             [[nodiscard]] bool IsEmptyNode() const { return GetCurrentFrameCommand()->GetSecondaryCommandBuffers().empty(); }
 
+            [[nodiscard]] const GfxInfoRenderNodeFilterStats& GetFilterStats() const { return _filterStatsLast; }
+
+            [[nodiscard]] const GfxInfoRenderNodeQueryStats& GetQueryStats() const { return _queryStatsLast; }
+
+            // features missing on the device are skipped with a warning
+            void EnableQueries(bool pipeline_statistics, bool occlusion);
+
             //Node After
 
             void WaitNodes(const GfxInfoRenderNodeWait& param);
@@ -96,31 +157,45 @@ namespace LoFi {
 
             void CmdComputeDispatch(uint32_t x, uint32_t y, uint32_t z) const;
 
+            void CmdComputeDispatchIndirect(ResourceHandle indirect_buffer, size_t offset = 0);
+
+            // Memory barrier between dispatches touching the same BDA memory, full = against all commands
+            void CmdComputeBarrier(bool full = false) const;
+
             void CmdBeginRenderPass(const GfxParamBeginRenderPass& param);
 
             void CmdEndRenderPass();
 
             void CmdBindKernel(ResourceHandle kernel);
 
+            // overrides apply to the rest of the current render pass, the bound kernel switches variant immediately
+            void CmdSetBlendOverride(GfxEnumBlendOverride blend);
+
+            void CmdSetCullOverride(GfxEnumCullOverride cull);
+
             void CmdBindVertexBuffer(ResourceHandle vertex_bufer, uint32_t first_binding = 0, uint32_t binding_count = 1, size_t offset = 0);
 
             void CmdBindIndexBuffer(ResourceHandle index_buffer, size_t offset = 0);
 
             void CmdDrawIndexedIndirect(ResourceHandle indirect_buffer, size_t offset, uint32_t draw_count, uint32_t stride);
 
+            void CmdDrawIndexedIndirectCount(ResourceHandle indirect_buffer, size_t offset, ResourceHandle count_buffer, size_t count_offset, uint32_t max_draw_count, uint32_t stride);
+
+            void CmdDrawIndirectCount(ResourceHandle indirect_buffer, size_t offset, ResourceHandle count_buffer, size_t count_offset, uint32_t max_draw_count, uint32_t stride);
+
             void CmdDrawIndex(uint32_t index_count, uint32_t instance_count = 1, uint32_t first_index = 0, int32_t vertex_offset = 0, uint32_t first_instance = 0) const;
 
             void CmdDraw(uint32_t vertex_count, uint32_t instance_count, uint32_t first_vertex = 0, uint32_t first_instance = 0) const;
 
-            void CmdSetViewport(const VkViewport& viewport) const;
+            void CmdSetViewport(const VkViewport& viewport);
 
-            void CmdSetScissor(VkRect2D scissor) const;
+            void CmdSetScissor(VkRect2D scissor);
 
-            void CmdSetViewportAuto(bool invert_y = true) const;
+            void CmdSetViewportAuto(bool invert_y = true);
 
-            void CmdSetScissorAuto() const;
+            void CmdSetScissorAuto();
 
-            void CmdPushConstant(GfxInfoKernelLayout kernel_layout, const void* data, size_t data_size) const;
+            void CmdPushConstant(GfxInfoKernelLayout kernel_layout, const void* data, size_t data_size);
 
             void CmdAsSampledTexure(ResourceHandle texture, GfxEnumKernelType which_kernel_use = GfxEnumKernelType::OUT_OF_KERNEL);
 
@@ -133,7 +208,7 @@ namespace LoFi {
             void CmdAsReadBuffer(ResourceHandle buffer, GfxEnumKernelType which_kernel_use = GfxEnumKernelType::OUT_OF_KERNEL);
 
       private:
-            void EmitCommands(VkCommandBuffer primary_cmdbuf) const;
+            void EmitCommands(VkCommandBuffer primary_cmdbuf);
 
             void SetFrameIndex(uint32_t frame_index) { _frameIndex = frame_index % 3;}
 
@@ -156,6 +231,31 @@ namespace LoFi {
 
             void EndSecondaryCommandBuffer();
 
+            Component::Gfx::Buffer* FetchBufferObject(ResourceHandle buffer, std::string_view cmd_name) const;
+
+            // draw count commands need a render pass and the optional drawIndirectCount feature
+            bool CheckIndirectCountDraw(const char* command) const;
+
+            void SetRasterState();
+
+            void BeginPassQueries(bool render_pass);
+
+            void EndPassQueries();
+
+            void ResetPassQueries(VkCommandBuffer primary_cmdbuf);
+
+            void ReadbackQueries();
+
+            void ReadbackQueryResults(const RenderNodeQueryFrame& frame);
+
+            void CreateQueryPools(RenderNodeQueryFrame& frame, uint32_t capacity) const;
+
+            void DestroyQueryPools(RenderNodeQueryFrame& frame) const;
+
+            void BindBindlessDescriptorSet(VkPipelineBindPoint bind_point, VkPipelineLayout layout, const VkPushConstantRange& range);
+
+            void PushConstantFiltered(VkPipelineLayout layout, const VkPushConstantRange& range, uint32_t offset, uint32_t size, const void* data);
+
       private:
             [[nodiscard]] RenderNodeFrameCommand* GetCurrentFrameCommand() const { return _frameCommand[_frameIndex].get(); }
 
@@ -166,12 +266,40 @@ namespace LoFi {
       private:
             ResourceHandle _currentKernel {};
 
+            VkPipeline _currentPipeline {};
+
+            VkCullModeFlags _currentKernelCullMode = VK_CULL_MODE_NONE;
+
+            VkFrontFace _currentKernelFrontFace = VK_FRONT_FACE_CLOCKWISE;
+
+            Component::Gfx::KernelRenderState _passRenderState {};
+
+            GfxEnumCullOverride _cullOverride = GfxEnumCullOverride::PROGRAM;
+
             GfxEnumKernelType _currentPassType = GfxEnumKernelType::OUT_OF_KERNEL;
 
             VkCommandBuffer _prev {};
 
             VkCommandBuffer _current {};
 
+            RenderNodeCommandState _commandState{};
+
+            GfxInfoRenderNodeFilterStats _filterStats{};
+
+            GfxInfoRenderNodeFilterStats _filterStatsLast{};
+
+            bool _enableStatistics = false;
+
+            bool _enableOcclusion = false;
+
+            uint32_t _activeStatisticsQuery = UINT32_MAX;
+
+            uint32_t _activeOcclusionQuery = UINT32_MAX;
+
+            RenderNodeQueryFrame _queryFrames[3]{};
+
+            GfxInfoRenderNodeQueryStats _queryStatsLast{};
+
       private:
             std::vector<RenderNodeBarrierVectorTexture> _beginBarrierTexture{};
 
@@ -0,0 +1,328 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#include "TextureLoader.h"
+#include "Message.h"
+
+#include <bit>
+#include <fstream>
+
+using namespace LoFi;
+using namespace LoFi::Internal;
+
+namespace {
+      constexpr uint8_t KTX2Identifier[12] = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+
+      struct KTX2Header {
+            uint8_t Identifier[12];
+            uint32_t VkFormat;
+            uint32_t TypeSize;
+            uint32_t PixelWidth;
+            uint32_t PixelHeight;
+            uint32_t PixelDepth;
+            uint32_t LayerCount;
+            uint32_t FaceCount;
+            uint32_t LevelCount;
+            uint32_t SupercompressionScheme;
+            uint32_t DfdByteOffset;
+            uint32_t DfdByteLength;
+            uint32_t KvdByteOffset;
+            uint32_t KvdByteLength;
+            uint64_t SgdByteOffset;
+            uint64_t SgdByteLength;
+      };
+
+      struct KTX2LevelIndex {
+            uint64_t ByteOffset;
+            uint64_t ByteLength;
+            uint64_t UncompressedByteLength;
+      };
+
+      constexpr uint32_t MakeFourCC(char a, char b, char c, char d) {
+            return (uint32_t)a | ((uint32_t)b << 8) | ((uint32_t)c << 16) | ((uint32_t)d << 24);
+      }
+
+      struct DDSPixelFormat {
+            uint32_t Size;
+            uint32_t Flags;
+            uint32_t FourCC;
+            uint32_t RGBBitCount;
+            uint32_t RBitMask;
+            uint32_t GBitMask;
+            uint32_t BBitMask;
+            uint32_t ABitMask;
+      };
+
+      struct DDSHeader {
+            uint32_t Size;
+            uint32_t Flags;
+            uint32_t Height;
+            uint32_t Width;
+            uint32_t PitchOrLinearSize;
+            uint32_t Depth;
+            uint32_t MipMapCount;
+            uint32_t Reserved1[11];
+            DDSPixelFormat PixelFormat;
+            uint32_t Caps;
+            uint32_t Caps2;
+            uint32_t Caps3;
+            uint32_t Caps4;
+            uint32_t Reserved2;
+      };
+
+      struct DDSHeaderDXT10 {
+            uint32_t DXGIFormat;
+            uint32_t ResourceDimension;
+            uint32_t MiscFlag;
+            uint32_t ArraySize;
+            uint32_t MiscFlags2;
+      };
+
+      constexpr uint32_t DDSD_MIPMAPCOUNT = 0x20000;
+      constexpr uint32_t DDPF_FOURCC = 0x4;
+      constexpr uint32_t DDPF_RGB = 0x40;
+      constexpr uint32_t DDSCAPS2_CUBEMAP = 0x200;
+      constexpr uint32_t DDSCAPS2_VOLUME = 0x200000;
+
+      static_assert(sizeof(KTX2Header) == 80);
+      static_assert(sizeof(DDSHeader) == 124);
+}
+
+bool TextureLoader::IsContainerFile(std::string_view path) {
+      const auto dot = path.find_last_of('.');
+      if (dot == std::string_view::npos) return false;
+
+      std::string ext{path.substr(dot + 1)};
+      for (auto& c : ext) c = (char)std::tolower((unsigned char)c);
+      return ext == "ktx2" || ext == "dds";
+}
+
+bool TextureLoader::Load(const char* path, TextureFileData& out, const TextureDataAllocator& allocate) {
+      std::string ext{std::string_view(path).substr(std::string_view(path).find_last_of('.') + 1)};
+      for (auto& c : ext) c = (char)std::tolower((unsigned char)c);
+
+      if (ext == "ktx2") return LoadKTX2(path, out, allocate);
+      if (ext == "dds") return LoadDDS(path, out, allocate);
+
+      const auto err = std::format("[TextureLoader::Load] Unknown texture container \"{}\".", path);
+      MessageManager::Log(MessageType::Error, err);
+      return false;
+}
+
+bool TextureLoader::ValidateExtent(const char* path, const TextureFileData& data) {
+      const uint32_t max_mip_count = data.Width && data.Height ? std::bit_width(glm::max(data.Width, data.Height)) : 0;
+      if (data.Width == 0 || data.Height == 0 || data.MipLevels == 0 || data.MipLevels > max_mip_count) {
+            const auto err = std::format("[TextureLoader::ValidateExtent] Invalid extent {}x{} with {} mip levels \"{}\".", data.Width, data.Height, data.MipLevels, path);
+            MessageManager::Log(MessageType::Error, err);
+            return false;
+      }
+      return true;
+}
+
+bool TextureLoader::ReadFile(const char* path, std::vector<uint8_t>& out) {
+      std::ifstream file(path, std::ios::binary | std::ios::ate);
+      if (!file.is_open()) {
+            const auto err = std::format("[TextureLoader::ReadFile] Can't open file \"{}\".", path);
+            MessageManager::Log(MessageType::Error, err);
+            return false;
+      }
+
+      const auto size = (size_t)file.tellg();
+      file.seekg(0, std::ios::beg);
+      out.resize(size);
+      file.read((char*)out.data(), (std::streamsize)size);
+      return true;
+}
+
+uint8_t* TextureLoader::AcquireData(const char* path, TextureFileData& out, size_t size, const TextureDataAllocator& allocate) {
+      if (!allocate) {
+            out.Data.resize(size);
+            return out.Data.data();
+      }
+
+      auto* dst = (uint8_t*)allocate(size);
+      if (!dst) {
+            const auto err = std::format("[TextureLoader::AcquireData] Failed to get {} bytes for the level data \"{}\".", size, path);
+            MessageManager::Log(MessageType::Error, err);
+      }
+      return dst;
+}
+
+bool TextureLoader::LoadKTX2(const char* path, TextureFileData& out, const TextureDataAllocator& allocate) {
+      std::vector<uint8_t> file{};
+      if (!ReadFile(path, file)) return false;
+
+      if (file.size() < sizeof(KTX2Header) || memcmp(file.data(), KTX2Identifier, sizeof(KTX2Identifier)) != 0) {
+            const auto err = std::format("[TextureLoader::LoadKTX2] Not a KTX2 file \"{}\".", path);
+            MessageManager::Log(MessageType::Error, err);
+            return false;
+      }
+
+      KTX2Header header{};
+      memcpy(&header, file.data(), sizeof(KTX2Header));
+
+      if (header.VkFormat == VK_FORMAT_UNDEFINED || header.SupercompressionScheme != 0) {
+            const auto err = std::format("[TextureLoader::LoadKTX2] Basis / supercompressed KTX2 is not supported, transcode it offline first \"{}\".", path);
+            MessageManager::Log(MessageType::Error, err);
+            return false;
+      }
+
+      if (header.PixelDepth > 1 || header.LayerCount > 1 || header.FaceCount != 1 || header.PixelHeight == 0) {
+            const auto err = std::format("[TextureLoader::LoadKTX2] Only single layer 2D KTX2 textures are supported \"{}\".", path);
+            MessageManager::Log(MessageType::Error, err);
+            return false;
+      }
+
+      const auto format = (VkFormat)header.VkFormat;
+      const uint32_t level_count = glm::max(header.LevelCount, 1u);
+      const size_t level_index_end = sizeof(KTX2Header) + level_count * sizeof(KTX2LevelIndex);
+      if (file.size() < level_index_end) {
+            const auto err = std::format("[TextureLoader::LoadKTX2] Truncated level index \"{}\".", path);
+            MessageManager::Log(MessageType::Error, err);
+            return false;
+      }
+
+      std::vector<KTX2LevelIndex> levels(level_count);
+      memcpy(levels.data(), file.data() + sizeof(KTX2Header), level_count * sizeof(KTX2LevelIndex));
+
+      out.Format = format;
+      out.Width = header.PixelWidth;
+      out.Height = header.PixelHeight;
+      out.MipLevels = level_count;
+      out.Data.clear();
+      if (!ValidateExtent(path, out)) return false;
+
+      size_t total = 0;
+      for (uint32_t level = 0; level < level_count; level++) {
+            const auto& [offset, length, _] = levels[level];
+            const size_t expect = GetFormatLevelSize(format, glm::max(out.Width >> level, 1u), glm::max(out.Height >> level, 1u));
+            if (length != expect || offset > file.size() || length > file.size() - offset) {
+                  const auto err = std::format("[TextureLoader::LoadKTX2] Level {} has {} bytes, expected {} \"{}\".", level, length, expect, path);
+                  MessageManager::Log(MessageType::Error, err);
+                  return false;
+            }
+            total += length;
+      }
+
+      uint8_t* dst = AcquireData(path, out, total, allocate);
+      if (!dst) return false;
+      for (const auto& [offset, length, _] : levels) {
+            memcpy(dst, file.data() + offset, length);
+            dst += length;
+      }
+
+      return true;
+}
+
+bool TextureLoader::LoadDDS(const char* path, TextureFileData& out, const TextureDataAllocator& allocate) {
+      std::vector<uint8_t> file{};
+      if (!ReadFile(path, file)) return false;
+
+      if (file.size() < 4 + sizeof(DDSHeader) || *(uint32_t*)file.data() != MakeFourCC('D', 'D', 'S', ' ')) {
+            const auto err = std::format("[TextureLoader::LoadDDS] Not a DDS file \"{}\".", path);
+            MessageManager::Log(MessageType::Error, err);
+            return false;
+      }
+
+      DDSHeader header{};
+      memcpy(&header, file.data() + 4, sizeof(DDSHeader));
+      size_t data_offset = 4 + sizeof(DDSHeader);
+
+      if (header.Caps2 & (DDSCAPS2_CUBEMAP | DDSCAPS2_VOLUME)) {
+            const auto err = std::format("[TextureLoader::LoadDDS] Only 2D DDS textures are supported \"{}\".", path);
+            MessageManager::Log(MessageType::Error, err);
+            return false;
+      }
+
+      VkFormat format = VK_FORMAT_UNDEFINED;
+      const auto& pf = header.PixelFormat;
+      if (pf.Flags & DDPF_FOURCC) {
+            switch (pf.FourCC) {
+                  case MakeFourCC('D', 'X', 'T', '1'): format = VK_FORMAT_BC1_RGBA_UNORM_BLOCK; break;
+                  case MakeFourCC('D', 'X', 'T', '3'): format = VK_FORMAT_BC2_UNORM_BLOCK; break;
+                  case MakeFourCC('D', 'X', 'T', '5'): format = VK_FORMAT_BC3_UNORM_BLOCK; break;
+                  case MakeFourCC('A', 'T', 'I', '1'):
+                  case MakeFourCC('B', 'C', '4', 'U'): format = VK_FORMAT_BC4_UNORM_BLOCK; break;
+                  case MakeFourCC('B', 'C', '4', 'S'): format = VK_FORMAT_BC4_SNORM_BLOCK; break;
+                  case MakeFourCC('A', 'T', 'I', '2'):
+                  case MakeFourCC('B', 'C', '5', 'U'): format = VK_FORMAT_BC5_UNORM_BLOCK; break;
+                  case MakeFourCC('B', 'C', '5', 'S'): format = VK_FORMAT_BC5_SNORM_BLOCK; break;
+                  case MakeFourCC('D', 'X', '1', '0'): {
+                        if (file.size() < data_offset + sizeof(DDSHeaderDXT10)) break;
+                        DDSHeaderDXT10 dx10{};
+                        memcpy(&dx10, file.data() + data_offset, sizeof(DDSHeaderDXT10));
+                        data_offset += sizeof(DDSHeaderDXT10);
+                        if (dx10.ArraySize > 1) {
+                              const auto err = std::format("[TextureLoader::LoadDDS] Texture arrays are not supported \"{}\".", path);
+                              MessageManager::Log(MessageType::Error, err);
+                              return false;
+                        }
+                        format = FromDXGIFormat(dx10.DXGIFormat);
+                        break;
+                  }
+                  default: break;
+            }
+      } else if ((pf.Flags & DDPF_RGB) && pf.RGBBitCount == 32) {
+            if (pf.RBitMask == 0x000000ff && pf.GBitMask == 0x0000ff00 && pf.BBitMask == 0x00ff0000) {
+                  format = VK_FORMAT_R8G8B8A8_UNORM;
+            } else if (pf.RBitMask == 0x00ff0000 && pf.GBitMask == 0x0000ff00 && pf.BBitMask == 0x000000ff) {
+                  format = VK_FORMAT_B8G8R8A8_UNORM;
+            }
+      }
+
+      if (format == VK_FORMAT_UNDEFINED) {
+            const auto err = std::format("[TextureLoader::LoadDDS] Unsupported DDS pixel format \"{}\".", path);
+            MessageManager::Log(MessageType::Error, err);
+            return false;
+      }
+
+      out.Format = format;
+      out.Width = header.Width;
+      out.Height = header.Height;
+      // MipMapCount is only meaningful when the header flags it, writers leave garbage there otherwise
+      out.MipLevels = (header.Flags & DDSD_MIPMAPCOUNT) ? glm::max(header.MipMapCount, 1u) : 1u;
+      if (!ValidateExtent(path, out)) return false;
+
+      size_t total = 0;
+      for (uint32_t level = 0; level < out.MipLevels; level++) {
+            total += GetFormatLevelSize(format, glm::max(out.Width >> level, 1u), glm::max(out.Height >> level, 1u));
+      }
+
+      if (total > file.size() - data_offset) {
+            const auto err = std::format("[TextureLoader::LoadDDS] Truncated data, need {} bytes, got {} \"{}\".", total, file.size() - data_offset, path);
+            MessageManager::Log(MessageType::Error, err);
+            return false;
+      }
+
+      uint8_t* dst = AcquireData(path, out, total, allocate);
+      if (!dst) return false;
+      memcpy(dst, file.data() + data_offset, total);
+      return true;
+}
+
+VkFormat TextureLoader::FromDXGIFormat(uint32_t dxgi_format) {
+      switch (dxgi_format) {
+            case 2: return VK_FORMAT_R32G32B32A32_SFLOAT;
+            case 10: return VK_FORMAT_R16G16B16A16_SFLOAT;
+            case 28: return VK_FORMAT_R8G8B8A8_UNORM;
+            case 29: return VK_FORMAT_R8G8B8A8_SRGB;
+            case 71: return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+            case 72: return VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+            case 74: return VK_FORMAT_BC2_UNORM_BLOCK;
+            case 75: return VK_FORMAT_BC2_SRGB_BLOCK;
+            case 77: return VK_FORMAT_BC3_UNORM_BLOCK;
+            case 78: return VK_FORMAT_BC3_SRGB_BLOCK;
+            case 80: return VK_FORMAT_BC4_UNORM_BLOCK;
+            case 81: return VK_FORMAT_BC4_SNORM_BLOCK;
+            case 83: return VK_FORMAT_BC5_UNORM_BLOCK;
+            case 84: return VK_FORMAT_BC5_SNORM_BLOCK;
+            case 87: return VK_FORMAT_B8G8R8A8_UNORM;
+            case 91: return VK_FORMAT_B8G8R8A8_SRGB;
+            case 95: return VK_FORMAT_BC6H_UFLOAT_BLOCK;
+            case 96: return VK_FORMAT_BC6H_SFLOAT_BLOCK;
+            case 98: return VK_FORMAT_BC7_UNORM_BLOCK;
+            case 99: return VK_FORMAT_BC7_SRGB_BLOCK;
+            default: return VK_FORMAT_UNDEFINED;
+      }
+}
@@ -0,0 +1,47 @@
+//
+// Created by agent on 2026/10/19.
+//
+
+#pragma once
+#include "Helper.h"
+
+namespace LoFi::Internal {
+
+      struct TextureFileData {
+            VkFormat Format = VK_FORMAT_UNDEFINED;
+            uint32_t Width = 0;
+            uint32_t Height = 0;
+            uint32_t MipLevels = 0;
+            std::vector<uint8_t> Data{}; // all levels, mip 0 first, tightly packed; empty when an allocator took them
+      };
+
+      // returns where the level data of the given size goes, nullptr fails the load
+      using TextureDataAllocator = std::function<void*(size_t)>;
+
+      class TextureLoader {
+      public:
+            TextureLoader() = delete;
+
+            ~TextureLoader() = delete;
+
+            NO_COPY_MOVE_CONS(TextureLoader);
+
+            static bool IsContainerFile(std::string_view path);
+
+            static bool Load(const char* path, TextureFileData& out, const TextureDataAllocator& allocate = {});
+
+            static bool LoadKTX2(const char* path, TextureFileData& out, const TextureDataAllocator& allocate = {});
+
+            static bool LoadDDS(const char* path, TextureFileData& out, const TextureDataAllocator& allocate = {});
+
+      private:
+            static bool ValidateExtent(const char* path, const TextureFileData& data);
+
+            static bool ReadFile(const char* path, std::vector<uint8_t>& out);
+
+            // out.Data, or the allocator's memory when there is one
+            static uint8_t* AcquireData(const char* path, TextureFileData& out, size_t size, const TextureDataAllocator& allocate);
+
+            static VkFormat FromDXGIFormat(uint32_t dxgi_format);
+      };
+}
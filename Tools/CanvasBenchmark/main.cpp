@@ -0,0 +1,200 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include "LoFiGfx.h"
+
+// Measures the CPU side of canvas recording, headless (no swapchain).
+//   CanvasBenchmark [primitive count] [iterations]
+// Time is Reset + draws + DispatchGenerateCommands, reported per 100k primitives.
+
+// the previous canvas path, kept here so both runs are measured in one binary: every Draw* appended
+// 4 vertices, 6 indices, one indirect command and one instance record to std::vectors, and
+// DispatchGenerateCommands copied each vector into that frame slot's buffer with SetData
+struct BaselineVertex {
+      float Pos[2];
+      float UV[2];
+};
+
+struct BaselineIndirect {
+      uint32_t IndexCount;
+      uint32_t InstanceCount;
+      uint32_t FirstIndex;
+      int32_t VertexOffset;
+      uint32_t FirstInstance;
+};
+
+// field for field the canvas instance record
+struct BaselineInstance {
+      uint16_t Scissor[4];
+      uint16_t CanvasSize[2];
+      uint16_t Size[2];
+      float Center[2];
+      float CenterRotate;
+      uint8_t Color[4];
+      uint32_t TextureBindlessIndex_or_GradientDataOffset;
+      uint16_t StrockType;
+      uint16_t PrimitiveType;
+      float PrimitiveParameter[8];
+};
+
+class BaselineRecorder {
+public:
+      BaselineRecorder() {
+            for (uint32_t i = 0; i < 3; i++) {
+                  _vertex.push_back(GfxCreateBuffer({.pResourceName = "Baseline Vertex", .DataSize = 8192, .bSingleUpload = false, .bCpuAccess = true}));
+                  _index.push_back(GfxCreateBuffer({.pResourceName = "Baseline Index", .DataSize = 8192, .bSingleUpload = false, .bCpuAccess = true}));
+                  _instance.push_back(GfxCreateBuffer({.pResourceName = "Baseline Instance", .DataSize = 8192, .bSingleUpload = false, .bCpuAccess = true}));
+                  _indirect.push_back(GfxCreateBuffer({.pResourceName = "Baseline Indirect", .DataSize = 8192, .bSingleUpload = false, .bCpuAccess = true}));
+            }
+      }
+
+      ~BaselineRecorder() {
+            for (uint32_t i = 0; i < 3; i++) {
+                  GfxDestroy(_vertex[i]);
+                  GfxDestroy(_index[i]);
+                  GfxDestroy(_instance[i]);
+                  GfxDestroy(_indirect[i]);
+            }
+      }
+
+      void Reset() {
+            _vertexData.clear();
+            _indexData.clear();
+            _instanceData.clear();
+            _indirectData.clear();
+      }
+
+      void DrawBox(GfxVec2 start, GfxVec2 size) {
+            const float w = size.x + PixelExpand * 2, h = size.y + PixelExpand * 2;
+            Quad({start.x, start.y + h}, {start.x + w, start.y + h}, {start.x, start.y}, {start.x + w, start.y});
+            auto& ref = NewInstance();
+            ref.Size[0] = (uint16_t)w;
+            ref.Size[1] = (uint16_t)h;
+            ref.Center[0] = start.x + w / 2.0f;
+            ref.Center[1] = start.y + h / 2.0f;
+            ref.PrimitiveType = 0;
+            ref.PrimitiveParameter[0] = size.x;
+            ref.PrimitiveParameter[1] = size.y;
+      }
+
+      void DrawCircle(GfxVec2 center, float radius) {
+            const float e = radius + PixelExpand;
+            Quad({center.x - e, center.y + e}, {center.x + e, center.y + e}, {center.x - e, center.y - e}, {center.x + e, center.y - e});
+            auto& ref = NewInstance();
+            ref.Size[0] = ref.Size[1] = (uint16_t)(e * 2.0f);
+            ref.Center[0] = center.x;
+            ref.Center[1] = center.y;
+            ref.PrimitiveType = 2;
+            ref.PrimitiveParameter[0] = radius;
+      }
+
+      void Upload(uint32_t frame) const {
+            GfxUploadBuffer(_vertex[frame], _vertexData.data(), _vertexData.size() * sizeof(BaselineVertex));
+            GfxUploadBuffer(_index[frame], _indexData.data(), _indexData.size() * sizeof(uint32_t));
+            GfxUploadBuffer(_instance[frame], _instanceData.data(), _instanceData.size() * sizeof(BaselineInstance));
+            GfxUploadBuffer(_indirect[frame], _indirectData.data(), _indirectData.size() * sizeof(BaselineIndirect));
+      }
+
+private:
+      static constexpr float PixelExpand = 20;
+
+      void Quad(GfxVec2 a, GfxVec2 b, GfxVec2 c, GfxVec2 d) {
+            const uint32_t voffset = (uint32_t)_vertexData.size();
+            const uint32_t ioffset = (uint32_t)_indexData.size();
+            const uint32_t indirect_offset = (uint32_t)_indirectData.size();
+
+            _vertexData.reserve(voffset + 4);
+            _indexData.reserve(ioffset + 6);
+
+            _vertexData.push_back({{a.x, a.y}, {0, 1}});
+            _vertexData.push_back({{b.x, b.y}, {1, 1}});
+            _vertexData.push_back({{c.x, c.y}, {0, 0}});
+            _vertexData.push_back({{d.x, d.y}, {1, 0}});
+
+            for (const uint32_t i : {0u, 1u, 2u, 2u, 1u, 3u}) _indexData.push_back(voffset + i);
+
+            _indirectData.push_back({6, 1, ioffset, 0, indirect_offset});
+      }
+
+      BaselineInstance& NewInstance() {
+            auto& ref = _instanceData.emplace_back();
+            ref.Scissor[2] = 3840;
+            ref.Scissor[3] = 2160;
+            ref.CanvasSize[0] = 3840;
+            ref.CanvasSize[1] = 2160;
+            ref.StrockType = 0;
+            ref.Color[0] = ref.Color[1] = ref.Color[2] = ref.Color[3] = 255;
+            return ref;
+      }
+
+      std::vector<BaselineVertex> _vertexData{};
+      std::vector<uint32_t> _indexData{};
+      std::vector<BaselineInstance> _instanceData{};
+      std::vector<BaselineIndirect> _indirectData{};
+
+      std::vector<GfxHandle> _vertex{};
+      std::vector<GfxHandle> _index{};
+      std::vector<GfxHandle> _instance{};
+      std::vector<GfxHandle> _indirect{};
+};
+
+static void Run(const char* name, uint32_t count, uint32_t iterations, const std::function<void()>& record) {
+      //warm up, grows the buffers to their steady state
+      record();
+
+      const auto begin = std::chrono::high_resolution_clock::now();
+      for (uint32_t i = 0; i < iterations; i++) record();
+      const auto end = std::chrono::high_resolution_clock::now();
+
+      const double ms = std::chrono::duration<double, std::milli>(end - begin).count() / iterations;
+      std::cout << name << ": " << ms << " ms, " << ms * 100000.0 / count << " ms per 100k primitives\n";
+}
+
+int main(int argc, char** argv) {
+      const uint32_t count = argc > 1 ? (uint32_t)std::stoul(argv[1]) : 100000;
+      const uint32_t iterations = argc > 2 ? (uint32_t)std::stoul(argv[2]) : 32;
+
+      GfxInit();
+
+      const auto canvas = Gfx2DCreateCanvas();
+
+      std::cout << "Primitives: " << count << ", iterations: " << iterations << "\n";
+
+      // same primitives as the canvas run, the baseline skips the C API call per draw so it is slightly favoured
+      auto baseline = std::make_unique<BaselineRecorder>();
+      uint32_t baseline_frame = 0;
+      Run("Baseline (vectors + SetData)", count, iterations, [&] {
+            baseline->Reset();
+            for (uint32_t i = 0; i < count; i++) {
+                  const GfxVec2 pos{(float)(i % 1920), (float)(i / 1920 % 1080)};
+                  if (i & 1) {
+                        baseline->DrawCircle(pos, 8);
+                  } else {
+                        baseline->DrawBox(pos, {16, 16});
+                  }
+            }
+            baseline->Upload(baseline_frame);
+            baseline_frame = (baseline_frame + 1) % 3;
+      });
+
+      Run("Canvas (mapped streams)", count, iterations, [&] {
+            Gfx2DReset(canvas);
+            for (uint32_t i = 0; i < count; i++) {
+                  const GfxVec2 pos{(float)(i % 1920), (float)(i / 1920 % 1080)};
+                  if (i & 1) {
+                        Gfx2DCmdDrawCircle(canvas, pos, {.Radius = 8});
+                  } else {
+                        Gfx2DCmdDrawBox(canvas, pos, {.Size = {16, 16}});
+                  }
+            }
+            Gfx2DDispatchGenerateCommands(canvas);
+      });
+
+      baseline.reset();
+      Gfx2DDestroy(canvas);
+      GfxClose();
+      return 0;
+}
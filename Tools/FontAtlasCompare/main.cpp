@@ -0,0 +1,127 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstring>
+#include "glm/glm.hpp"
+#include "glm/gtc/packing.hpp"
+#include "msdfgen/msdfgen.h"
+#include "msdfgen/msdfgen-ext.h"
+#include "PfxGlyphRaster.h"
+
+// Compares text rendered from the float MTSDF atlas against the RGBA8 and RGBA16F atlases, on the CPU.
+//   FontAtlasCompare <font file> [pxRange]
+// Every glyph is rasterized and quantized by the atlas' own code, then drawn at several sizes with the canvas' text
+// shader math (bilinear fetch, median, opacity ramp), the error is the difference in coverage against the float atlas.
+
+struct Cell {
+      glm::ivec2 Extent{};
+      std::vector<float> Texels{};
+};
+
+struct ErrorStats {
+      double Max = 0.0;
+      double Sum = 0.0;
+      uint64_t Count = 0;
+};
+
+// the float MTSDF the atlas quantizes, in the cell of the glyph's class
+static bool GenerateCell(msdfgen::FontHandle* font, wchar_t ch, double scale, double baseline, Cell& cell) {
+      const auto glyph_class = LoFi::PfxClassifyGlyph(ch);
+      cell.Extent = LoFi::PfxGetGlyphCellExtent(glyph_class);
+      cell.Texels.assign((size_t)cell.Extent.x * cell.Extent.y * 4, 0.0f);
+      return LoFi::PfxRasterizeGlyph(font, ch, glyph_class, scale, baseline, cell.Texels.data());
+}
+
+// the atlas texels of a format, read back the way the GPU sees them
+static Cell Quantize(const Cell& cell, bool half) {
+      std::vector<uint8_t> texels(cell.Texels.size() * (half ? 2 : 1));
+      LoFi::PfxQuantizeGlyph(cell.Texels.data(), cell.Texels.size(), half, texels.data());
+
+      Cell result{cell.Extent, std::vector<float>(cell.Texels.size())};
+      for (size_t i = 0; i < result.Texels.size(); i++) {
+            uint16_t h = 0;
+            if (half) memcpy(&h, texels.data() + i * 2, sizeof(h));
+            result.Texels[i] = half ? glm::unpackHalf1x16(h) : (float)texels[i] / 255.0f;
+      }
+      return result;
+}
+
+static glm::vec3 Sample(const Cell& cell, glm::vec2 uv) {
+      const glm::vec2 p = glm::clamp(uv * glm::vec2(cell.Extent) - 0.5f, glm::vec2(0.0f), glm::vec2(cell.Extent - 1));
+      const glm::ivec2 p0 = glm::ivec2(p);
+      const glm::ivec2 p1 = glm::min(p0 + 1, cell.Extent - 1);
+      const glm::vec2 f = p - glm::vec2(p0);
+      const auto texel = [&](int x, int y) {
+            const float* t = &cell.Texels[(y * cell.Extent.x + x) * 4];
+            return glm::vec3(t[0], t[1], t[2]);
+      };
+      return glm::mix(glm::mix(texel(p0.x, p0.y), texel(p1.x, p0.y), f.x), glm::mix(texel(p0.x, p1.y), texel(p1.x, p1.y), f.x), f.y);
+}
+
+static float Coverage(const Cell& cell, glm::vec2 uv, float pxRange) {
+      const glm::vec3 msdf = Sample(cell, uv);
+      const float sd = glm::max(glm::min(msdf.r, msdf.g), glm::min(glm::max(msdf.r, msdf.g), msdf.b));
+      return glm::clamp(pxRange * (sd - 0.5f) + 0.8f, 0.0f, 1.0f);
+}
+
+static void Accumulate(ErrorStats& stats, const Cell& reference, const Cell& quantized, int size, float pxRange) {
+      for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                  const glm::vec2 uv = (glm::vec2(x, y) + 0.5f) / (float)size;
+                  const double err = glm::abs(Coverage(reference, uv, pxRange) - Coverage(quantized, uv, pxRange));
+                  stats.Max = glm::max(stats.Max, err);
+                  stats.Sum += err;
+                  stats.Count++;
+            }
+      }
+}
+
+int main(int argc, char** argv) {
+      if (argc < 2) {
+            std::cout << "FontAtlasCompare <font file> [pxRange]\n";
+            return 1;
+      }
+      const float px_range = argc > 2 ? std::stof(argv[2]) : 4.0f;
+
+      msdfgen::FreetypeHandle* ft = msdfgen::initializeFreetype();
+      msdfgen::FontHandle* font = ft ? msdfgen::loadFont(ft, argv[1]) : nullptr;
+      if (!font) {
+            std::cout << "Can't load font " << argv[1] << "\n";
+            return 1;
+      }
+
+      msdfgen::FontMetrics metrics{};
+      msdfgen::getFontMetrics(metrics, font, msdfgen::FONT_SCALING_LEGACY);
+      const double line_box = metrics.ascenderY - metrics.descenderY;
+      const double scale = line_box > 0.0 ? 28.0 / line_box : 1.0;
+
+      const std::wstring charset = L"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789@#&%?!{}()[]<>/\\|~";
+      constexpr int sizes[] = {12, 24, 48, 96};
+
+      ErrorStats rgba8[std::size(sizes)]{}, rgba16f[std::size(sizes)]{};
+      uint32_t glyphs = 0;
+      for (const wchar_t ch : charset) {
+            Cell reference{};
+            if (!GenerateCell(font, ch, scale, metrics.descenderY, reference)) continue;
+            const Cell unorm = Quantize(reference, false);
+            const Cell half = Quantize(reference, true);
+            for (size_t i = 0; i < std::size(sizes); i++) {
+                  Accumulate(rgba8[i], reference, unorm, sizes[i], px_range);
+                  Accumulate(rgba16f[i], reference, half, sizes[i], px_range);
+            }
+            glyphs++;
+      }
+
+      msdfgen::destroyFont(font);
+      msdfgen::deinitializeFreetype(ft);
+
+      constexpr uint64_t page = 2048ull * 2048ull;
+      std::cout << "Glyphs: " << glyphs << ", pxRange: " << px_range << "\n";
+      std::cout << "Atlas page: RGBA32F " << page * 16 / (1 << 20) << " MB, RGBA16F " << page * 8 / (1 << 20) << " MB, RGBA8 " << page * 4 / (1 << 20) << " MB\n";
+      for (size_t i = 0; i < std::size(sizes); i++) {
+            std::cout << sizes[i] << "px coverage error - RGBA8 max " << rgba8[i].Max << " mean " << rgba8[i].Sum / (double)glm::max<uint64_t>(rgba8[i].Count, 1)
+                  << ", RGBA16F max " << rgba16f[i].Max << " mean " << rgba16f[i].Sum / (double)glm::max<uint64_t>(rgba16f[i].Count, 1) << "\n";
+      }
+      return 0;
+}
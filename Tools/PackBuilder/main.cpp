@@ -0,0 +1,84 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "LoFiGfx.h"
+
+// Builds a .lfpk asset pack from a manifest, one entry per line:
+//   texture <name> <image/ktx2/dds file>
+//   raw     <name> <file>
+//   program <name> <config file | -> <source file> [source file ...]
+// Blank lines and lines starting with '#' are ignored.
+
+static bool ReadText(const std::string& path, std::string& out, bool binary = false) {
+      std::ifstream file(path, binary ? std::ios::binary : std::ios::in);
+      if (!file.is_open()) return false;
+      std::ostringstream oss;
+      oss << file.rdbuf();
+      out = oss.str();
+      return true;
+}
+
+int main(int argc, char** argv) {
+      if (argc < 3) {
+            std::cout << "Usage: PackBuilder <manifest.txt> <output.lfpk>\n";
+            return 1;
+      }
+
+      std::ifstream manifest(argv[1]);
+      if (!manifest.is_open()) {
+            std::cout << "Failed to open manifest " << argv[1] << "\n";
+            return 1;
+      }
+
+      GfxAssetPackWriter writer = GfxCreateAssetPackWriter();
+      bool ok = true;
+      std::string line{};
+      uint32_t line_number = 0;
+
+      while (ok && std::getline(manifest, line)) {
+            line_number++;
+            std::istringstream iss(line);
+            std::string kind{}, name{};
+            if (!(iss >> kind) || kind.starts_with('#')) continue;
+            if (!(iss >> name)) {
+                  std::cout << "Line " << line_number << ": missing entry name\n";
+                  ok = false;
+                  break;
+            }
+
+            std::vector<std::string> args{};
+            for (std::string arg{}; iss >> arg;) args.push_back(arg);
+
+            if (kind == "texture" && args.size() == 1) {
+                  ok = GfxAssetPackWriterAddTexture2DFromFile(writer, name.c_str(), args[0].c_str());
+            } else if (kind == "raw" && args.size() == 1) {
+                  std::string data{};
+                  ok = ReadText(args[0], data, true) && GfxAssetPackWriterAddRaw(writer, name.c_str(), data.data(), data.size());
+            } else if (kind == "program" && args.size() >= 2) {
+                  std::string config{};
+                  if (args[0] != "-" && !ReadText(args[0], config)) {
+                        std::cout << "Line " << line_number << ": failed to read config " << args[0] << "\n";
+                        ok = false;
+                        break;
+                  }
+                  std::vector<const char*> files{};
+                  for (size_t i = 1; i < args.size(); i++) files.push_back(args[i].c_str());
+                  ok = GfxAssetPackWriterAddProgramFromFile(writer, name.c_str(), {
+                        .pConfig = config.c_str(),
+                        .pSourceCodeFileNames = files.data(),
+                        .countSourceCodeFileName = files.size()
+                  });
+            } else {
+                  std::cout << "Line " << line_number << ": unknown entry \"" << line << "\"\n";
+                  ok = false;
+            }
+
+            if (!ok) std::cout << "Line " << line_number << ": failed to add \"" << name << "\"\n";
+      }
+
+      if (ok) ok = GfxAssetPackWriterSave(writer, argv[2]);
+      GfxDestroyAssetPackWriter(writer);
+      return ok ? 0 : 1;
+}
@@ -0,0 +1,174 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <functional>
+#include <algorithm>
+#include <numeric>
+#include "LoFiGfx.h"
+
+// Measures the built-in GPU primitives on the current device, headless (no swapchain).
+//   PrimitivesBenchmark [element count] [iterations]
+// Bandwidth is the bytes each primitive must touch at least once, divided by wall time.
+
+struct BenchmarkContext {
+      GfxRDGNodeCore Node;
+      uint32_t Count;
+      uint32_t Iterations;
+};
+
+static GfxHandle CreateDeviceBuffer(const char* name, const std::vector<uint32_t>& data) {
+      return GfxCreateBuffer({.pResourceName = name, .pData = data.data(), .DataSize = data.size() * sizeof(uint32_t), .bSingleUpload = false, .bCpuAccess = false});
+}
+
+static std::vector<uint32_t> Readback(GfxHandle buffer, uint32_t count) {
+      const auto ticket = GfxReadbackBuffer(buffer, 0, (uint64_t)count * sizeof(uint32_t));
+      GfxGenFrame();
+      while (GfxQueryReadback(ticket) == GfxEnumReadbackState::PENDING) {
+            GfxGenFrame();
+      }
+
+      std::vector<uint32_t> result{};
+      uint64_t size = 0;
+      if (const auto data = (const uint32_t*)GfxGetReadbackData(ticket, &size)) {
+            result.assign(data, data + size / sizeof(uint32_t));
+      }
+      GfxReleaseReadback(ticket);
+      return result;
+}
+
+static void Run(const BenchmarkContext& ctx, const char* name, uint64_t bytes_per_iteration, const std::function<bool()>& record) {
+      //warm up, compiles the kernels
+      GfxCmdBeginComputePass(ctx.Node);
+      const bool ok = record();
+      GfxCmdEndComputePass(ctx.Node);
+      uint64_t frame = GfxGetCurrentFrameValue();
+      GfxGenFrame();
+      GfxWaitFrame(frame);
+
+      if (!ok) {
+            std::cout << name << ": failed to record\n";
+            return;
+      }
+
+      const auto begin = std::chrono::high_resolution_clock::now();
+      GfxCmdBeginComputePass(ctx.Node);
+      for (uint32_t i = 0; i < ctx.Iterations; i++) record();
+      GfxCmdEndComputePass(ctx.Node);
+      frame = GfxGetCurrentFrameValue();
+      GfxGenFrame();
+      GfxWaitFrame(frame);
+      const auto end = std::chrono::high_resolution_clock::now();
+
+      const double seconds = std::chrono::duration<double>(end - begin).count();
+      const double gbps = (double)bytes_per_iteration * ctx.Iterations / seconds / 1e9;
+      std::cout << name << ": " << seconds * 1000.0 / ctx.Iterations << " ms, " << gbps << " GB/s\n";
+}
+
+static void Validate(const char* name, bool ok) {
+      std::cout << name << (ok ? ": ok\n" : ": MISMATCH\n");
+}
+
+int main(int argc, char** argv) {
+      const uint32_t count = argc > 1 ? (uint32_t)std::stoul(argv[1]) : 1u << 22;
+      const uint32_t iterations = argc > 2 ? (uint32_t)std::stoul(argv[2]) : 16;
+      constexpr uint32_t bin_count = 256;
+      constexpr uint32_t segment_size = 1000;
+      const uint32_t segment_count = (count + segment_size - 1) / segment_size;
+
+      GfxInit();
+
+      std::mt19937 rng(1234);
+      std::vector<uint32_t> keys(count), values(count), flags(count), offsets(segment_count + 1);
+      for (uint32_t i = 0; i < count; i++) {
+            keys[i] = rng();
+            values[i] = i;
+            flags[i] = rng() & 1;
+      }
+      for (uint32_t i = 0; i <= segment_count; i++) offsets[i] = std::min(i * segment_size, count);
+
+      const auto src = CreateDeviceBuffer("Benchmark Src", keys);
+      const auto dst = CreateDeviceBuffer("Benchmark Dst", std::vector<uint32_t>(count));
+      const auto sort_keys = CreateDeviceBuffer("Benchmark Sort Keys", keys);
+      const auto sort_values = CreateDeviceBuffer("Benchmark Sort Values", values);
+      const auto flag_buffer = CreateDeviceBuffer("Benchmark Flags", flags);
+      const auto offset_buffer = CreateDeviceBuffer("Benchmark Segment Offsets", offsets);
+      const auto reduce_dst = CreateDeviceBuffer("Benchmark Reduce Dst", std::vector<uint32_t>(segment_count));
+      const auto count_dst = CreateDeviceBuffer("Benchmark Compact Count", std::vector<uint32_t>(1));
+      const auto bins = CreateDeviceBuffer("Benchmark Bins", std::vector<uint32_t>(bin_count));
+
+      const auto node = GfxCreateRDGNode({.pRenderNodeName = "PrimitivesBenchmark"});
+      GfxSetRootRDGNode(node);
+
+      //buffers are uploaded by the first frame
+      const uint64_t upload_frame = GfxGetCurrentFrameValue();
+      GfxGenFrame();
+      GfxWaitFrame(upload_frame);
+
+      const BenchmarkContext ctx{GfxGetRDGNodeCore(node), count, iterations};
+      const uint64_t src_address = GfxGetBufferBindlessAddress(src);
+      const uint64_t dst_address = GfxGetBufferBindlessAddress(dst);
+      const uint64_t bytes = (uint64_t)count * sizeof(uint32_t);
+
+      std::cout << "Elements: " << count << ", iterations: " << iterations << "\n";
+
+      Run(ctx, "Scan", bytes * 2, [&] {
+            return GfxCmdPrimitiveScan(ctx.Node, src_address, dst_address, count);
+      });
+      {
+            const auto gpu = Readback(dst, count);
+            std::vector<uint32_t> cpu(count);
+            std::exclusive_scan(keys.begin(), keys.end(), cpu.begin(), 0u);
+            Validate("Scan", gpu == cpu);
+      }
+
+      Run(ctx, "Histogram", bytes, [&] {
+            return GfxCmdPrimitiveHistogram(ctx.Node, src_address, GfxGetBufferBindlessAddress(bins), count, bin_count, 24);
+      });
+      {
+            const auto gpu = Readback(bins, bin_count);
+            std::vector<uint32_t> cpu(bin_count);
+            for (const auto k : keys) cpu[k >> 24]++;
+            Validate("Histogram", gpu == cpu);
+      }
+
+      Run(ctx, "Compact", bytes * 3, [&] {
+            return GfxCmdPrimitiveCompact(ctx.Node, src_address, GfxGetBufferBindlessAddress(flag_buffer), dst_address, GfxGetBufferBindlessAddress(count_dst), count);
+      });
+      {
+            std::vector<uint32_t> cpu{};
+            for (uint32_t i = 0; i < count; i++) if (flags[i]) cpu.push_back(keys[i]);
+            const auto gpu_count = Readback(count_dst, 1);
+            auto gpu = Readback(dst, count);
+            gpu.resize(cpu.size());
+            Validate("Compact", !gpu_count.empty() && gpu_count[0] == cpu.size() && gpu == cpu);
+      }
+
+      Run(ctx, "SegmentedReduce", bytes, [&] {
+            return GfxCmdPrimitiveSegmentedReduce(ctx.Node, src_address, GfxGetBufferBindlessAddress(offset_buffer), GfxGetBufferBindlessAddress(reduce_dst), segment_count);
+      });
+      {
+            const auto gpu = Readback(reduce_dst, segment_count);
+            std::vector<uint32_t> cpu(segment_count);
+            for (uint32_t s = 0; s < segment_count; s++) {
+                  cpu[s] = std::accumulate(keys.begin() + offsets[s], keys.begin() + offsets[s + 1], 0u);
+            }
+            Validate("SegmentedReduce", gpu == cpu);
+      }
+
+      //sorting an already sorted buffer costs the same, every pass moves all keys and values
+      Run(ctx, "RadixSort", bytes * 2 * 2 * 8, [&] {
+            return GfxCmdPrimitiveRadixSort(ctx.Node, GfxGetBufferBindlessAddress(sort_keys), GfxGetBufferBindlessAddress(sort_values), count, 32);
+      });
+      {
+            const auto gpu_keys = Readback(sort_keys, count);
+            const auto gpu_values = Readback(sort_values, count);
+            bool ok = gpu_keys.size() == count && gpu_values.size() == count && std::is_sorted(gpu_keys.begin(), gpu_keys.end());
+            for (uint32_t i = 0; ok && i < count; i++) ok = keys[gpu_values[i]] == gpu_keys[i];
+            Validate("RadixSort", ok);
+      }
+
+      GfxClose();
+      return 0;
+}